@@ -35,7 +35,9 @@
 #include <grctk/algo/connectivity/ConComp.hpp>
 #include <grctk/algo/drawing/random/RandomizePositions.hpp>
 #include <grctk/algo/drawing/pairpot/PairPot.hpp>
+#include <grctk/algo/drawing/pairpot/IncrementalLayout.hpp>
 #include <grctk/algo/drawing/intersections/OptiIntersect.hpp>
+#include <grctk/algo/drawing/stress/StressMajorization.hpp>
 #include <grctk/algo/orbits/FindOrbitsSubgraphIso.hpp>
 #include <grctk/algo/orbits/FindOrbitsVPerms.hpp>
 #include <grctk/algo/orbits/FindOrbitsEdgeTensions.hpp>
@@ -297,6 +299,45 @@ void DocWindow::findOrbits()
   }
 }
 
+void DocWindow::mnu_find_edge_orbits_cb(Fl_Widget *w, void *)
+{
+  DocWindow* dw = (DocWindow*)(w->parent());
+
+  LogExecutor logger;
+  typedef AlgThreeParamsNoRet<
+    grctk::FindOrbitsVPerms,
+    const grctk::AdjMatrix,
+    grctk::Attribute<int>&,
+    grctk::Attribute<int>&> R;
+  grctk::Attribute<int> aOrbits;
+  grctk::Attribute<int> aEdgeOrbits;
+  const grctk::AdjMatrix& g = dw->edit_box->graphAsAdjMatrix();
+  R* r = new R(g,aOrbits,aEdgeOrbits,logger);
+  SimpleWizard wiz(r,"Find vertex and edge orbits");
+
+  if (logger() && wiz())
+  {
+    std::ostringstream ossTitle;
+    ossTitle << dw->idString() << "_Orbits_" << "VertexAndEdge";
+    DocWindow* docWindow = dw->docControl->createNewFromGraph(g.clone(),ossTitle.str());
+    grctk::AdjMatrix newg = docWindow->edit_box->graphAsAdjMatrix();
+    for(size_t i = 0; i < newg.size(); ++i)
+    {
+      aInt[newg[i]] = aOrbits[g[i]];
+      for(size_t j = i+1; j < newg.size(); ++j)
+        if (newg.s(i,j))
+          aInt[newg(i,j)] = aEdgeOrbits[g(i,j)];
+    }
+    {
+      Attr2Color a2c;
+      a2c(newg,aInt,aColor);
+      a2c.edges(newg,aInt,aColor);
+    }
+    docWindow->edit_box->UpdateAll();
+    docWindow->edit_box->redraw();
+  }
+}
+
 void DocWindow::mnu_cmp_find_orbits_cb(Fl_Widget *w, void *)
 {
   DocWindow* dw = (DocWindow*)(w->parent());
@@ -378,8 +419,17 @@ void DocWindow::mnu_optimize_expsimp_cb(Fl_Widget *w, void *)
   paramsTabs[0].second.push_back(&initL);
   CheckboxParam use_existed(false,"Use existed representation");
   paramsTabs[0].second.push_back(&use_existed);
+  CheckboxParam spectral(false,"Start from the spectral layout (Laplacian eigenvectors)");
+  paramsTabs[0].second.push_back(&spectral);
   CheckboxParam save_every(true,"Save information about all stages");
   paramsTabs[0].second.push_back(&save_every);
+  std::vector<std::string> optimizers;
+  optimizers.push_back("Coordinate descent");
+  optimizers.push_back("L-BFGS");
+  OptionsParam optimizer(optimizers,0,"Optimizer:");
+  paramsTabs[0].second.push_back(&optimizer);
+  CheckboxParam multilevel(false,"Multilevel (coarsen, lay out, refine level by level)");
+  paramsTabs[0].second.push_back(&multilevel);
   std::vector<std::string> destinations;
   destinations.push_back("The copy of the graph");
   destinations.push_back("The original graph");
@@ -397,6 +447,28 @@ void DocWindow::mnu_optimize_expsimp_cb(Fl_Widget *w, void *)
   FloatParam r_0(0.12,"r_0");
   paramsTabs[1].second.push_back(&r_0);
 
+  paramsTabs.push_back(ParamsTab("Performance", std::vector<BaseParam*>()));
+  CheckboxParam approximate(false,"Ignore far non-adjacent pairs (grid with cutoff)");
+  paramsTabs[2].second.push_back(&approximate);
+  FloatParam errorBound(1.0e-6,"Max energy of an ignored pair, in units of k");
+  paramsTabs[2].second.push_back(&errorBound);
+  FloatParam expMaxError(0.0,"Max relative error of exp (0 = exact)");
+  paramsTabs[2].second.push_back(&expMaxError);
+  FloatParam cutoff(0.0,"Non-adjacent pairs farther apart do not interact (0 = no cutoff)");
+  paramsTabs[2].second.push_back(&cutoff);
+  IntegerParam threads(0,"Threads (0 = one per processor)");
+  paramsTabs[2].second.push_back(&threads);
+  IntegerParam seed(0,"Random seed (0 = take from the clock)");
+  paramsTabs[2].second.push_back(&seed);
+  IntegerParam stallStarts(0,"Stop after so many starts without improvement (0 = never)");
+  paramsTabs[2].second.push_back(&stallStarts);
+  IntegerParam distinctMinima(0,"Stop after so many distinct minima (0 = never)");
+  paramsTabs[2].second.push_back(&distinctMinima);
+  FloatParam energyTolerance(1.0e-6,"Energies closer than this are the same minimum");
+  paramsTabs[2].second.push_back(&energyTolerance);
+  FloatParam timeBudget(0.0,"Time budget, seconds (0 = none)");
+  paramsTabs[2].second.push_back(&timeBudget);
+
   ParamsDialog params("Set parameters", paramsTabs);
   params.show();
   while (params.shown())
@@ -412,9 +484,15 @@ void DocWindow::mnu_optimize_expsimp_cb(Fl_Widget *w, void *)
   grctk::PairPotBase::TuneParams tune(
     alpha0.value(),alpha1.value(),k.value(),r_0.value());
   grctk::PairPotBase::InputParams inputBase(
-    a3D,initL.value(),epsilon.value(),use_existed.value());
+    a3D,initL.value(),epsilon.value(),use_existed.value(),
+    approximate.value(),errorBound.value(),0,
+    (optimizer.value() == "L-BFGS") ?
+    grctk::PairPotBase::LBFGS : grctk::PairPotBase::COORDINATE_DESCENT,
+    expMaxError.value(),cutoff.value(),spectral.value());
   grctk::PairPot::InputParams input(
-    stocha.value(),save_every.value());
+    stocha.value(),save_every.value(),seed.value(),threads.value(),
+    multilevel.value(),stallStarts.value(),distinctMinima.value(),
+    energyTolerance.value(),timeBudget.value());
   grctk::GraphMultiRep tmp_multiRep(
     dw->edit_box->graphAsAdjMatrix(),dim.value());
   R* r = new R(tune,inputBase,input,tmp_multiRep,logger);
@@ -469,6 +547,20 @@ void DocWindow::mnu_opti_intersect_cb(Fl_Widget *w, void *)
   destinations.push_back("The original graph");
   OptionsParam dest(destinations,0,"Apply new vertex positions to:");
   paramsTabs[0].second.push_back(&dest);
+
+  paramsTabs.push_back(ParamsTab("Search",std::vector<BaseParam*>()));
+  CheckboxParam search(false,"Search the whole order (simulated annealing) instead of groups");
+  paramsTabs[1].second.push_back(&search);
+  IntegerParam iterations(100000,"Moves per chain");
+  paramsTabs[1].second.push_back(&iterations);
+  FloatParam timeBudget(0.0,"Time budget per chain, seconds (0 = none)");
+  paramsTabs[1].second.push_back(&timeBudget);
+  IntegerParam chains(4,"Chains");
+  paramsTabs[1].second.push_back(&chains);
+  IntegerParam threads(0,"Threads (0 = one per processor)");
+  paramsTabs[1].second.push_back(&threads);
+  IntegerParam seed(0,"Random seed (0 = take from the clock)");
+  paramsTabs[1].second.push_back(&seed);
   ParamsDialog params("Set parameters", paramsTabs);
   params.show();
   while (params.shown())
@@ -481,9 +573,19 @@ void DocWindow::mnu_opti_intersect_cb(Fl_Widget *w, void *)
     grctk::OptiIntersect,
     const grctk::AdjMatrix, const int,
     grctk::Attribute<yaatk::Vector2D>& > R;
+  typedef AlgThreeParamsNoRet<
+    grctk::OptiIntersect,
+    const grctk::AdjMatrix, const grctk::OptiIntersect::SearchParams,
+    grctk::Attribute<yaatk::Vector2D>& > RS;
   grctk::Attribute<yaatk::Vector2D> a2D;
   const grctk::AdjMatrix& g = dw->edit_box->graphAsAdjMatrix();
-  R* r = new R(g,vGroupSize.value(),a2D,logger);
+  Runnable* r;
+  if (search.value())
+    r = new RS(g,grctk::OptiIntersect::SearchParams(
+                 iterations.value(),timeBudget.value(),chains.value(),
+                 threads.value(),seed.value()),a2D,logger);
+  else
+    r = new R(g,vGroupSize.value(),a2D,logger);
   SimpleWizard wiz(r,"Minimizing edge intersections");
 
   if (logger() && wiz())
@@ -491,7 +593,11 @@ void DocWindow::mnu_opti_intersect_cb(Fl_Widget *w, void *)
     if (dest.value() == "The copy of the graph")
     {
       std::ostringstream ossTitle;
-      ossTitle << dw->idString() << "_MinIntersect_" << vGroupSize.value();
+      ossTitle << dw->idString() << "_MinIntersect_";
+      if (search.value())
+        ossTitle << "SA";
+      else
+        ossTitle << vGroupSize.value();
       DocWindow* docWindow = dw->docControl->createNewFromGraph(g.clone(),ossTitle.str());
       grctk::AdjMatrix newg = docWindow->edit_box->graphAsAdjMatrix();
       for(size_t i = 0; i < newg.size(); ++i)
@@ -512,6 +618,195 @@ void DocWindow::mnu_opti_intersect_cb(Fl_Widget *w, void *)
   }
 }
 
+void DocWindow::mnu_stress_majorization_cb(Fl_Widget *w, void *)
+{
+  DocWindow* dw = (DocWindow*)(w->parent());
+
+  std::vector<ParamsTab> paramsTabs;
+
+  paramsTabs.push_back(ParamsTab("Main parameters",std::vector<BaseParam*>()));
+  IntegerParam dim(2,"Dimensions");
+  paramsTabs[0].second.push_back(&dim);
+  FloatParam edgeLength(0.12,"Edge length");
+  paramsTabs[0].second.push_back(&edgeLength);
+  IntegerParam pivots(0,"Pivots (0 = full stress over all pairs)");
+  paramsTabs[0].second.push_back(&pivots);
+  IntegerParam maxIterations(500,"Max iterations");
+  paramsTabs[0].second.push_back(&maxIterations);
+  FloatParam tolerance(1.0e-5,"Stop when the stress decreases by a smaller part");
+  paramsTabs[0].second.push_back(&tolerance);
+  CheckboxParam use_existed(false,"Use existed representation");
+  paramsTabs[0].second.push_back(&use_existed);
+  CheckboxParam spectral(false,"Start from the spectral layout (Laplacian eigenvectors)");
+  paramsTabs[0].second.push_back(&spectral);
+  IntegerParam seed(1,"Random seed");
+  paramsTabs[0].second.push_back(&seed);
+  std::vector<std::string> destinations;
+  destinations.push_back("The copy of the graph");
+  destinations.push_back("The original graph");
+  destinations.push_back("Visualization");
+  OptionsParam dest(destinations,2,"Apply new vertex positions to:");
+  paramsTabs[0].second.push_back(&dest);
+
+  ParamsDialog params("Set parameters", paramsTabs);
+  params.show();
+  while (params.shown())
+    Fl::wait();
+  if (!params())
+    return;
+
+  LogExecutor logger;
+  typedef AlgTwoParamsNoRet<
+    grctk::StressMajorization,
+    const grctk::StressMajorization::InputParams,
+    grctk::GraphRep& > R;
+  grctk::GraphRep rep(dw->edit_box->graphAsAdjMatrix(),dim.value());
+  if (use_existed.value())
+    for(size_t i = 0; i < rep.g.size(); ++i)
+    {
+      yaatk::VectorXD position(0.0,rep.dim);
+      for(size_t d = 0; d < rep.dim && d < 3; ++d)
+        position[d] = a3D[rep.g[i]].X(d);
+      rep.aXD[rep.g[i]] = position;
+    }
+  R* r = new R(grctk::StressMajorization::InputParams(
+                 maxIterations.value(),tolerance.value(),pivots.value(),
+                 edgeLength.value(),use_existed.value(),spectral.value(),
+                 seed.value()),
+               rep,logger);
+  SimpleWizard wiz(r,"Stress majorization");
+
+  if (logger() && wiz())
+  {
+    grctk::GraphMultiRep tmp_multiRep(rep.g,rep.dim);
+    tmp_multiRep.addRep(rep);
+    if (dest.value() == "Visualization")
+    {
+      std::ostringstream ossTitle;
+      ossTitle << dw->idString() << " - Stress" << dim.value() << "D";
+      VisWindow* grce_vis_window
+        = new VisWindow(tmp_multiRep,false,ossTitle.str());
+      grce_vis_window->show();
+    }
+    else if (dest.value() == "The copy of the graph")
+    {
+      std::ostringstream ossTitle;
+      ossTitle << dw->idString() << "_Stress";
+      DocWindow* docWindow = dw->docControl->createNewFromGraph(tmp_multiRep.g.clone(),ossTitle.str());
+      grctk::AdjMatrix newg = docWindow->edit_box->graphAsAdjMatrix();
+      const std::vector<yaatk::Vector3D> rep3D = tmp_multiRep.getRep3DProj(0);
+      for(size_t i = 0; i < newg.size(); ++i)
+        a3D[newg[i]] = rep3D[i];
+      docWindow->edit_box->UpdateAll();
+      docWindow->edit_box->redraw();
+    }
+    else if (dest.value() == "The original graph")
+    {
+      const std::vector<yaatk::Vector3D> rep3D = tmp_multiRep.getRep3DProj(0);
+      for(size_t i = 0; i < tmp_multiRep.g.size(); ++i)
+        a3D[tmp_multiRep.g[i]] = rep3D[i];
+      dw->docControl->invalidateAttrs(tmp_multiRep.g);
+      dw->edit_box->UpdateAll();
+      dw->edit_box->redraw();
+    }
+    else
+      fl_message("Warning: unknown destination");
+  }
+}
+
+void DocWindow::mnu_incremental_layout_cb(Fl_Widget *w, void *)
+{
+  DocWindow* dw = (DocWindow*)(w->parent());
+
+  grctk::AdjMatrix g = dw->edit_box->graphAsAdjMatrix();
+  grctk::AdjMatrix gSel = dw->edit_box->selectionAsAdjMatrix();
+  std::vector<size_t> dirty;
+  for(size_t i = 0; i < gSel.size(); ++i)
+    dirty.push_back(g.vertexIndex(gSel[i]));
+  if (dirty.empty())
+  {
+    fl_message("Select the edited vertices or edges first");
+    return;
+  }
+
+  std::vector<ParamsTab> paramsTabs;
+
+  paramsTabs.push_back(ParamsTab("Main parameters",std::vector<BaseParam*>()));
+  IntegerParam dim(2,"Dimensions");
+  paramsTabs[0].second.push_back(&dim);
+  IntegerParam hops(2,"Optimize the vertices within so many edges of the selection");
+  paramsTabs[0].second.push_back(&hops);
+  FloatParam initL(0.0,"Initial L (0 = half the mean edge length)");
+  paramsTabs[0].second.push_back(&initL);
+  FloatParam epsilon(0.0001,"Epsilon");
+  paramsTabs[0].second.push_back(&epsilon);
+  FloatParam errorBound(1.0e-6,"Max energy of an ignored pair, in units of k");
+  paramsTabs[0].second.push_back(&errorBound);
+  std::vector<std::string> destinations;
+  destinations.push_back("The original graph");
+  destinations.push_back("The copy of the graph");
+  OptionsParam dest(destinations,0,"Apply new vertex positions to:");
+  paramsTabs[0].second.push_back(&dest);
+
+  paramsTabs.push_back(ParamsTab("Potential parameters", std::vector<BaseParam*>()));
+  FloatParam alpha0(6.0,"alpha_0");
+  paramsTabs[1].second.push_back(&alpha0);
+  FloatParam alpha1(2.0,"alpha_1");
+  paramsTabs[1].second.push_back(&alpha1);
+  FloatParam k(0.03,"k");
+  paramsTabs[1].second.push_back(&k);
+  FloatParam r_0(0.12,"r_0");
+  paramsTabs[1].second.push_back(&r_0);
+
+  ParamsDialog params("Set parameters", paramsTabs);
+  params.show();
+  while (params.shown())
+    Fl::wait();
+  if (!params())
+    return;
+
+  LogExecutor logger;
+  typedef RunOptimizeWithOneTuneTwoConstAndOneNoncostParams<
+    grctk::IncrementalLayout, grctk::PairPotBase::TuneParams,
+    grctk::IncrementalLayout::InputParams, std::vector<size_t>,
+    grctk::GraphRep> R;
+  grctk::PairPotBase::TuneParams tune(
+    alpha0.value(),alpha1.value(),k.value(),r_0.value());
+  grctk::IncrementalLayout::InputParams input(
+    a3D,hops.value(),initL.value(),epsilon.value(),errorBound.value());
+  grctk::GraphRep rep(g,dim.value());
+  R* r = new R(tune,input,dirty,rep,logger);
+  SimpleWizard wiz(r,"Incremental layout");
+
+  if (logger() && wiz())
+  {
+    grctk::GraphMultiRep tmp_multiRep(rep.g,rep.dim);
+    tmp_multiRep.addRep(rep);
+    const std::vector<yaatk::Vector3D> rep3D = tmp_multiRep.getRep3DProj(0);
+    if (dest.value() == "The copy of the graph")
+    {
+      std::ostringstream ossTitle;
+      ossTitle << dw->idString() << "_Incremental";
+      DocWindow* docWindow = dw->docControl->createNewFromGraph(tmp_multiRep.g.clone(),ossTitle.str());
+      grctk::AdjMatrix newg = docWindow->edit_box->graphAsAdjMatrix();
+      for(size_t i = 0; i < newg.size(); ++i)
+        a3D[newg[i]] = rep3D[i];
+      docWindow->edit_box->UpdateAll();
+      docWindow->edit_box->redraw();
+    }
+    else if (dest.value() == "The original graph")
+    {
+      for(size_t i = 0; i < tmp_multiRep.g.size(); ++i)
+        a3D[tmp_multiRep.g[i]] = rep3D[i];
+      dw->docControl->invalidateAttrs(tmp_multiRep.g);
+      dw->edit_box->UpdateAll();
+      dw->edit_box->redraw();
+    }
+    else
+      fl_message("Warning: unknown destination");
+  }
+}
+
 void DocWindow::mnu_visualize_cb(Fl_Widget *w, void *)
 {
   DocWindow* DocWindow_Ptr;
@@ -907,11 +1202,14 @@ Fl_Menu_Item DocWindow::menutable[] = {
   {"Orbits", 0, 0, 0, FL_SUBMENU},
   {"Find &orbits using edge tensions...", 0, mnu_find_orbits_cb<grctk::FindOrbitsEdgeTensions,grctk::Attribute<yaatk::Rational> >, 0, 0},
   {"Find &orbits using subgraph isomorphism check ...", 0, mnu_find_orbits_cb<grctk::FindOrbitsSubgraphIso,grctk::Attribute<int> >, 0, 0},
-  {"Find &orbits using vertex permutations (slow) ...", 0, mnu_find_orbits_cb<grctk::FindOrbitsVPerms,grctk::Attribute<int> >, 0, FL_MENU_DIVIDER},
+  {"Find &orbits using vertex permutations (slow) ...", 0, mnu_find_orbits_cb<grctk::FindOrbitsVPerms,grctk::Attribute<int> >, 0, 0},
+  {"Find vertex and &edge orbits using vertex permutations (slow) ...", 0, mnu_find_edge_orbits_cb, 0, FL_MENU_DIVIDER},
   {"&Check Orbits (Subgraph Iso vs Edge Tensions) ...", 0, mnu_cmp_find_orbits_cb, 0, 0},
   {0},
   {"Optimization", 0, 0, 0, FL_SUBMENU},
   {"Pair potential (simplified)...", 0, mnu_optimize_expsimp_cb, 0, FL_MENU_DIVIDER},
+  {"Stress majorization...", 0, mnu_stress_majorization_cb, 0, 0},
+  {"Incremental layout of the selection...", 0, mnu_incremental_layout_cb, 0, 0},
   {"Minimize &Intersections...", FL_CTRL+'I', mnu_opti_intersect_cb, 0, FL_MENU_DIVIDER},
   {0},
   {"Products", 0, 0, 0, FL_SUBMENU},
@@ -106,9 +106,12 @@ public:
   void findOrbits();
   template <typename FindOrbitsAlg, typename OrbitsAttribute>
   static void mnu_find_orbits_cb(Fl_Widget *w, void *);
+  static void mnu_find_edge_orbits_cb(Fl_Widget *, void *);
   static void mnu_cmp_find_orbits_cb(Fl_Widget *, void *);
   static void mnu_optimize_expsimp_cb(Fl_Widget *, void *);
   static void mnu_opti_intersect_cb(Fl_Widget *, void *);
+  static void mnu_stress_majorization_cb(Fl_Widget *, void *);
+  static void mnu_incremental_layout_cb(Fl_Widget *, void *);
   template <typename ProductAlg>
   static void mnu_product_cb(Fl_Widget *, void *);
   static void mnu_iso_CMR_cb(Fl_Widget *, void *);
@@ -28,6 +28,7 @@
 #include "grce/algo/color/ResetColors.hpp"
 #include <grctk/algo/generation/GenComplete.hpp>
 #include <grctk/algo/generation/GenRandom.hpp>
+#include <grctk/algo/generation/GenDegreeSequence.hpp>
 #include <grctk/algo/drawing/random/RandomizePositions.hpp>
 #include <grctk/algo/products/CartesianProduct.hpp>
 #include <grctk/algo/products/TensorProduct.hpp>
@@ -401,8 +402,17 @@ void MainWindow::gen_random_cb(Fl_Widget *w, void *)
   paramsTabs[0].second.push_back(&vc);
   IntegerParam ec(4,"Edge count");
   paramsTabs[0].second.push_back(&ec);
-  CheckboxParam connectedOnly(true,"Connected only");
-  paramsTabs[0].second.push_back(&connectedOnly);
+  std::vector<std::string> models;
+  models.push_back("Uniform, the given edge count");
+  models.push_back("Uniform connected, the given edge count (retries)");
+  models.push_back("Spanning tree plus random edges (connected)");
+  models.push_back("Every pair with the given probability");
+  OptionsParam model(models,2,"Model:");
+  paramsTabs[0].second.push_back(&model);
+  FloatParam probability(0.5,"Edge probability");
+  paramsTabs[0].second.push_back(&probability);
+  IntegerParam seed(0,"Random seed (0 = take from the clock)");
+  paramsTabs[0].second.push_back(&seed);
   ParamsDialog params("Set parameters for the new graph", paramsTabs);
   params.show();
   while (params.shown())
@@ -411,18 +421,124 @@ void MainWindow::gen_random_cb(Fl_Widget *w, void *)
     return;
 
   LogExecutor logger;
-  typedef AlgThreeParams<grctk::GenRandom,
-                         const size_t, const size_t, const bool,
-                         grctk::AdjMatrix> R;
   grctk::AdjMatrix g;
-  R* r = new R(vc.value(),ec.value(),connectedOnly.value(),
-               g,logger);
+  Runnable* r = NULL;
+  if (model.value() == "Uniform connected, the given edge count (retries)")
+  {
+    typedef AlgThreeParams<grctk::GenRandom,
+                           const size_t, const size_t, const bool,
+                           grctk::AdjMatrix> R;
+    r = new R(vc.value(),ec.value(),true,g,logger);
+  }
+  else
+  {
+    typedef AlgOneParam<grctk::GenRandom,
+                        const grctk::GenRandom::InputParams,
+                        grctk::AdjMatrix> R;
+    grctk::GenRandom::Model m = grctk::GenRandom::GNM;
+    if (model.value() == "Spanning tree plus random edges (connected)")
+      m = grctk::GenRandom::SPANNING_TREE;
+    else if (model.value() == "Every pair with the given probability")
+      m = grctk::GenRandom::GNP;
+    r = new R(grctk::GenRandom::InputParams(
+                m,vc.value(),ec.value(),probability.value(),seed.value()),
+              g,logger);
+  }
   SimpleWizard wiz(r,"Generate a random graph");
 
   if (logger() && wiz())
   {
     std::ostringstream ossTitle;
-    ossTitle << "Rand_" << vc.value() << "_e" << ec.value();
+    ossTitle << "Rand_" << vc.value();
+    if (model.value() == "Every pair with the given probability")
+      ossTitle << "_p" << probability.value();
+    else
+      ossTitle << "_e" << ec.value();
+    DocWindow* docWindow = docControl->createNewFromGraph(g,ossTitle.str());
+    typedef AlgTwoParamsNoRet<
+      grctk::RandomizePositions,
+      const grctk::AdjMatrix,
+      grctk::Attribute<yaatk::Vector3D>& > RPlace;
+    RPlace* rPlace = new RPlace(
+      docWindow->EditBox()->graphAsAdjMatrix(),
+      a3D, logger);
+    SimpleWizard wizPlace(rPlace,"Randomizing vertices positions");
+    if (logger() && wizPlace())
+    {
+      grce::ResetColors algResetColors;
+      algResetColors(rPlace->arg1,aColor);
+
+      docWindow->EditBox()->UpdateAll();
+      docWindow->EditBox()->redraw();
+    }
+  }
+}
+
+void MainWindow::gen_regular_cb(Fl_Widget *w, void *)
+{
+  DocControl* docControl = ((MainWindow*)(w->parent()))->docControl;
+
+  std::vector<ParamsTab> paramsTabs;
+  paramsTabs.push_back(ParamsTab("Main parameters",std::vector<BaseParam*>()));
+  IntegerParam vc(10,"Vertex count");
+  paramsTabs[0].second.push_back(&vc);
+  IntegerParam degree(3,"Degree");
+  paramsTabs[0].second.push_back(&degree);
+  IntegerParam samples(1,"Number of graphs (more than 1 are written to a BinCode file)");
+  paramsTabs[0].second.push_back(&samples);
+  IntegerParam threads(0,"Threads (0 = one per processor)");
+  paramsTabs[0].second.push_back(&threads);
+  IntegerParam seed(0,"Random seed (0 = take from the clock)");
+  paramsTabs[0].second.push_back(&seed);
+  ParamsDialog params("Set parameters for the new graphs", paramsTabs);
+  params.show();
+  while (params.shown())
+    Fl::wait();
+  if (!params())
+    return;
+
+  grctk::GenDegreeSequence::InputParams input(
+    vc.value(),degree.value(),seed.value(),threads.value());
+  LogExecutor logger;
+
+  if (samples.value() > 1)
+  {
+    char *filename = fl_file_chooser
+      (
+        "Choose a file to write the graphs to...",
+        "BinCode Files (*.R)",
+        0,0
+        );
+    if (!filename || fl_filename_isdir(filename))
+      return;
+    try
+    {
+      grctk::BinCodeFileWriter writer(filename);
+      typedef AlgThreeParamsNoRet<grctk::GenDegreeSequence,
+                                  const grctk::GenDegreeSequence::InputParams,
+                                  const unsigned long,
+                                  grctk::BinCodeFileWriter&> R;
+      R* r = new R(input,samples.value(),writer,logger);
+      SimpleWizard wiz(r,"Generate random regular graphs");
+    }
+    catch(...)
+    {
+      fl_alert("Error writing the graphs");
+    }
+    return;
+  }
+
+  grctk::AdjMatrix g;
+  typedef AlgOneParam<grctk::GenDegreeSequence,
+                      const grctk::GenDegreeSequence::InputParams,
+                      grctk::AdjMatrix> R;
+  R* r = new R(input,g,logger);
+  SimpleWizard wiz(r,"Generate a random regular graph");
+
+  if (logger() && wiz())
+  {
+    std::ostringstream ossTitle;
+    ossTitle << "V" << vc.value() << "P" << degree.value();
     DocWindow* docWindow = docControl->createNewFromGraph(g,ossTitle.str());
     typedef AlgTwoParamsNoRet<
       grctk::RandomizePositions,
@@ -492,6 +608,7 @@ Fl_Menu_Item MainWindow::menuitems[] = {
   { "Generate", 0, 0, 0, FL_SUBMENU, 0, 0, 0, 0 },
   { "Generate complete graph...", FL_CTRL + 'C', (Fl_Callback *)gen_complete_cb, 0, 0, 0, 0, 0, 0 },
   { "Generate random graph...", FL_CTRL + 'R', (Fl_Callback *)gen_random_cb, 0, 0, 0, 0, 0, 0 },
+  { "Generate random regular graphs...", 0, (Fl_Callback *)gen_regular_cb, 0, 0, 0, 0, 0, 0 },
   {0},
   { "Products", 0, 0, 0, FL_SUBMENU, 0, 0, 0, 0 },
   { "Cartesian (A2)...", 0, (Fl_Callback *)product_cb<grctk::CartesianProduct>, 0, 0, 0, 0, 0, 0 },
@@ -54,6 +54,7 @@ class MainWindow : public Fl_Window
   static void iso_opti_cb(Fl_Widget *, void *);
   static void gen_complete_cb(Fl_Widget *, void *);
   static void gen_random_cb(Fl_Widget *, void *);
+  static void gen_regular_cb(Fl_Widget *, void *);
 
   static void about_cb(Fl_Widget *, void *);
   // static void help_cb(Fl_Widget *, void *);
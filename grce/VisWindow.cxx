@@ -98,7 +98,7 @@ VisWindow::setVertexViewIndex(int index)
 
   grctk::Object v = renderBox->getSelectedObject();
 
-  VectorXD posXD = stateList.getRep(stateIndex)[index];
+  VectorXD posXD = stateList.view(stateIndex).position(index);
 
   vertex_coords_x->value(posXD[0]);
   vertex_coords_y->value(posXD[1]);
@@ -21,6 +21,7 @@
 */
 
 #include "Attr2Color.hpp"
+#include <grctk/algo/attrconv/ValueRanking.hpp>
 #include <limits>
 
 namespace grce
@@ -57,24 +58,18 @@ Attr2Color::attr2color(const grctk::AdjMatrix &g,
                        const grctk::Attribute<T>& a,
                        grctk::Attribute<Color>& aColor)
 {
-  std::set<T> attrValues;
-
-  for(size_t i = 0; i < g.size(); ++i)
-    attrValues.insert(a[g[i]]);
+  std::vector<size_t> ranks;
+  size_t classCount = grctk::rankAttribute(g,a,ranks);
 
   ColorGenerator colorGen;
 
-  size_t attrValueIndex = 0;
-  for(typename std::set<T>::const_iterator itAttr = attrValues.begin();
-      itAttr != attrValues.end();
-      ++itAttr)
-  {
-    Color c = colorGen();
-    for(size_t i = 0; i < g.size(); ++i)
-      if (a[g[i]] == *itAttr)
-        aColor[g[i]] = c;
-    attrValueIndex++;
-  }
+  std::vector<Color> colors;
+  colors.reserve(classCount);
+  for(size_t k = 0; k < classCount; ++k)
+    colors.push_back(colorGen());
+
+  for(size_t i = 0; i < g.size(); ++i)
+    aColor[g[i]] = colors[ranks[i]];
 }
 
 void
@@ -117,4 +112,42 @@ Attr2Color::operator()(const grctk::AdjMatrix &g,
   }
 }
 
+void
+Attr2Color::edges(const grctk::AdjMatrix &g,
+                  const grctk::Attribute<int>& aEdgeInt,
+                  grctk::Attribute<Color>& aColor)
+{
+  {
+    logStream() << "\nAttr2Color started\n";
+    flushLogStreams();
+  }
+
+  std::vector<int> values;
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t j = i+1; j < g.size(); ++j)
+      if (g.s(i,j))
+        values.push_back(aEdgeInt[g(i,j)]);
+
+  std::vector<size_t> ranks;
+  size_t classCount = grctk::rankValues(values,ranks);
+
+  ColorGenerator colorGen;
+
+  std::vector<Color> colors;
+  colors.reserve(classCount);
+  for(size_t k = 0; k < classCount; ++k)
+    colors.push_back(colorGen());
+
+  size_t edgeIndex = 0;
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t j = i+1; j < g.size(); ++j)
+      if (g.s(i,j))
+        aColor[g(i,j)] = colors[ranks[edgeIndex++]];
+
+  {
+    logStream() << "Attr2Color finished\n" ;
+    flushLogStreams();
+  }
+}
+
 } //namespace grce
@@ -49,6 +49,10 @@ public:
   void operator()(const grctk::AdjMatrix &g,
                   const grctk::Attribute<yaatk::Rational>& a,
                   grctk::Attribute<Color>& aColor);
+  // colors edges by the values of an edge attribute
+  void edges(const grctk::AdjMatrix &g,
+             const grctk::Attribute<int>& aEdgeInt,
+             grctk::Attribute<Color>& aColor);
   Attr2Color(grctk::Log& setlog = grctk::nullLog): AlgBase(setlog) {}
 };
 
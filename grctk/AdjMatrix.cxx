@@ -67,6 +67,12 @@ AdjMatrix::AdjMatrix(size_t vertexCount):
   }
 }
 
+AdjMatrix::AdjMatrix(const std::vector<Object>& vertexObjects):
+  vertices(vertexObjects),am(vertexObjects.size())
+{
+  acquireOwnership();
+}
+
 AdjMatrix::AdjMatrix(const AdjMatrix& obj):
   vertices(obj.vertices),am(obj.am)
 {
@@ -40,6 +40,7 @@ class AdjMatrix
 public:
   AdjMatrix();
   AdjMatrix(size_t vertexCount);
+  AdjMatrix(const std::vector<Object>& vertexObjects);
   AdjMatrix(const AdjMatrix&);
   AdjMatrix& operator=(const AdjMatrix&);
   AdjMatrix& assign(const AdjMatrix&);
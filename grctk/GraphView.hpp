@@ -0,0 +1,72 @@
+/*
+  The GraphView and AdjMatrixView classes (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_GraphView_hpp
+#define grctk_GraphView_hpp
+
+#include "grctk/AdjMatrix.hpp"
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Read-only adjacency of a graph with vertices 0..size()-1, which need
+  not be stored anywhere (see ProductView). There are no vertex and
+  edge objects behind a view, so the algorithms taking one only report
+  indices and numbers.
+*/
+class GraphView
+{
+public:
+  virtual ~GraphView() {}
+  virtual size_t size() const = 0;
+  virtual bool s(size_t vi1, size_t vi2) const = 0;
+  // replaces the contents of result by the vertices adjacent to vi
+  virtual void neighbours(size_t vi, std::vector<size_t>& result) const = 0;
+  virtual size_t degree(size_t vi) const
+    {
+      std::vector<size_t> result;
+      neighbours(vi,result);
+      return result.size();
+    }
+};
+
+class AdjMatrixView : public GraphView
+{
+  const AdjMatrix& g;
+public:
+  AdjMatrixView(const AdjMatrix& graph): g(graph) {}
+  virtual size_t size() const { return g.size(); }
+  virtual bool s(size_t vi1, size_t vi2) const { return g.s(vi1,vi2); }
+  virtual void neighbours(size_t vi, std::vector<size_t>& result) const
+    {
+      result.clear();
+      for(size_t j = 0; j < g.size(); ++j)
+        if (g.s(vi,j))
+          result.push_back(j);
+    }
+  virtual size_t degree(size_t vi) const { return g.vertexDegree(vi); }
+};
+
+} //namespace grctk
+
+#endif
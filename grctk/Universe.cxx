@@ -126,6 +126,52 @@ Universe::allocateId()
   return nextId;
 }
 
+// the same ids as count calls of allocateId() would take: the gaps
+// first, then the ones past the largest id
+void
+Universe::allocateIds(size_t count, std::vector<size_t>& newIds)
+{
+  ids.insert(0);
+  newIds.clear();
+  newIds.reserve(count);
+  for(std::set<size_t>::iterator
+        idi = ids.begin(), idiPrev = idi++;
+      idi != ids.end() && newIds.size() < count;
+      idiPrev = idi, ++idi)
+    for(size_t id = *idiPrev + 1; id < *idi && newIds.size() < count; ++id)
+      newIds.push_back(id);
+  for(size_t id = *ids.rbegin() + 1; newIds.size() < count; ++id)
+    newIds.push_back(id);
+  if (!newIds.empty() && newIds.back() >= dataSize)
+  {
+    REQUIRE(newIds.back() < 50000);
+    dataSize = newIds.back() + 1;
+  }
+  for(size_t k = 0; k < newIds.size(); ++k)
+    ids.insert(ids.end(),newIds[k]);
+}
+
+std::vector<Object>
+Universe::createVector(size_t length)
+{
+  std::vector<size_t> newIds;
+  allocateIds(length,newIds);
+  std::vector<Object> objects;
+  objects.reserve(length);
+  refCounters.resize(dataSize + 1);
+  for(size_t k = 0; k < newIds.size(); ++k)
+  {
+    refCounters[newIds[k]] = 0;
+    objects.push_back(Object(newIds[k],this));
+  }
+  if (length > 0)
+    for(std::set<GenericAttribute*>::iterator
+          attrIt = attrs.begin();
+        attrIt != attrs.end(); ++attrIt)
+      (*attrIt)->onCreate();
+  return objects;
+}
+
 void
 Universe::freeId(size_t id)
 {
@@ -185,10 +231,22 @@ operator>>(std::istream& is, Object& m)
   return is;
 }
 
+static thread_local Universe* threadUniverse = NULL;
+
 Universe&
 Universe::singleton() {
+  if (threadUniverse != NULL)
+    return *threadUniverse;
   static Universe instance;
   return instance;
 }
 
+Universe*
+Universe::setThreadUniverse(Universe* universe)
+{
+  Universe* previous = threadUniverse;
+  threadUniverse = universe;
+  return previous;
+}
+
 }
@@ -104,6 +104,7 @@ protected:
 private:
   std::vector<size_t> refCounters;
   size_t allocateId();
+  void allocateIds(size_t count, std::vector<size_t>& newIds);
   void freeId(size_t id);
   std::set<GenericAttribute*> attrs;
 public:
@@ -145,7 +146,9 @@ public:
       return e;
     }
   // virtual void reserveVector(size_t length)
-  // virtual std::vector<Object> createVector(size_t length)
+  // length objects at once: the free ids are found in one pass, and
+  // the attributes grow once
+  virtual std::vector<Object> createVector(size_t length);
   virtual Object clone(const Object& srcEl)
     {
       Object destEl = create();
@@ -155,6 +158,16 @@ public:
         (*attrIt)->onClone(srcEl,destEl);
       return destEl;
     }
+  virtual std::vector<Object> cloneVector(const std::vector<Object>& srcEls)
+    {
+      std::vector<Object> destEls = createVector(srcEls.size());
+      for(std::set<GenericAttribute*>::iterator
+            attrIt = attrs.begin();
+          attrIt != attrs.end(); ++attrIt)
+        for(size_t k = 0; k < srcEls.size(); ++k)
+          (*attrIt)->onClone(srcEls[k],destEls[k]);
+      return destEls;
+    }
   virtual void resetAttrs(size_t id)
     {
       for(std::set<GenericAttribute*>::iterator
@@ -169,6 +182,27 @@ public:
   template <class T> friend class Attribute;
   static Universe& singleton();
   static Universe& null();
+  // the universe singleton() returns in the calling thread (NULL resets)
+  static Universe* setThreadUniverse(Universe* universe);
+};
+
+/*
+  Universe is not thread-safe, so a worker thread that creates objects
+  or attributes gets a universe of its own for the scope's lifetime:
+  Universe::singleton() (and so every default-constructed Attribute,
+  every generated or decoded graph) refers to it in that thread only.
+  Objects must not be passed between universes, graphs cross threads
+  in a universe-free form (e.g. BinCode).
+*/
+class UniverseScope
+{
+  Universe* previous;
+  UniverseScope(const UniverseScope&);
+  UniverseScope& operator=(const UniverseScope&);
+public:
+  UniverseScope(Universe& universe):
+    previous(Universe::setThreadUniverse(&universe)) {}
+  ~UniverseScope() { Universe::setThreadUniverse(previous); }
 };
 
 using yaatk::operator<<;
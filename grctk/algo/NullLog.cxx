@@ -27,10 +27,29 @@
 namespace grctk
 {
 
+namespace
+{
+
+class NullBuf : public std::streambuf
+{
+protected:
+  virtual int_type overflow(int_type c) { return traits_type::not_eof(c); }
+  virtual std::streamsize xsputn(const char*, std::streamsize n) { return n; }
+};
+
+}
+
+std::ostream&
+NullLog::nullStream()
+{
+  static thread_local NullBuf buf;
+  static thread_local std::ostream stream(&buf);
+  return stream;
+}
+
 void
 NullLog::flushStreams()
 {
-  osErr.str("");osLog.str("");
 }
 
 NullLog nullLog;
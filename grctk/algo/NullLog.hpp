@@ -28,9 +28,18 @@
 namespace grctk
 {
 
+/*
+  Discards everything. nullLog is shared by all algorithms by default,
+  so each thread gets a stream of its own (the formatting state of a
+  std::ostream is not safe to share) writing into a buffer that drops
+  the characters.
+*/
 class NullLog : public StringLog
 {
+  static std::ostream& nullStream();
 public:
+  virtual std::ostream& errStream() {return nullStream();};
+  virtual std::ostream& logStream() {return nullStream();};
   virtual void flushStreams();
   NullLog():StringLog(){;};
   virtual ~NullLog(){;};
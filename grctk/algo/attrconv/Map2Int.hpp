@@ -25,6 +25,7 @@
 
 #include "grctk/algo/AlgBase.hpp"
 #include "grctk/AdjMatrix.hpp"
+#include "ValueRanking.hpp"
 
 namespace grctk
 {
@@ -46,21 +47,11 @@ Map2Int<T>::operator()(const AdjMatrix &g, const Attribute<T>& a, Attribute<int>
     flushLogStreams();
   }
 
-  std::set<T> attrValues;
+  std::vector<size_t> ranks;
+  rankAttribute(g,a,ranks);
 
   for(size_t i = 0; i < g.size(); ++i)
-    attrValues.insert(a[g[i]]);
-
-  size_t attrValueIndex = 1;
-  for(typename std::set<T>::const_iterator itAttr = attrValues.begin();
-      itAttr != attrValues.end();
-      ++itAttr)
-  {
-    for(size_t i = 0; i < g.size(); ++i)
-      if (a[g[i]] == *itAttr)
-        aInt[g[i]] = attrValueIndex;
-    attrValueIndex++;
-  }
+    aInt[g[i]] = ranks[i] + 1;
 
   {
     logStream() << "Map2Int finished\n" ;
@@ -0,0 +1,189 @@
+/*
+  Dense ranking of attribute values.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_ValueRanking_hpp
+#define grctk_ValueRanking_hpp
+
+#include "grctk/AdjMatrix.hpp"
+#include <yaatk/Hash.hpp>
+#include <yaatk/Rational.hpp>
+#include <yaatk/LongInteger.hpp>
+
+#include <vector>
+#include <algorithm>
+
+namespace grctk
+{
+
+/*
+  Hash functors for the value types ranked in GRCE. The primary template
+  covers integral types, the rest must agree with their operator==.
+*/
+template <typename T>
+struct ValueHash
+{
+  uint64_t operator()(const T& v) const
+    {
+      return yaatk::hashMix(uint64_t(v));
+    }
+};
+
+template <>
+struct ValueHash<yaatk::LongInteger>
+{
+  uint64_t operator()(const yaatk::LongInteger& v) const
+    {
+      return yaatk::hashLongInteger(v);
+    }
+};
+
+template <>
+struct ValueHash<yaatk::HybridRational>
+{
+  uint64_t operator()(const yaatk::HybridRational& v) const
+    {
+      return v.hash();
+    }
+};
+
+template <>
+struct ValueHash<yaatk::GMPRational>
+{
+  uint64_t operator()(const yaatk::GMPRational& v) const
+    {
+      return yaatk::hashCombine(yaatk::hashLongInteger(v.n),
+                                yaatk::hashLongInteger(v.d));
+    }
+};
+
+// sorted vectors stand in for std::multiset / std::set values
+template <typename T>
+struct ValueHash<std::vector<T> >
+{
+  uint64_t operator()(const std::vector<T>& v) const
+    {
+      ValueHash<T> elementHash;
+      uint64_t h = yaatk::hashMix(v.size());
+      for(size_t i = 0; i < v.size(); ++i)
+        h = yaatk::hashCombine(h, elementHash(v[i]));
+      return h;
+    }
+};
+
+template <typename T>
+class IndirectLess
+{
+  const std::vector<T>& values;
+public:
+  IndirectLess(const std::vector<T>& v):values(v) {}
+  bool operator()(size_t a, size_t b) const { return values[a] < values[b]; }
+};
+
+/*
+  Replaces every value with the index of its class among the distinct
+  values, the classes being numbered in ascending order (i.e. in the
+  order std::set<T> would visit them). Returns the number of classes.
+
+  Equal values are grouped in a single pass through an open addressing
+  table of representatives, so operator== is called about once per
+  value and only the distinct values are sorted. This replaces the
+  set-then-rescan idiom, which costs O(n*k) comparisons for k classes.
+*/
+template <typename T, typename Hash>
+size_t
+rankValues(const std::vector<T>& values, std::vector<size_t>& ranks, Hash hash)
+{
+  const size_t n = values.size();
+  ranks.resize(n);
+  if (n == 0)
+    return 0;
+
+  size_t capacity = 1;
+  while (capacity < 2*n)
+    capacity <<= 1;
+  const size_t mask = capacity - 1;
+
+  std::vector<uint64_t> hashes(n);
+  for(size_t i = 0; i < n; ++i)
+    hashes[i] = hash(values[i]);
+
+  const size_t empty = size_t(-1);
+  std::vector<size_t> slots(capacity, empty);
+  std::vector<size_t> representatives;
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    size_t s = size_t(hashes[i]) & mask;
+    while (true)
+    {
+      if (slots[s] == empty)
+      {
+        slots[s] = representatives.size();
+        ranks[i] = representatives.size();
+        representatives.push_back(i);
+        break;
+      }
+      size_t r = representatives[slots[s]];
+      if (hashes[r] == hashes[i] && values[r] == values[i])
+      {
+        ranks[i] = slots[s];
+        break;
+      }
+      s = (s + 1) & mask;
+    }
+  }
+
+  std::vector<size_t> order(representatives);
+  std::sort(order.begin(), order.end(), IndirectLess<T>(values));
+
+  std::vector<size_t> classRank(representatives.size());
+  for(size_t k = 0; k < order.size(); ++k)
+    classRank[ranks[order[k]]] = k;
+
+  for(size_t i = 0; i < n; ++i)
+    ranks[i] = classRank[ranks[i]];
+
+  return representatives.size();
+}
+
+template <typename T>
+size_t
+rankValues(const std::vector<T>& values, std::vector<size_t>& ranks)
+{
+  return rankValues(values, ranks, ValueHash<T>());
+}
+
+// ranks[i] is the rank of a[g[i]]
+template <typename T>
+size_t
+rankAttribute(const AdjMatrix& g, const Attribute<T>& a,
+              std::vector<size_t>& ranks)
+{
+  std::vector<T> values;
+  values.reserve(g.size());
+  for(size_t i = 0; i < g.size(); ++i)
+    values.push_back(a[g[i]]);
+  return rankValues(values, ranks);
+}
+
+} //namespace grctk
+
+#endif
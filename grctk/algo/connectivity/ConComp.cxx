@@ -79,4 +79,46 @@ ConComp::operator()(const AdjMatrix& g, const size_t s, size_t &count)
   return result;
 }
 
+size_t
+ConComp::operator()(const GraphView& g, std::vector<size_t>& component)
+{
+  logStream() << "\nConComp started\n";
+  flushLogStreams();
+
+  const size_t n = g.size();
+  const size_t unmarked = std::numeric_limits<size_t>::max();
+  component.assign(n,unmarked);
+  std::vector<size_t> stack;
+  std::vector<size_t> adjacent;
+
+  size_t count = 0;
+  for(size_t i = 0; i < n; i++)
+  {
+    if (component[i] != unmarked)
+      continue;
+    component[i] = count;
+    stack.push_back(i);
+    while (!stack.empty())
+    {
+      checkAborted();
+      size_t x = stack.back();
+      stack.pop_back();
+      g.neighbours(x,adjacent);
+      for(size_t k = 0; k < adjacent.size(); k++)
+        if (component[adjacent[k]] == unmarked)
+        {
+          component[adjacent[k]] = count;
+          stack.push_back(adjacent[k]);
+        }
+    }
+    count += 1;
+  }
+
+  logStream() << "Components: " << count << "\n";
+  logStream() << "ConComp finished\n";
+  flushLogStreams();
+
+  return count;
+}
+
 } //namespace grctk
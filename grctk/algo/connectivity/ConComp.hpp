@@ -25,6 +25,7 @@
 
 #include "grctk/algo/AlgBase.hpp"
 #include "grctk/AdjMatrix.hpp"
+#include "grctk/GraphView.hpp"
 
 #include <vector>
 
@@ -36,6 +37,9 @@ class ConComp : public AlgBase
   void Comp(size_t x, size_t count, const AdjMatrix& g, std::vector<size_t> &mark);
 public:
   AdjMatrix operator()(const AdjMatrix& g, const size_t s, size_t &count);
+  // labels the components 0, 1, ... in component[] and returns their
+  // count; iterative, so it also suits views of large graphs
+  size_t operator()(const GraphView& g, std::vector<size_t>& component);
   ConComp(Log& setlog = nullLog): AlgBase(setlog) {}
 };
 
@@ -21,6 +21,7 @@
 */
 
 #include "GraphMultiRep.hpp"
+#include <cstring>
 
 namespace grctk
 {
@@ -30,8 +31,10 @@ GraphMultiRep::GraphMultiRep(
   size_t dimensions):
   g(graph),
   dim(dimensions),
-  aMultiXD(),
-  energies()
+  energies(),
+  energyTraces(),
+  reps(0),
+  storage(new yaatk::MappedBuffer)
 {
 }
 
@@ -41,30 +44,71 @@ GraphMultiRep::GraphMultiRep(
   Attribute<yaatk::Vector3D> a3D):
   g(graph),
   dim(dimensions),
-  aMultiXD(),
-  energies()
+  energies(),
+  energyTraces(),
+  reps(0),
+  storage(new yaatk::MappedBuffer)
 {
+  double* p = newRep();
+  size_t dim2copy = (dim <= 3)?dim:3;
   for(size_t i = 0; i < g.size(); ++i)
   {
-    yaatk::VectorXD vxd(dim);
-    for(size_t idim = 0; idim < 3; ++idim)
-      vxd[idim] = a3D[g[i]].X(idim);
-    aMultiXD[g[i]].push_back(vxd);
+    for(size_t idim = 0; idim < dim; ++idim)
+      p[i*dim + idim] = 0;
+    for(size_t idim = 0; idim < dim2copy; ++idim)
+      p[i*dim + idim] = a3D[g[i]].X(idim);
   }
   energies.push_back(0.0);
+  energyTraces.push_back(std::vector<double>());
+}
+
+double*
+GraphMultiRep::newRep()
+{
+  const size_t repBytes = g.size()*dim*sizeof(double);
+  if (storage.use_count() > 1)
+  {
+    // shared with a copy: the appended data must not show up there
+    std::shared_ptr<yaatk::MappedBuffer> own(new yaatk::MappedBuffer);
+    own->reserve((reps + 1)*repBytes);
+    if (reps > 0)
+      memcpy(own->data(),storage->data(),reps*repBytes);
+    storage = own;
+  }
+  storage->reserve((reps + 1)*repBytes);
+  return (double*)storage->data() + reps++*g.size()*dim;
 }
 
 void
 GraphMultiRep::addRep(const GraphRep& rep)
 {
   REQUIRE(g.size() == rep.g.size());
+  for(size_t i = 0; i < g.size(); ++i)
+    REQUIRE(rep.aXD[rep.g[i]].size() == dim);
+  double* p = newRep();
   for(size_t i = 0; i < g.size(); ++i)
   {
-    REQUIRE(aMultiXD[g[i]].size() == 0 || aMultiXD[g[i]].back().size() == rep.aXD[rep.g[i]].size());
-    REQUIRE(i == 0 || rep.aXD[rep.g[i]].size() == rep.aXD[rep.g[i-1]].size());
-    aMultiXD[g[i]].push_back(rep.aXD[rep.g[i]]);
+    const yaatk::VectorXD& v = rep.aXD[rep.g[i]];
+    for(size_t idim = 0; idim < dim; ++idim)
+      p[i*dim + idim] = v[idim];
   }
   energies.push_back(rep.energy);
+  energyTraces.push_back(rep.energyTrace);
+}
+
+void
+GraphMultiRep::mapToFile(const std::string& filename)
+{
+  if (storage.use_count() > 1)
+  {
+    std::shared_ptr<yaatk::MappedBuffer> own(new yaatk::MappedBuffer);
+    const size_t bytes = reps*g.size()*dim*sizeof(double);
+    own->reserve(bytes);
+    if (bytes > 0)
+      memcpy(own->data(),storage->data(),bytes);
+    storage = own;
+  }
+  storage->mapToFile(filename);
 }
 
 size_t
@@ -81,30 +125,37 @@ GraphMultiRep::findRepWithMinEnergy() const
 size_t
 GraphMultiRep::size() const
 {
-  REQUIRE(g.size() > 0);
-  if (g.size() > 0)
-    return aMultiXD[g[0]].size();
-  else
-    return 0;
+  return reps;
+}
+
+GraphMultiRep::RepView
+GraphMultiRep::view(const size_t index) const
+{
+  REQUIRE(index < reps);
+  return RepView((const double*)storage->data() + index*g.size()*dim,
+                 g.size(),dim);
 }
 
 const std::vector<yaatk::VectorXD>
 GraphMultiRep::getRep(const size_t index) const
 {
+  RepView v = view(index);
   std::vector<yaatk::VectorXD> rep(g.size());
   for(size_t i = 0; i < g.size(); ++i)
-  {
-    REQUIRE(aMultiXD[g[i]][index].size() == dim);
-    rep[i].resize(dim);
-    rep[i] = aMultiXD[g[i]][index];
-  }
+    rep[i] = v.position(i);
   return rep;
 }
 
 const std::vector<yaatk::Vector3D>
 GraphMultiRep::getRep3DProj(const size_t index) const
 {
-  return RepXDtoRep3D(getRep(index));
+  RepView v = view(index);
+  size_t dim2copy = (dim <= 3)?dim:3;
+  std::vector<yaatk::Vector3D> r3D(g.size());
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t idim = 0; idim < dim2copy; ++idim)
+      r3D[i].X(idim) = v[i][idim];
+  return r3D;
 }
 
 std::vector<yaatk::Vector3D>
@@ -28,29 +28,61 @@
 #include "grctk/algo/drawing/GraphRep.hpp"
 #include <yaatk/VectorXD.hpp>
 #include <yaatk/Vector3D.hpp>
+#include <yaatk/MappedBuffer.hpp>
+#include <memory>
 #include <sstream>
 #include <string>
 
 namespace grctk
 {
 
+/*
+  All the representations are stored in one contiguous array of
+  size() x g.size() x dim doubles, on the heap or, after mapToFile(),
+  in a memory-mapped file. Copies share the array until one of them
+  adds a representation.
+*/
 struct GraphMultiRep
 {
   const AdjMatrix g;
   const size_t dim;
-  Attribute<std::vector<yaatk::VectorXD> > aMultiXD;
   std::vector<double> energies;
+  std::vector<std::vector<double> > energyTraces;
+  // the positions of one representation, without copying; valid until
+  // the next addRep() or mapToFile()
+  class RepView
+  {
+    const double* p;
+    size_t n;
+    size_t d;
+  public:
+    RepView(const double* data, size_t vertices, size_t dimensions):
+      p(data),n(vertices),d(dimensions) {}
+    size_t size() const { return n; }
+    size_t dimensions() const { return d; }
+    // coordinates of vertex v
+    const double* operator[](size_t v) const { return p + v*d; }
+    yaatk::VectorXD position(size_t v) const
+      { return yaatk::VectorXD(p + v*d,d); }
+  };
   GraphMultiRep(const AdjMatrix& graph, size_t dimensions);
   GraphMultiRep(const AdjMatrix& graph, size_t dimensions,
                 Attribute<yaatk::Vector3D> a3D);
   void addRep(const GraphRep& rep);
+  // moves the representations to a file (see yaatk::MappedBuffer)
+  void mapToFile(const std::string& filename);
   size_t findRepWithMinEnergy() const;
   std::vector<double> attrArray() const { return energies; }
   size_t size() const;
+  RepView view(const size_t index) const;
   const std::vector<yaatk::VectorXD> getRep(const size_t index) const;
   const std::vector<yaatk::Vector3D> getRep3DProj(const size_t index) const;
   static std::vector<yaatk::Vector3D> RepXDtoRep3D(const std::vector<yaatk::VectorXD>& rXD);
   static std::vector<yaatk::VectorXD> Rep3DtoRepXD(const std::vector<yaatk::Vector3D>& r3D, size_t dim);
+private:
+  size_t reps;
+  std::shared_ptr<yaatk::MappedBuffer> storage;
+  double* newRep();
 };
 
 }
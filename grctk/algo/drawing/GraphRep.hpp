@@ -28,6 +28,7 @@
 #include <yaatk/VectorXD.hpp>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace grctk
 {
@@ -38,13 +39,16 @@ struct GraphRep
   const size_t dim;
   Attribute<yaatk::VectorXD> aXD;
   double energy;
+  // energy before the first sweep of the optimizer and after every one
+  std::vector<double> energyTrace;
   GraphRep(
     const AdjMatrix& graph,
     size_t dimensions):
     g(graph),
     dim(dimensions),
     aXD(),
-    energy(0.0)
+    energy(0.0),
+    energyTrace()
     {
     }
 };
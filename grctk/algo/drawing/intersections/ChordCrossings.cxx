@@ -0,0 +1,126 @@
+/*
+  The ChordCrossings class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ChordCrossings.hpp"
+
+namespace grctk
+{
+
+ChordCrossings::ChordCrossings(const AdjMatrix &g):
+  edges(),
+  incident(g.vertexCount()),
+  touched(),
+  inArc(g.vertexCount(),0),
+  stamp(0),
+  changed()
+{
+  size_t VC = g.vertexCount();
+  for(size_t i = 0; i < VC; i++)
+    for(size_t j = i+1; j < VC; j++)
+      if (g(i,j))
+      {
+        incident[i].push_back(edges.size());
+        incident[j].push_back(edges.size());
+        edges.push_back(Edge(i,j));
+      }
+  touched.assign(edges.size(),0);
+}
+
+size_t
+ChordCrossings::count(const size_t *p) const
+{
+  size_t is_count = 0;
+
+  for(size_t e1 = 0; e1 < edges.size(); e1++)
+    for(size_t e2 = e1+1; e2 < edges.size(); e2++)
+      if (edgesCross(edges[e1],edges[e2],p))
+        is_count++;
+
+  return is_count;
+}
+
+long
+ChordCrossings::recount(const size_t *p_prev, const size_t *p_cur) const
+{
+  // doubled: the pairs of two changed edges are met twice, from both
+  // sides, the others once
+  long delta2 = 0;
+  for(size_t c = 0; c < changed.size(); c++)
+  {
+    const Edge& e1 = edges[changed[c]];
+    for(size_t e2 = 0; e2 < edges.size(); e2++)
+    {
+      long weight = (touched[e2] == stamp) ? 1 : 2;
+      if (edgesCross(e1,edges[e2],p_cur))
+        delta2 += weight;
+      if (edgesCross(e1,edges[e2],p_prev))
+        delta2 -= weight;
+    }
+  }
+
+  return delta2/2;
+}
+
+long
+ChordCrossings::delta(const size_t *p_prev, const size_t *p_cur,
+                      const std::vector<size_t>& moved)
+{
+  ++stamp;
+  changed.clear();
+  for(size_t m = 0; m < moved.size(); m++)
+    for(size_t k = 0; k < incident[moved[m]].size(); k++)
+    {
+      size_t e = incident[moved[m]][k];
+      if (touched[e] != stamp)
+      {
+        touched[e] = stamp;
+        changed.push_back(e);
+      }
+    }
+
+  return recount(p_prev,p_cur);
+}
+
+long
+ChordCrossings::reversalDelta(const size_t *p_prev, const size_t *p_cur,
+                              const std::vector<size_t>& arc)
+{
+  ++stamp;
+  for(size_t a = 0; a < arc.size(); a++)
+    inArc[arc[a]] = stamp;
+  changed.clear();
+  for(size_t a = 0; a < arc.size(); a++)
+    for(size_t k = 0; k < incident[arc[a]].size(); k++)
+    {
+      size_t e = incident[arc[a]][k];
+      size_t other = (edges[e].first == arc[a]) ?
+        edges[e].second : edges[e].first;
+      if (inArc[other] != stamp && touched[e] != stamp)
+      {
+        touched[e] = stamp;
+        changed.push_back(e);
+      }
+    }
+
+  return recount(p_prev,p_cur);
+}
+
+} //namespace grctk
@@ -0,0 +1,89 @@
+/*
+  The ChordCrossings class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_ChordCrossings_hpp
+#define grctk_ChordCrossings_hpp
+
+#include "grctk/AdjMatrix.hpp"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Crossings of the edges of a graph drawn with its vertices at the
+  points of a circle. p[v] is the number of the point of vertex v along
+  the circle. Two edges drawn as chords cross if and only if their ends
+  interleave along the circle, so only the point numbers are compared.
+  When a few vertices move, only the crossings of the edges at them are
+  recounted.
+*/
+class ChordCrossings
+{
+public:
+  typedef std::pair<size_t,size_t> Edge;
+private:
+  std::vector<Edge> edges;
+  // indices of the edges at every vertex
+  std::vector<std::vector<size_t> > incident;
+  // edges[e] is changed when touched[e] == stamp, vertex v is in the
+  // reversed arc when inArc[v] == stamp
+  std::vector<size_t> touched;
+  std::vector<size_t> inArc;
+  size_t stamp;
+  std::vector<size_t> changed;
+  static bool chordsCross(size_t a, size_t b, size_t c, size_t d)
+    {
+      if (a > b)
+        std::swap(a,b);
+      return ((a < c && c < b) != (a < d && d < b));
+    }
+  bool edgesCross(const Edge& e1, const Edge& e2, const size_t *p) const
+    {
+      if (e1.first == e2.first || e1.first == e2.second ||
+          e1.second == e2.first || e1.second == e2.second)
+        return false;
+      return chordsCross(p[e1.first],p[e1.second],
+                         p[e2.first],p[e2.second]);
+    }
+  long recount(const size_t *p_prev, const size_t *p_cur) const;
+public:
+  ChordCrossings(const AdjMatrix &g);
+  size_t vertexCount() const { return incident.size(); }
+  size_t edgeCount() const { return edges.size(); }
+  size_t count(const size_t *p) const;
+  // change of count() when the vertices in moved go from p_prev to
+  // p_cur, all the others staying in place
+  long delta(const size_t *p_prev, const size_t *p_cur,
+             const std::vector<size_t>& moved);
+  // the same when the vertices of an arc of the circle, listed in arc,
+  // have been put in reverse order: the edges with both ends in the arc
+  // keep their crossings with all the edges but the ones leaving the
+  // arc, so only the latter are recounted
+  long reversalDelta(const size_t *p_prev, const size_t *p_cur,
+                     const std::vector<size_t>& arc);
+};
+
+} //namespace grctk
+
+#endif
@@ -21,46 +21,226 @@
 */
 
 #include "OptiIntersect.hpp"
+#include "ChordCrossings.hpp"
 #include <yaatk/Permutation.hpp>
+#include <yaatk/Hash.hpp>
+#include "zthread/PoolExecutor.h"
+#include "zthread/Runnable.h"
+#include <gsl/gsl_rng.h>
 #include <cstring>
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace grctk
 {
 
 using yaatk::Vector2D;
 
-size_t
-OptiIntersect::intersectionsCount(
-  const AdjMatrix &g,
-  const size_t *p_cur,
-  const std::vector<Vector2D>& R) const
+static
+std::vector<Vector2D>
+circlePoints(size_t VC)
 {
-  size_t VC = g.vertexCount();
+  std::vector<Vector2D> R(VC);
 
-  size_t is_count = 0;
+  double radius = 1.0;
+  double da = 2*M_PI/double(VC);
+  for(size_t q = 0; q < VC; q++)
+  {
+    R[q].x = radius*cos(da*q);
+    R[q].y = radius*sin(da*q);
+  }
 
-  for(size_t i1 = 0; i1 < VC; i1++)
-    for(size_t j1 = i1+1; j1 < VC; j1++)
-      for(size_t i2 = 0; i2 < VC; i2++)
-        for(size_t j2 = i2+1; j2 < VC; j2++)
-        {
-          checkAborted();
-          if ((i1 != i2) && (j1 != j2) && (i2 != j1) && (j2 != i1))
-          {
-            if (g(i1,j1) &&
-                g(i2,j2) &&
-                areIntersecting(
-                  R[p_cur[i1]],R[p_cur[j1]],
-                  R[p_cur[i2]],R[p_cur[j2]]
-                  )
-              )
-            {
-              is_count++;
-            }
-          }
-        }
-
-  return is_count;
+  return R;
+}
+
+struct CircularChainResult
+{
+  // point of every vertex
+  std::vector<size_t> p;
+  size_t crossings;
+  bool aborted;
+  std::string error;
+  CircularChainResult():
+    p(),crossings(0),aborted(false),error() {}
+};
+
+/*
+  One simulated annealing chain over the circular order.
+*/
+class CircularChain : public ZThread::Runnable
+{
+  ChordCrossings crossings;
+  const OptiIntersect::SearchParams& input;
+  const unsigned long seed;
+  // chain 0 starts from the order of the vertices, the others from
+  // random orders
+  const bool fromIdentity;
+  std::atomic<bool>& stop;
+  CircularChainResult& result;
+  void anneal(gsl_rng *rng);
+public:
+  CircularChain(const ChordCrossings& c,
+                const OptiIntersect::SearchParams& inp,
+                unsigned long chainSeed, bool startFromIdentity,
+                std::atomic<bool>& stopFlag, CircularChainResult& res):
+    crossings(c),input(inp),seed(chainSeed),fromIdentity(startFromIdentity),
+    stop(stopFlag),result(res)
+    {
+    }
+  virtual void run()
+    {
+      gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+      if (rng == NULL)
+      {
+        result.error = "Cannot allocate the random number generator";
+        stop.store(true);
+        return;
+      }
+      gsl_rng_set(rng, seed);
+      try
+      {
+        anneal(rng);
+      }
+      catch(std::exception& e)
+      {
+        result.error = e.what();
+        stop.store(true);
+      }
+      catch(...)
+      {
+        result.error = "Unknown exception";
+        stop.store(true);
+      }
+      gsl_rng_free(rng);
+    }
+};
+
+void
+CircularChain::anneal(gsl_rng *rng)
+{
+  size_t VC = crossings.vertexCount();
+  // order[q] is the vertex at point q
+  std::vector<size_t> order(VC);
+  for(size_t q = 0; q < VC; q++)
+    order[q] = q;
+  if (!fromIdentity)
+    for(size_t q = VC; q > 1; --q)
+      std::swap(order[q-1],order[gsl_rng_uniform_int(rng,q)]);
+  std::vector<size_t> p(VC);
+  for(size_t q = 0; q < VC; q++)
+    p[order[q]] = q;
+  std::vector<size_t> p_prev(p);
+
+  long current = crossings.count(&p[0]);
+  result.p = p;
+  result.crossings = current;
+  if (VC < 4 || crossings.edgeCount() < 2)
+    return;
+
+  std::vector<size_t> moved;
+  bool reversal;
+  // initial temperature: the mean change of a random swap
+  double T0 = 0;
+  for(size_t k = 0; k < 100; k++)
+  {
+    size_t u = gsl_rng_uniform_int(rng,VC);
+    size_t v = (u + 1 + gsl_rng_uniform_int(rng,VC-1)) % VC;
+    std::swap(p[u],p[v]);
+    moved.clear();
+    moved.push_back(u);
+    moved.push_back(v);
+    T0 += std::fabs(double(crossings.delta(&p_prev[0],&p[0],moved)));
+    std::swap(p[u],p[v]);
+  }
+  T0 = std::max(T0/100,1.0);
+  const double Tend = 0.05;
+  double T = T0;
+
+  std::chrono::steady_clock::time_point started =
+    std::chrono::steady_clock::now();
+  for(size_t it = 0; it < input.inp_Iterations; it++)
+  {
+    if (it % 1024 == 0)
+    {
+      if (stop.load() || ZThread::Thread::interrupted())
+      {
+        result.aborted = true;
+        return;
+      }
+      double progress = double(it)/input.inp_Iterations;
+      if (input.inp_TimeBudget > 0)
+      {
+        double elapsed = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - started).count();
+        if (elapsed >= input.inp_TimeBudget)
+          break;
+        progress = std::max(progress,elapsed/input.inp_TimeBudget);
+      }
+      T = T0*std::pow(Tend/T0,progress);
+    }
+
+    moved.clear();
+    reversal = (gsl_rng_uniform(rng) >= 0.5);
+    if (!reversal)
+    {
+      size_t a = gsl_rng_uniform_int(rng,VC);
+      size_t b = (a + 1 + gsl_rng_uniform_int(rng,VC-1)) % VC;
+      std::swap(order[a],order[b]);
+      p[order[a]] = a;
+      p[order[b]] = b;
+      moved.push_back(order[a]);
+      moved.push_back(order[b]);
+    }
+    else
+    {
+      // reversing the complementary arc gives a mirror image with the
+      // same crossings, so arcs up to half of the circle are enough
+      size_t first = gsl_rng_uniform_int(rng,VC);
+      size_t len = 2 + gsl_rng_uniform_int(rng,VC/2-1);
+      for(size_t k = 0; k < len/2; k++)
+      {
+        size_t a = (first + k) % VC;
+        size_t b = (first + len - 1 - k) % VC;
+        std::swap(order[a],order[b]);
+        p[order[a]] = a;
+        p[order[b]] = b;
+        moved.push_back(order[a]);
+        moved.push_back(order[b]);
+      }
+      if (len % 2 == 1)
+        moved.push_back(order[(first + len/2) % VC]);
+    }
+
+    long d = reversal ?
+      crossings.reversalDelta(&p_prev[0],&p[0],moved) :
+      crossings.delta(&p_prev[0],&p[0],moved);
+    if (d <= 0 || gsl_rng_uniform(rng) < std::exp(-d/T))
+    {
+      current += d;
+      for(size_t m = 0; m < moved.size(); m++)
+        p_prev[moved[m]] = p[moved[m]];
+      if (current < long(result.crossings))
+      {
+        result.crossings = current;
+        result.p = p;
+      }
+    }
+    else
+    {
+      for(size_t m = 0; m < moved.size(); m++)
+      {
+        p[moved[m]] = p_prev[moved[m]];
+        order[p[moved[m]]] = moved[m];
+      }
+    }
+  }
 }
 
 void
@@ -72,26 +252,26 @@ OptiIntersect::operator()(const AdjMatrix &g, const int& gc, Attribute<Vector2D>
   size_t VC = g.vertexCount();
   if (gc > VC) return;
 
-  std::vector<Vector2D> R(VC);
-
-  double radius = 1.0;
-  double da = 2*M_PI/double(VC);
-  for(size_t q = 0; q < VC; q++)
-  {
-    R[q].x = radius*cos(da*q);
-    R[q].y = radius*sin(da*q);
-  }
+  std::vector<Vector2D> R = circlePoints(VC);
 
   size_t gnum = VC/gc;
   size_t *p_best = new size_t[VC];
   size_t *p_cur  = new size_t[VC];
+  size_t *p_prev = new size_t[VC];
 
   for(size_t i1 = 0; i1 < VC; i1++)
   {
     p_best[i1] = i1;
     p_cur[i1] = i1;
+    p_prev[i1] = i1;
   }
   size_t min_is_count = (VC)*(VC-1)/2;
+
+  // every crossing is counted twice, for both of its edges
+  ChordCrossings crossings(g);
+  checkAborted();
+  size_t is_count = 2*crossings.count(p_cur);
+  std::vector<size_t> moved;
   for(size_t gi = 0; gi < gnum; gi++)
   {
     logStream() << "Group #" << gi+1 << "\n";
@@ -101,9 +281,17 @@ OptiIntersect::operator()(const AdjMatrix &g, const int& gc, Attribute<Vector2D>
     p.gen_first();
     do
     {
+      checkAborted();
+      moved.clear();
       for(size_t k = 0; k < gc; k++)
+      {
         p_cur[gi*gc+k] =  p[k] + gi*gc;
-      size_t is_count = intersectionsCount(g,p_cur,R);
+        if (p_cur[gi*gc+k] != p_prev[gi*gc+k])
+          moved.push_back(gi*gc+k);
+      }
+      is_count += 2*crossings.delta(p_prev,p_cur,moved);
+      for(size_t m = 0; m < moved.size(); m++)
+        p_prev[moved[m]] = p_cur[moved[m]];
       if (is_count < min_is_count)
       {
         for(size_t w = 0; w < VC; w++)
@@ -122,9 +310,17 @@ OptiIntersect::operator()(const AdjMatrix &g, const int& gc, Attribute<Vector2D>
     p.gen_first();
     do
     {
+      checkAborted();
+      moved.clear();
       for(size_t k = 0; k < gr; k++)
+      {
         p_cur[gnum*gc+k] =  p[k] + gnum*gc;
-      size_t is_count = intersectionsCount(g,p_cur,R);
+        if (p_cur[gnum*gc+k] != p_prev[gnum*gc+k])
+          moved.push_back(gnum*gc+k);
+      }
+      is_count += 2*crossings.delta(p_prev,p_cur,moved);
+      for(size_t m = 0; m < moved.size(); m++)
+        p_prev[moved[m]] = p_cur[moved[m]];
       if (is_count < min_is_count)
       {
         for(size_t w = 0; w < VC; w++)
@@ -140,6 +336,7 @@ OptiIntersect::operator()(const AdjMatrix &g, const int& gc, Attribute<Vector2D>
 
   delete [] p_best;
   delete [] p_cur;
+  delete [] p_prev;
 
   logStream() << "Number of intersections: " << min_is_count/2 << "\n";
   flushLogStreams();
@@ -148,4 +345,90 @@ OptiIntersect::operator()(const AdjMatrix &g, const int& gc, Attribute<Vector2D>
   flushLogStreams();
 }
 
+void
+OptiIntersect::operator()(const AdjMatrix &g, const SearchParams& input,
+                          Attribute<Vector2D>& a2D)
+{
+  logStream() << "\nOptiIntersect started\n";
+  flushLogStreams();
+
+  size_t VC = g.vertexCount();
+  if (VC == 0) return;
+
+  std::vector<Vector2D> R = circlePoints(VC);
+
+  unsigned long masterSeed = input.inp_Seed;
+  if (masterSeed == 0)
+  {
+    time_t t;
+    masterSeed = (unsigned long)time(&t);
+  }
+  size_t chains = std::max(input.inp_Chains,size_t(1));
+  size_t threads = input.inp_Threads;
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads == 0)
+    threads = 1;
+  if (threads > chains)
+    threads = chains;
+
+  logStream() << "Annealing " << chains << " chain(s) of "
+              << input.inp_Iterations << " moves on " << threads
+              << " thread(s), seed = " << masterSeed << "\n";
+  flushLogStreams();
+
+  ChordCrossings crossings(g);
+  std::vector<CircularChainResult> results(chains);
+  std::atomic<bool> stop(false);
+  {
+    ZThread::PoolExecutor pool(threads);
+    for(size_t i = 0; i < chains; i++)
+    {
+      unsigned long seed =
+        (unsigned long)(yaatk::hashCombine(masterSeed,i) & 0xffffffffUL);
+      pool.execute(ZThread::Task(new CircularChain(
+                                   crossings,input,(seed != 0) ? seed : 1,
+                                   i == 0,stop,results[i])));
+    }
+    try
+    {
+      // an interrupt of this thread makes wait() throw
+      pool.wait();
+    }
+    catch(...)
+    {
+      // the tasks refer to the results and the stop flag
+      stop.store(true);
+      pool.interrupt();
+      pool.wait();
+      throw AbortAlgException("Exiting via the flag...");
+    }
+  }
+
+  for(size_t i = 0; i < chains; i++)
+    if (results[i].error != "")
+      throw std::runtime_error("OptiIntersect: " + results[i].error);
+  for(size_t i = 0; i < chains; i++)
+    if (results[i].aborted)
+      throw AbortAlgException("Exiting via the flag...");
+
+  size_t best = 0;
+  for(size_t i = 0; i < chains; i++)
+  {
+    logStream() << "Chain #" << i+1 << ", intersections: "
+                << results[i].crossings << "\n";
+    if (results[i].crossings < results[best].crossings)
+      best = i;
+  }
+
+  for(size_t i = 0; i < VC; i++)
+    a2D[g[i]] = R[results[best].p[i]];
+
+  logStream() << "Number of intersections: " << results[best].crossings << "\n";
+  flushLogStreams();
+
+  logStream() << "\nOptiIntersect finished\n";
+  flushLogStreams();
+}
+
 } //namespace grctk
@@ -30,14 +30,52 @@
 namespace grctk
 {
 
+/*
+  The vertices are placed at the points of a circle, and the crossings
+  of the edges drawn as chords are minimized over their order along it.
+
+  The first operator() permutes groups of gc vertices over their points
+  exhaustively, one group after another.
+
+  The second one searches the whole order by simulated annealing. The
+  moves swap two vertices or reverse an arc of the circle. A chain runs
+  inp_Iterations moves, or stops earlier when its inp_TimeBudget in
+  seconds runs out, cooling geometrically down to a twentieth of a
+  crossing. inp_Chains independent chains run on inp_Threads threads,
+  and the best order is kept, the first chain winning ties. Without a
+  time budget the result does not depend on inp_Threads.
+*/
 class OptiIntersect : public AlgBase
 {
-  size_t intersectionsCount(const AdjMatrix &g,
-                            const size_t *p_cur,
-                            const std::vector<yaatk::Vector2D>& R) const;
 public:
+  struct SearchParams
+  {
+    const size_t inp_Iterations;
+    // 0 = none
+    const double inp_TimeBudget;
+    const size_t inp_Chains;
+    // 0 runs one thread per processor
+    const size_t inp_Threads;
+    // 0 takes the seed from the clock
+    const unsigned long inp_Seed;
+    SearchParams(
+      const size_t inp_Iterations_def = 100000,
+      const double inp_TimeBudget_def = 0.0,
+      const size_t inp_Chains_def = 4,
+      const size_t inp_Threads_def = 1,
+      const unsigned long inp_Seed_def = 1) :
+      inp_Iterations(inp_Iterations_def),
+      inp_TimeBudget(inp_TimeBudget_def),
+      inp_Chains(inp_Chains_def),
+      inp_Threads(inp_Threads_def),
+      inp_Seed(inp_Seed_def)
+      {
+      }
+  };
   OptiIntersect(Log& setlog = nullLog) : AlgBase(setlog) {}
   void operator()(const AdjMatrix &g, const int& gc, Attribute<yaatk::Vector2D>& a2D);
+  void operator()(const AdjMatrix &g, const SearchParams& input,
+                  Attribute<yaatk::Vector2D>& a2D);
 };
 
 } //namespace grctk
@@ -0,0 +1,413 @@
+/*
+  The LayoutMetrics algorithm.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LayoutMetrics.hpp"
+#include "zthread/PoolExecutor.h"
+#include "zthread/Runnable.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace grctk
+{
+
+using yaatk::Vector2D;
+
+static const unsigned noPath = unsigned(-1);
+
+static
+double
+orientation(const Vector2D& a, const Vector2D& b, const Vector2D& c)
+{
+  return (b.x - a.x)*(c.y - a.y) - (b.y - a.y)*(c.x - a.x);
+}
+
+// p is on the line ab; is it between a and b?
+static
+bool
+onSegment(const Vector2D& a, const Vector2D& b, const Vector2D& p)
+{
+  return std::min(a.x,b.x) <= p.x && p.x <= std::max(a.x,b.x) &&
+    std::min(a.y,b.y) <= p.y && p.y <= std::max(a.y,b.y);
+}
+
+// true if the segments ab and cd have a common point, which is then
+// put into point
+static
+bool
+segmentsMeet(const Vector2D& a, const Vector2D& b,
+             const Vector2D& c, const Vector2D& d,
+             Vector2D& point)
+{
+  double d1 = orientation(a,b,c);
+  double d2 = orientation(a,b,d);
+  double d3 = orientation(c,d,a);
+  double d4 = orientation(c,d,b);
+  if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+      ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+  {
+    double t = d3/(d3 - d4);
+    point = a + t*(b - a);
+    return true;
+  }
+  if (d1 == 0 && onSegment(a,b,c)) { point = c; return true; }
+  if (d2 == 0 && onSegment(a,b,d)) { point = d; return true; }
+  if (d3 == 0 && onSegment(c,d,a)) { point = a; return true; }
+  if (d4 == 0 && onSegment(c,d,b)) { point = b; return true; }
+  return false;
+}
+
+static
+size_t
+cellIndex(double offset, double cellSize, size_t cells)
+{
+  if (offset <= 0)
+    return 0;
+  return std::min(size_t(offset/cellSize),cells-1);
+}
+
+size_t
+LayoutMetrics::crossingsCount(const std::vector<Edge>& edges,
+                              const std::vector<Vector2D>& points)
+{
+  if (edges.size() < 2)
+    return 0;
+
+  double minx = points[edges[0].first].x, maxx = minx;
+  double miny = points[edges[0].first].y, maxy = miny;
+  for(size_t e = 0; e < edges.size(); e++)
+  {
+    const Vector2D& a = points[edges[e].first];
+    const Vector2D& b = points[edges[e].second];
+    minx = std::min(minx,std::min(a.x,b.x));
+    maxx = std::max(maxx,std::max(a.x,b.x));
+    miny = std::min(miny,std::min(a.y,b.y));
+    maxy = std::max(maxy,std::max(a.y,b.y));
+  }
+  size_t side = size_t(std::ceil(std::sqrt(double(edges.size()))));
+  size_t nx = (maxx > minx) ? side : 1;
+  size_t ny = (maxy > miny) ? side : 1;
+  double cw = (maxx > minx) ? (maxx - minx)/nx : 1.0;
+  double ch = (maxy > miny) ? (maxy - miny)/ny : 1.0;
+  // an edge goes into every cell it passes within this margin of, so
+  // that the rounding of a crossing point cannot take it to a cell
+  // one of its edges is not in
+  double mx = 1.0e-9*cw;
+  double my = 1.0e-9*ch;
+
+  std::vector<std::vector<size_t> > cells(nx*ny);
+  for(size_t e = 0; e < edges.size(); e++)
+  {
+    Vector2D a = points[edges[e].first];
+    Vector2D b = points[edges[e].second];
+    if (a.y > b.y)
+      std::swap(a,b);
+    size_t r0 = cellIndex(a.y - my - miny,ch,ny);
+    size_t r1 = cellIndex(b.y + my - miny,ch,ny);
+    for(size_t r = r0; r <= r1; r++)
+    {
+      double xlo = std::min(a.x,b.x);
+      double xhi = std::max(a.x,b.x);
+      if (b.y > a.y)
+      {
+        double ylo = std::max(a.y,miny + r*ch - my);
+        double yhi = std::min(b.y,miny + (r+1)*ch + my);
+        double xa = a.x + (ylo - a.y)/(b.y - a.y)*(b.x - a.x);
+        double xb = a.x + (yhi - a.y)/(b.y - a.y)*(b.x - a.x);
+        xlo = std::min(xa,xb);
+        xhi = std::max(xa,xb);
+      }
+      size_t c0 = cellIndex(xlo - mx - minx,cw,nx);
+      size_t c1 = cellIndex(xhi + mx - minx,cw,nx);
+      for(size_t c = c0; c <= c1; c++)
+        cells[r*nx + c].push_back(e);
+    }
+  }
+
+  size_t count = 0;
+  for(size_t k = 0; k < cells.size(); k++)
+  {
+    const std::vector<size_t>& cell = cells[k];
+    for(size_t i = 0; i < cell.size(); i++)
+      for(size_t j = i+1; j < cell.size(); j++)
+      {
+        const Edge& e1 = edges[cell[i]];
+        const Edge& e2 = edges[cell[j]];
+        if (e1.first == e2.first || e1.first == e2.second ||
+            e1.second == e2.first || e1.second == e2.second)
+          continue;
+        Vector2D point;
+        if (segmentsMeet(points[e1.first],points[e1.second],
+                         points[e2.first],points[e2.second],point) &&
+            cellIndex(point.y - miny,ch,ny)*nx +
+            cellIndex(point.x - minx,cw,nx) == k)
+          ++count;
+      }
+  }
+
+  return count;
+}
+
+size_t
+LayoutMetrics::findBest(const std::vector<Metrics>& metrics)
+{
+  REQUIRE(metrics.size() > 0);
+  size_t best = 0;
+  for(size_t i = 1; i < metrics.size(); i++)
+    if (metrics[i].crossings < metrics[best].crossings ||
+        (metrics[i].crossings == metrics[best].crossings &&
+         metrics[i].stress < metrics[best].stress))
+      best = i;
+  return best;
+}
+
+struct LayoutMetricsStatus
+{
+  bool aborted;
+  std::string error;
+  LayoutMetricsStatus(): aborted(false),error() {}
+};
+
+/*
+  The metrics of the representations first, first + step, ...
+*/
+class LayoutMetricsTask : public ZThread::Runnable
+{
+  const GraphMultiRep& multiRep;
+  const size_t first;
+  const size_t step;
+  const std::vector<LayoutMetrics::Edge>& edges;
+  const std::vector<size_t>& sources;
+  // graph distances from the sources
+  const std::vector<std::vector<unsigned> >& distances;
+  std::atomic<bool>& stop;
+  std::vector<LayoutMetrics::Metrics>& metrics;
+  LayoutMetricsStatus& status;
+  LayoutMetrics::Metrics evaluate(const GraphMultiRep::RepView& rep) const;
+public:
+  LayoutMetricsTask(const GraphMultiRep& reps, size_t firstRep,
+                    size_t repStep,
+                    const std::vector<LayoutMetrics::Edge>& edgeList,
+                    const std::vector<size_t>& stressSources,
+                    const std::vector<std::vector<unsigned> >& dist,
+                    std::atomic<bool>& stopFlag,
+                    std::vector<LayoutMetrics::Metrics>& res,
+                    LayoutMetricsStatus& taskStatus):
+    multiRep(reps),first(firstRep),step(repStep),edges(edgeList),
+    sources(stressSources),distances(dist),stop(stopFlag),metrics(res),
+    status(taskStatus)
+    {
+    }
+  virtual void run()
+    {
+      try
+      {
+        for(size_t r = first; r < multiRep.size(); r += step)
+        {
+          if (stop.load() || ZThread::Thread::interrupted())
+          {
+            status.aborted = true;
+            return;
+          }
+          metrics[r] = evaluate(multiRep.view(r));
+        }
+      }
+      catch(std::exception& e)
+      {
+        status.error = e.what();
+        stop.store(true);
+      }
+      catch(...)
+      {
+        status.error = "Unknown exception";
+        stop.store(true);
+      }
+    }
+};
+
+LayoutMetrics::Metrics
+LayoutMetricsTask::evaluate(const GraphMultiRep::RepView& rep) const
+{
+  LayoutMetrics::Metrics m;
+  size_t dim = rep.dimensions();
+
+  std::vector<Vector2D> points(rep.size());
+  for(size_t v = 0; v < rep.size(); v++)
+    points[v] = Vector2D(rep[v][0],(dim > 1) ? rep[v][1] : 0.0);
+  m.crossings = LayoutMetrics::crossingsCount(edges,points);
+
+  if (edges.size() > 0)
+  {
+    double sum = 0, sum2 = 0;
+    for(size_t e = 0; e < edges.size(); e++)
+    {
+      const double* a = rep[edges[e].first];
+      const double* b = rep[edges[e].second];
+      double l2 = 0;
+      for(size_t d = 0; d < dim; d++)
+        l2 += (a[d] - b[d])*(a[d] - b[d]);
+      sum += std::sqrt(l2);
+      sum2 += l2;
+    }
+    m.edgeLengthMean = sum/edges.size();
+    m.edgeLengthVariance =
+      std::max(sum2/edges.size() - m.edgeLengthMean*m.edgeLengthMean,0.0);
+  }
+
+  // A = sum |x|^2/d^2, B = sum |x|/d, C = sum 1
+  double A = 0, B = 0, C = 0;
+  for(size_t s = 0; s < sources.size(); s++)
+  {
+    const double* a = rep[sources[s]];
+    for(size_t v = 0; v < rep.size(); v++)
+    {
+      unsigned d = distances[s][v];
+      if (d == 0 || d == noPath)
+        continue;
+      const double* b = rep[v];
+      double l2 = 0;
+      for(size_t k = 0; k < dim; k++)
+        l2 += (a[k] - b[k])*(a[k] - b[k]);
+      A += l2/(double(d)*d);
+      B += std::sqrt(l2)/d;
+      C += 1;
+    }
+  }
+  if (C > 0)
+    m.stress = (A > 0) ? std::max(1.0 - B*B/(A*C),0.0) : 1.0;
+
+  return m;
+}
+
+void
+LayoutMetrics::operator()(const GraphMultiRep& multiRep,
+                          const InputParams& input,
+                          std::vector<Metrics>& metrics)
+{
+  logStream() << "\nLayoutMetrics started\n";
+  flushLogStreams();
+
+  const AdjMatrix& g = multiRep.g;
+  size_t VC = g.size();
+
+  std::vector<Edge> edges;
+  std::vector<std::vector<size_t> > adjacent(VC);
+  for(size_t i = 0; i < VC; i++)
+  {
+    checkAborted();
+    for(size_t j = i+1; j < VC; j++)
+      if (g.s(i,j))
+      {
+        edges.push_back(Edge(i,j));
+        adjacent[i].push_back(j);
+        adjacent[j].push_back(i);
+      }
+  }
+
+  std::vector<size_t> sources;
+  if (input.inp_StressSources == 0 || input.inp_StressSources >= VC)
+    for(size_t v = 0; v < VC; v++)
+      sources.push_back(v);
+  else
+    for(size_t s = 0; s < input.inp_StressSources; s++)
+      sources.push_back(s*VC/input.inp_StressSources);
+
+  std::vector<std::vector<unsigned> > distances(sources.size());
+  for(size_t s = 0; s < sources.size(); s++)
+  {
+    checkAborted();
+    std::vector<unsigned>& dist = distances[s];
+    dist.assign(VC,noPath);
+    std::vector<size_t> queue(1,sources[s]);
+    dist[sources[s]] = 0;
+    for(size_t q = 0; q < queue.size(); q++)
+    {
+      size_t v = queue[q];
+      for(size_t a = 0; a < adjacent[v].size(); a++)
+        if (dist[adjacent[v][a]] == noPath)
+        {
+          dist[adjacent[v][a]] = dist[v] + 1;
+          queue.push_back(adjacent[v][a]);
+        }
+    }
+  }
+
+  size_t threads = input.inp_Threads;
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads == 0)
+    threads = 1;
+  if (threads > multiRep.size())
+    threads = std::max(multiRep.size(),size_t(1));
+
+  logStream() << "Evaluating " << multiRep.size() << " representations on "
+              << threads << " thread(s), " << sources.size()
+              << " stress source(s)\n";
+  flushLogStreams();
+
+  metrics.assign(multiRep.size(),Metrics());
+  std::atomic<bool> stop(false);
+  std::vector<LayoutMetricsStatus> status(threads);
+  {
+    ZThread::PoolExecutor pool(threads);
+    for(size_t t = 0; t < threads; t++)
+      pool.execute(ZThread::Task(new LayoutMetricsTask(
+                                   multiRep,t,threads,edges,sources,
+                                   distances,stop,metrics,status[t])));
+    try
+    {
+      // an interrupt of this thread makes wait() throw
+      pool.wait();
+    }
+    catch(...)
+    {
+      // the tasks refer to the metrics and the stop flag
+      stop.store(true);
+      pool.interrupt();
+      pool.wait();
+      throw AbortAlgException("Exiting via the flag...");
+    }
+  }
+
+  for(size_t t = 0; t < status.size(); t++)
+    if (status[t].error != "")
+      throw std::runtime_error("LayoutMetrics: " + status[t].error);
+  for(size_t t = 0; t < status.size(); t++)
+    if (status[t].aborted)
+      throw AbortAlgException("Exiting via the flag...");
+
+  if (metrics.size() > 0)
+  {
+    size_t best = findBest(metrics);
+    logStream() << "Best representation number " << best
+                << ": " << metrics[best].crossings << " crossings, stress = "
+                << metrics[best].stress << "\n";
+    flushLogStreams();
+  }
+
+  logStream() << "LayoutMetrics finished\n" ;
+  flushLogStreams();
+}
+
+} //namespace grctk
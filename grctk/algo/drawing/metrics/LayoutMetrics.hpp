@@ -0,0 +1,93 @@
+/*
+  The LayoutMetrics algorithm (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_LayoutMetrics_hpp
+#define grctk_LayoutMetrics_hpp
+
+#include "grctk/algo/AlgBase.hpp"
+#include "grctk/algo/drawing/GraphMultiRep.hpp"
+#include <yaatk/Vector2D.hpp>
+#include <utility>
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Quality measures of every representation of a GraphMultiRep.
+
+  The edge crossings are counted in the projection onto the first two
+  coordinates. The edges are put into the cells of a uniform grid of
+  about as many cells as there are edges, only the edges sharing a cell
+  are tested against each other, and a crossing is counted in the cell
+  it lies in, which takes O(E + K) for evenly spread layouts. Crossings
+  of edges with a common end are not counted.
+
+  The stress is measured in all the dimensions against the graph
+  distances d from inp_StressSources evenly spaced sources, 64 by
+  default, so that the distances take O(64 V) memory; 0 takes them from
+  every vertex for the exact value at O(V^2). The weights are 1/d^2, and
+  the representation is taken at its best scale:
+  1 - (sum |x|/d)^2 / (sum |x|^2/d^2 * sum 1), which is 0 for a
+  representation with distances proportional to the graph ones.
+
+  The representations are shared out among inp_Threads threads.
+*/
+class LayoutMetrics : public AlgBase
+{
+public:
+  struct Metrics
+  {
+    size_t crossings;
+    double stress;
+    double edgeLengthMean;
+    double edgeLengthVariance;
+    Metrics():
+      crossings(0),stress(0),edgeLengthMean(0),edgeLengthVariance(0) {}
+  };
+  struct InputParams
+  {
+    // 0 = every vertex
+    const size_t inp_StressSources;
+    // 0 runs one thread per processor
+    const size_t inp_Threads;
+    InputParams(
+      const size_t inp_StressSources_def = 64,
+      const size_t inp_Threads_def = 1) :
+      inp_StressSources(inp_StressSources_def),
+      inp_Threads(inp_Threads_def)
+      {
+      }
+  };
+  typedef std::pair<size_t,size_t> Edge;
+  static size_t crossingsCount(const std::vector<Edge>& edges,
+                               const std::vector<yaatk::Vector2D>& points);
+  // the representation with the fewest crossings, of the least stress
+  // among them
+  static size_t findBest(const std::vector<Metrics>& metrics);
+  LayoutMetrics(Log& setlog = nullLog) : AlgBase(setlog) {}
+  void operator()(const GraphMultiRep& multiRep, const InputParams& input,
+                  std::vector<Metrics>& metrics);
+};
+
+} //namespace grctk
+
+#endif
@@ -0,0 +1,253 @@
+/*
+  The IncrementalLayout class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IncrementalLayout.hpp"
+#include <cmath>
+
+namespace grctk
+{
+
+using yaatk::VectorXD;
+
+static const size_t noHops = size_t(-1);
+
+void
+IncrementalLayout::neighbourhood(const AdjMatrix& g,
+                                 const std::vector<size_t>& dirty,
+                                 size_t hops,
+                                 std::vector<size_t>& region,
+                                 std::vector<std::vector<size_t> >& adjacent)
+{
+  std::vector<size_t> distance(g.size(),noHops);
+  region.clear();
+  for(size_t k = 0; k < dirty.size(); ++k)
+  {
+    REQUIRE(dirty[k] < g.size());
+    if (distance[dirty[k]] == noHops)
+    {
+      distance[dirty[k]] = 0;
+      region.push_back(dirty[k]);
+    }
+  }
+  adjacent.assign(region.size(),std::vector<size_t>());
+  // every region vertex needs its adjacency list, so the matrix rows of
+  // the last layer are scanned as well, but not expanded
+  for(size_t r = 0; r < region.size(); ++r)
+  {
+    size_t v = region[r];
+    for(size_t j = 0; j < g.size(); ++j)
+      if (j != v && g.s(v,j))
+      {
+        adjacent[r].push_back(j);
+        if (distance[j] == noHops && distance[v] < hops)
+        {
+          distance[j] = distance[v] + 1;
+          region.push_back(j);
+          adjacent.push_back(std::vector<size_t>());
+        }
+      }
+  }
+}
+
+IncrementalLayout::IncrementalLayout(const PairPotBase::TuneParams &tune_params,
+                                     Log& setlog):
+  AlgBase(setlog),
+  region(),
+  phi(tune_params.alpha0,tune_params.alpha1,tune_params.k,tune_params.r0),
+  cutoff(0),
+  grid(),
+  nearby(),
+  adjacent(),
+  movable()
+{
+}
+
+static
+double
+distanceXD(const VectorXD& v1, const VectorXD& v2)
+{
+  double sum = 0;
+  for(size_t d = 0; d < v1.size(); ++d)
+    sum += yaatk::SQR(v1[d]-v2[d]);
+  return std::sqrt(sum);
+}
+
+double
+IncrementalLayout::Phi(size_t r, GraphRep &rep, bool halfInside,
+                       VectorXD* grad)
+{
+  size_t i = region[r];
+  const VectorXD& pi = rep.aXD[rep.g[i]];
+  double result = 0;
+  if (grad)
+    *grad = 0.0;
+  for(size_t k = 0; k < adjacent[r].size(); ++k)
+  {
+    size_t j = adjacent[r][k];
+    const VectorXD& pj = rep.aXD[rep.g[j]];
+    double R = distanceXD(pi,pj);
+    double e = phi.value(R,1);
+    result += (halfInside && movable[j]) ? e/2 : e;
+    if (grad)
+    {
+      double Der = phi.derivative(R,1)/R;
+      for(size_t d = 0; d < rep.dim; ++d)
+        (*grad)[d] += (pi[d]-pj[d])*Der;
+    }
+  }
+
+  nearby.clear();
+  grid.candidates(pi,nearby);
+  for(size_t k = 0; k < nearby.size(); ++k)
+  {
+    size_t j = nearby[k];
+    if (j == i || rep.g.s(i,j))
+      continue;
+    const VectorXD& pj = rep.aXD[rep.g[j]];
+    double R = distanceXD(pi,pj);
+    if (R >= cutoff)
+      continue;
+    double e = phi.value(R,0);
+    result += (halfInside && movable[j]) ? e/2 : e;
+    if (grad)
+    {
+      double Der = phi.derivative(R,0)/R;
+      for(size_t d = 0; d < rep.dim; ++d)
+        (*grad)[d] += (pi[d]-pj[d])*Der;
+    }
+  }
+  return result;
+}
+
+double
+IncrementalLayout::meanEdgeLength(const GraphRep& rep) const
+{
+  double sum = 0;
+  size_t count = 0;
+  for(size_t r = 0; r < region.size(); ++r)
+    for(size_t k = 0; k < adjacent[r].size(); ++k)
+    {
+      sum += distanceXD(rep.aXD[rep.g[region[r]]],
+                        rep.aXD[rep.g[adjacent[r][k]]]);
+      ++count;
+    }
+  return (count > 0) ? sum/count : 0.0;
+}
+
+void
+IncrementalLayout::operator()(const InputParams &input,
+                              const std::vector<size_t>& dirty,
+                              GraphRep &rep)
+{
+  logStream() << "\nIncrementalLayout started\n";
+  flushLogStreams();
+
+  REQUIRE(input.inp_ErrorBound > 0 && input.inp_ErrorBound < 1);
+  const size_t n = rep.g.size();
+  for(size_t i = 0; i < n; i++)
+  {
+    VectorXD position(0.0,rep.dim);
+    for(size_t d = 0; d < rep.dim && d < 3; ++d)
+      position[d] = input.a3D[rep.g[i]].X(d);
+    rep.aXD[rep.g[i]] = position;
+  }
+
+  neighbourhood(rep.g,dirty,input.inp_Hops,region,adjacent);
+  movable.assign(n,false);
+  for(size_t r = 0; r < region.size(); ++r)
+    movable[region[r]] = true;
+
+  logStream() << "Optimizing " << region.size() << " of " << n
+              << " vertices, within " << input.inp_Hops
+              << " hops of " << dirty.size() << " dirty ones\n";
+  flushLogStreams();
+
+  cutoff = phi.phi0Cutoff(input.inp_ErrorBound);
+  if (input.inp_Cutoff > 0 && input.inp_Cutoff < cutoff)
+    cutoff = input.inp_Cutoff;
+  phi.setCutoff(cutoff);
+  std::vector<const VectorXD*> positions(n);
+  for(size_t i = 0; i < n; ++i)
+    positions[i] = &rep.aXD[rep.g[i]];
+  grid.build(positions,cutoff);
+
+  double L = input.inp_LInit;
+  if (L <= 0)
+    L = 0.5*meanEdgeLength(rep);
+  if (L <= 0)
+    L = cutoff;
+
+  double total = 0;
+  for(size_t r = 0; r < region.size(); ++r)
+    total += Phi(r,rep,true);
+  rep.energyTrace.clear();
+  rep.energyTrace.push_back(total);
+
+  VectorXD oldPos(rep.dim), FiVec(rep.dim);
+  while (!region.empty())
+  {
+    bool moreOptimal = false;
+    for(size_t r = 0; r < region.size(); r++)
+    {
+      checkAborted();
+
+      size_t i = region[r];
+      double PhiOld = Phi(r,rep,false,&FiVec);
+      double module = yaatk::module(FiVec);
+      // nothing within the cutoff and no edges: nowhere to go
+      if (module == 0)
+        continue;
+      oldPos = rep.aXD[rep.g[i]];
+
+      rep.aXD[rep.g[i]] = oldPos - L*FiVec/module;
+      double PhiNew = Phi(r,rep,false);
+
+      if (PhiNew >= PhiOld)
+        rep.aXD[rep.g[i]] = oldPos;
+      else
+      {
+        moreOptimal = true;
+        // pairs of i with frozen and with region vertices alike are
+        // counted once in the total
+        total += PhiNew - PhiOld;
+        grid.move(i,rep.aXD[rep.g[i]]);
+      }
+    }
+    rep.energyTrace.push_back(total);
+    if (!moreOptimal)
+    {
+      if (L < input.inp_Eps)
+        break;
+      else
+        L = L/2;
+    }
+  }
+
+  rep.energy = total;
+
+  logStream() << "Sweeps: " << rep.energyTrace.size()-1
+              << ", region energy " << rep.energyTrace.front()
+              << " -> " << rep.energy << "\n";
+  logStream() << "IncrementalLayout finished\n" ;
+  flushLogStreams();
+}
+
+} //namespace grctk
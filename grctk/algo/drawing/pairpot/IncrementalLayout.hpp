@@ -0,0 +1,114 @@
+/*
+  The IncrementalLayout class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_IncrementalLayout_hpp
+#define grctk_IncrementalLayout_hpp
+
+#include "PairPotBase.hpp"
+#include "Potentials.hpp"
+#include "NeighbourGrid.hpp"
+#include "grctk/algo/AlgBase.hpp"
+#include "grctk/AdjMatrix.hpp"
+#include "grctk/Universe.hpp"
+#include "grctk/algo/drawing/GraphRep.hpp"
+#include <yaatk/Vector3D.hpp>
+#include <yaatk/VectorXD.hpp>
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Re-layout after a local edit: the existing positions are kept, and
+  only the vertices within inp_Hops edges of the dirty (edited) ones
+  are optimized, by the PairPotBase coordinate descent, while the rest
+  stay frozen. The interactions of non-adjacent vertices are cut off
+  as in the approximate mode of PairPotBase and found with a grid, so
+  a sweep costs O(region size) and the whole run only adds a few O(n)
+  passes (copying the positions, the grid, a matrix row per region
+  vertex) to it, instead of O(n^2) per sweep over the whole graph.
+
+  rep.energy and rep.energyTrace hold the energy of the pairs having
+  at least one vertex in the region.
+*/
+class IncrementalLayout : public AlgBase
+{
+public:
+  struct InputParams
+  {
+    const Attribute<yaatk::Vector3D>& a3D;
+    const size_t inp_Hops;
+    // initial step, 0 = half the mean length of the region edges
+    const double inp_LInit;
+    const double inp_Eps;
+    // non-adjacent pairs interact closer than phi0Cutoff(inp_ErrorBound),
+    // or inp_Cutoff if that is smaller (0 = not used)
+    const double inp_ErrorBound;
+    const double inp_Cutoff;
+    InputParams(
+      const Attribute<yaatk::Vector3D>& a3D_def,
+      const size_t inp_Hops_def = 2,
+      const double inp_LInit_def = 0.0,
+      const double inp_Eps_def = 0.0001,
+      const double inp_ErrorBound_def = 1.0e-6,
+      const double inp_Cutoff_def = 0) :
+      a3D(a3D_def),
+      inp_Hops(inp_Hops_def),
+      inp_LInit(inp_LInit_def),
+      inp_Eps(inp_Eps_def),
+      inp_ErrorBound(inp_ErrorBound_def),
+      inp_Cutoff(inp_Cutoff_def)
+      {
+      }
+  };
+  // the vertices optimized by the last run, in the BFS order
+  std::vector<size_t> region;
+  // the vertices within hops edges of the dirty ones, in the BFS order,
+  // and their adjacency lists
+  static void neighbourhood(const AdjMatrix& g,
+                            const std::vector<size_t>& dirty, size_t hops,
+                            std::vector<size_t>& region,
+                            std::vector<std::vector<size_t> >& adjacent);
+private:
+  PPhi phi;
+  double cutoff;
+  NeighbourGrid grid;
+  std::vector<size_t> nearby;
+  std::vector<std::vector<size_t> > adjacent;
+  std::vector<bool> movable;
+  // energy of region vertex r, pairs within the region taken by a half
+  // if halfInside; its gradient is added to grad if given
+  double Phi(size_t r, GraphRep& rep, bool halfInside,
+             yaatk::VectorXD* grad = NULL);
+  double meanEdgeLength(const GraphRep& rep) const;
+public:
+  void operator()(const InputParams &input, const std::vector<size_t>& dirty,
+                  GraphRep &rep);
+  IncrementalLayout(const PairPotBase::TuneParams &tune_params,
+                    Log& setlog = nullLog);
+private:
+  IncrementalLayout(const IncrementalLayout &);
+  IncrementalLayout & operator = (const IncrementalLayout &);
+};
+
+} //namespace grctk
+
+#endif
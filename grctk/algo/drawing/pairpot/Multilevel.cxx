@@ -0,0 +1,322 @@
+/*
+  The Multilevel class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Multilevel.hpp"
+#include <gsl/gsl_rng.h>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+namespace grctk
+{
+
+using yaatk::VectorXD;
+
+static const size_t noParent = size_t(-1);
+
+size_t
+Multilevel::matchingCoarsening(const AdjacencyLists& adjacent,
+                               const std::vector<size_t>& order,
+                               std::vector<size_t>& parent)
+{
+  parent.assign(adjacent.size(),noParent);
+  size_t coarseSize = 0;
+  for(size_t k = 0; k < order.size(); ++k)
+  {
+    size_t v = order[k];
+    if (parent[v] != noParent)
+      continue;
+    // the unmatched neighbour of the lowest degree, so hubs stay free
+    // for their leaves
+    size_t mate = noParent;
+    for(size_t a = 0; a < adjacent[v].size(); ++a)
+    {
+      size_t u = adjacent[v][a];
+      if (parent[u] == noParent && u != v &&
+          (mate == noParent || adjacent[u].size() < adjacent[mate].size()))
+        mate = u;
+    }
+    parent[v] = coarseSize;
+    if (mate != noParent)
+      parent[mate] = coarseSize;
+    ++coarseSize;
+  }
+  return coarseSize;
+}
+
+size_t
+Multilevel::independentSetCoarsening(const AdjacencyLists& adjacent,
+                                     const std::vector<size_t>& order,
+                                     std::vector<size_t>& parent)
+{
+  parent.assign(adjacent.size(),noParent);
+  std::vector<bool> inSet(adjacent.size(),false);
+  std::vector<bool> covered(adjacent.size(),false);
+  size_t coarseSize = 0;
+  for(size_t k = 0; k < order.size(); ++k)
+  {
+    size_t v = order[k];
+    if (covered[v])
+      continue;
+    parent[v] = coarseSize++;
+    inSet[v] = true;
+    covered[v] = true;
+    for(size_t a = 0; a < adjacent[v].size(); ++a)
+      covered[adjacent[v][a]] = true;
+  }
+  // every other vertex has a neighbour in the set and joins it
+  for(size_t v = 0; v < adjacent.size(); ++v)
+    if (!inSet[v])
+      for(size_t a = 0; a < adjacent[v].size(); ++a)
+        if (inSet[adjacent[v][a]])
+        {
+          parent[v] = parent[adjacent[v][a]];
+          break;
+        }
+  return coarseSize;
+}
+
+Multilevel::AdjacencyLists
+Multilevel::coarseAdjacency(const AdjacencyLists& adjacent,
+                            const std::vector<size_t>& parent,
+                            size_t coarseSize)
+{
+  AdjacencyLists coarse(coarseSize);
+  for(size_t v = 0; v < adjacent.size(); ++v)
+    for(size_t a = 0; a < adjacent[v].size(); ++a)
+    {
+      size_t cv = parent[v];
+      size_t cu = parent[adjacent[v][a]];
+      if (cv != cu)
+        coarse[cv].push_back(cu);
+    }
+  for(size_t c = 0; c < coarseSize; ++c)
+  {
+    std::sort(coarse[c].begin(),coarse[c].end());
+    coarse[c].erase(std::unique(coarse[c].begin(),coarse[c].end()),
+                    coarse[c].end());
+  }
+  return coarse;
+}
+
+Multilevel::Multilevel(const PairPotBase::TuneParams &tune_params,
+                       Log& setlog):
+  AlgBase(setlog),
+  tune(tune_params),
+  levels()
+{
+}
+
+void
+Multilevel::coarsen(const InputParams &input, const AdjMatrix& g,
+                    unsigned long seed)
+{
+  gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+  REQUIRE(rng != NULL);
+  gsl_rng_set(rng, seed);
+
+  try
+  {
+    levels.assign(1,Level());
+    levels[0].adjacent.resize(g.size());
+    for(size_t i = 0; i < g.size(); ++i)
+      for(size_t j = 0; j < g.size(); ++j)
+        if (i != j && g.s(i,j))
+          levels[0].adjacent[i].push_back(j);
+
+    while (levels.back().adjacent.size() > input.inp_CoarsestSize)
+    {
+      checkAborted();
+      const AdjacencyLists& fine = levels.back().adjacent;
+      std::vector<size_t> order(fine.size());
+      for(size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+      for(size_t i = order.size(); i > 1; --i)
+        std::swap(order[i-1],order[gsl_rng_uniform_int(rng,i)]);
+
+      std::vector<size_t> parent;
+      size_t coarseSize = matchingCoarsening(fine,order,parent);
+      if (4*coarseSize > 3*fine.size())
+        coarseSize = independentSetCoarsening(fine,order,parent);
+      if (coarseSize == fine.size())
+        break;
+
+      Level coarse;
+      coarse.adjacent = coarseAdjacency(fine,parent,coarseSize);
+      levels.back().parent = parent;
+      levels.push_back(coarse);
+    }
+  }
+  catch(...)
+  {
+    gsl_rng_free(rng);
+    throw;
+  }
+
+  gsl_rng_free(rng);
+}
+
+static
+AdjMatrix
+buildGraph(const Multilevel::AdjacencyLists& adjacent)
+{
+  AdjMatrix g;
+  for(size_t i = 0; i < adjacent.size(); ++i)
+    g += Universe::singleton().create();
+  for(size_t i = 0; i < adjacent.size(); ++i)
+    for(size_t a = 0; a < adjacent[i].size(); ++a)
+      if (i < adjacent[i][a])
+        g.edge(i,adjacent[i][a],Universe::singleton().create());
+  return g;
+}
+
+static
+double
+meanEdgeLength(const Multilevel::AdjacencyLists& adjacent,
+               const std::vector<VectorXD>& positions)
+{
+  double sum = 0;
+  size_t count = 0;
+  for(size_t i = 0; i < adjacent.size(); ++i)
+    for(size_t a = 0; a < adjacent[i].size(); ++a)
+    {
+      sum += yaatk::module(VectorXD(positions[i] - positions[adjacent[i][a]]));
+      ++count;
+    }
+  return (count > 0) ? sum/count : 0.0;
+}
+
+void
+Multilevel::operator()(const PairPotBase::InputParams &inputBase,
+                       const InputParams &input, GraphRep &rep)
+{
+  logStream() << "\nMultilevel started\n";
+  flushLogStreams();
+
+  if (inputBase.inp_UseExisted)
+  {
+    logStream() << "Refining the existing representation, no coarsening\n";
+    flushLogStreams();
+    PairPotBase alg(tune,log);
+    alg(inputBase,rep);
+    logStream() << "Multilevel finished\n" ;
+    flushLogStreams();
+    return;
+  }
+
+  unsigned long seed = inputBase.inp_Seed;
+  if (seed == 0)
+    seed = (unsigned long)(rand()) + 1;
+  coarsen(input,rep.g,seed);
+
+  logStream() << "Levels:";
+  for(size_t l = 0; l < levels.size(); ++l)
+    logStream() << " " << levels[l].adjacent.size();
+  logStream() << "\n";
+  flushLogStreams();
+
+  gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+  REQUIRE(rng != NULL);
+  gsl_rng_set(rng, seed);
+
+  try
+  {
+    std::vector<VectorXD> positions;
+    for(size_t l = levels.size(); l-- > 0;)
+    {
+      const AdjacencyLists& adjacent = levels[l].adjacent;
+      double step = 0;
+      if (l + 1 < levels.size())
+      {
+        // prolongation: the coarse positions, scattered by a tenth of the
+        // coarse edge length so that merged vertices do not coincide
+        double edge = meanEdgeLength(levels[l+1].adjacent,positions);
+        if (edge == 0)
+          edge = tune.r0;
+        std::vector<VectorXD> fine(adjacent.size(),VectorXD(rep.dim));
+        for(size_t v = 0; v < adjacent.size(); ++v)
+        {
+          fine[v] = positions[levels[l].parent[v]];
+          for(size_t d = 0; d < rep.dim; ++d)
+            fine[v][d] += 0.1*edge*(2.0*gsl_rng_uniform(rng) - 1.0);
+        }
+        positions.swap(fine);
+        step = 0.5*edge;
+      }
+
+      AdjMatrix levelGraph;
+      if (l == 0)
+        levelGraph = rep.g;
+      else
+        levelGraph = buildGraph(adjacent);
+      GraphRep levelRep(levelGraph,rep.dim);
+      PairPotBase alg(tune,log);
+      if (l + 1 == levels.size())
+      {
+        PairPotBase::InputParams coarsest(
+          inputBase.a3D,inputBase.inp_LInit,inputBase.inp_Eps,false,
+          inputBase.inp_Approximate,inputBase.inp_ErrorBound,
+          gsl_rng_get(rng) | 1,inputBase.inp_Optimizer,
+          inputBase.inp_ExpMaxError,inputBase.inp_Cutoff,
+          inputBase.inp_Spectral);
+        alg(coarsest,levelRep);
+      }
+      else
+      {
+        for(size_t v = 0; v < adjacent.size(); ++v)
+          levelRep.aXD[levelGraph[v]] = positions[v];
+        PairPotBase::InputParams refining(
+          inputBase.a3D,step,inputBase.inp_Eps,false,
+          inputBase.inp_Approximate,inputBase.inp_ErrorBound,
+          0,inputBase.inp_Optimizer,
+          inputBase.inp_ExpMaxError,inputBase.inp_Cutoff);
+        alg.refine(refining,levelRep);
+      }
+      positions.resize(adjacent.size());
+      for(size_t v = 0; v < adjacent.size(); ++v)
+        positions[v] = levelRep.aXD[levelGraph[v]];
+
+      logStream() << "Level " << l << ", " << adjacent.size()
+                  << " vertices, energy = " << levelRep.energy << "\n";
+      flushLogStreams();
+
+      if (l == 0)
+      {
+        for(size_t v = 0; v < rep.g.size(); ++v)
+          rep.aXD[rep.g[v]] = positions[v];
+        rep.energy = levelRep.energy;
+        rep.energyTrace = levelRep.energyTrace;
+      }
+    }
+  }
+  catch(...)
+  {
+    gsl_rng_free(rng);
+    throw;
+  }
+
+  gsl_rng_free(rng);
+
+  logStream() << "Multilevel finished\n" ;
+  flushLogStreams();
+}
+
+} //namespace grctk
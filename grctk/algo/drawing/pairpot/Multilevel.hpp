@@ -0,0 +1,89 @@
+/*
+  The Multilevel class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_Multilevel_hpp
+#define grctk_Multilevel_hpp
+
+#include "PairPotBase.hpp"
+#include "grctk/algo/AlgBase.hpp"
+#include "grctk/algo/drawing/GraphRep.hpp"
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Multilevel layout: the graph is coarsened level by level, by random
+  matchings while they shrink it by at least a quarter and by maximal
+  independent sets otherwise, down to inp_CoarsestSize vertices. The
+  coarsest graph is laid out by PairPotBase from scratch; every finer
+  level starts from the positions of the coarse vertices its vertices
+  were merged into, slightly scattered, and is refined by PairPotBase
+  with a step of the order of the coarse edge length.
+*/
+class Multilevel : public AlgBase
+{
+public:
+  struct InputParams
+  {
+    const size_t inp_CoarsestSize;
+    InputParams(
+      const size_t inp_CoarsestSize_def = 20) :
+      inp_CoarsestSize(inp_CoarsestSize_def)
+      {
+      }
+  };
+  typedef std::vector<std::vector<size_t> > AdjacencyLists;
+  // parent[v] is the coarse vertex v is merged into; returns the
+  // number of coarse vertices
+  static size_t matchingCoarsening(const AdjacencyLists& adjacent,
+                                   const std::vector<size_t>& order,
+                                   std::vector<size_t>& parent);
+  static size_t independentSetCoarsening(const AdjacencyLists& adjacent,
+                                         const std::vector<size_t>& order,
+                                         std::vector<size_t>& parent);
+  static AdjacencyLists coarseAdjacency(const AdjacencyLists& adjacent,
+                                        const std::vector<size_t>& parent,
+                                        size_t coarseSize);
+private:
+  PairPotBase::TuneParams tune;
+  struct Level
+  {
+    AdjacencyLists adjacent;
+    // index of the coarse vertex in the next level
+    std::vector<size_t> parent;
+  };
+  std::vector<Level> levels;
+  void coarsen(const InputParams &input, const AdjMatrix& g,
+               unsigned long seed);
+public:
+  void operator()(const PairPotBase::InputParams &inputBase,
+                  const InputParams &input, GraphRep &rep);
+  Multilevel(const PairPotBase::TuneParams &tune_params,
+             Log& setlog = nullLog);
+private:
+  Multilevel(const Multilevel &);
+  Multilevel & operator = (const Multilevel &);
+};
+
+} //namespace grctk
+
+#endif
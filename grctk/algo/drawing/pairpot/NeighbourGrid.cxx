@@ -0,0 +1,130 @@
+/*
+  The NeighbourGrid class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "NeighbourGrid.hpp"
+#include <cmath>
+
+namespace grctk
+{
+
+// 21 bits per hashed coordinate; far cells may share a key, which only
+// adds candidates
+static const int cellKeyBits = 21;
+
+NeighbourGrid::NeighbourGrid():
+  cellSize(1.0),gridDim(0),cells(),cellOf(),slotOf()
+{
+}
+
+NeighbourGrid::CellKey
+NeighbourGrid::key(const long* c) const
+{
+  const CellKey mask = (CellKey(1) << cellKeyBits) - 1;
+  CellKey k = 0;
+  for(size_t d = 0; d < gridDim; ++d)
+    k = (k << cellKeyBits) | (CellKey(c[d]) & mask);
+  return k;
+}
+
+void
+NeighbourGrid::cellCoords(const yaatk::VectorXD& pos, long* c) const
+{
+  for(size_t d = 0; d < gridDim; ++d)
+    c[d] = long(std::floor(pos[d]/cellSize));
+}
+
+void
+NeighbourGrid::insert(size_t i, CellKey k)
+{
+  std::vector<size_t>& cell = cells[k];
+  cellOf[i] = k;
+  slotOf[i] = cell.size();
+  cell.push_back(i);
+}
+
+void
+NeighbourGrid::erase(size_t i)
+{
+  Cells::iterator it = cells.find(cellOf[i]);
+  std::vector<size_t>& cell = it->second;
+  size_t last = cell.back();
+  cell[slotOf[i]] = last;
+  slotOf[last] = slotOf[i];
+  cell.pop_back();
+  if (cell.empty())
+    cells.erase(it);
+}
+
+void
+NeighbourGrid::build(const std::vector<const yaatk::VectorXD*>& positions,
+                     double cutoff)
+{
+  cellSize = cutoff;
+  gridDim = positions.empty() ? 0 : positions[0]->size();
+  if (gridDim > 3)
+    gridDim = 3;
+  cells.clear();
+  cellOf.resize(positions.size());
+  slotOf.resize(positions.size());
+  long c[3];
+  for(size_t i = 0; i < positions.size(); ++i)
+  {
+    cellCoords(*positions[i],c);
+    insert(i,key(c));
+  }
+}
+
+void
+NeighbourGrid::move(size_t i, const yaatk::VectorXD& newPos)
+{
+  long c[3];
+  cellCoords(newPos,c);
+  CellKey k = key(c);
+  if (k == cellOf[i])
+    return;
+  erase(i);
+  insert(i,k);
+}
+
+void
+NeighbourGrid::candidates(const yaatk::VectorXD& pos,
+                          std::vector<size_t>& result) const
+{
+  long c[3], n[3];
+  cellCoords(pos,c);
+  size_t count = 1;
+  for(size_t d = 0; d < gridDim; ++d)
+    count *= 3;
+  for(size_t m = 0; m < count; ++m)
+  {
+    size_t rest = m;
+    for(size_t d = 0; d < gridDim; ++d)
+    {
+      n[d] = c[d] + long(rest % 3) - 1;
+      rest /= 3;
+    }
+    Cells::const_iterator it = cells.find(key(n));
+    if (it != cells.end())
+      result.insert(result.end(), it->second.begin(), it->second.end());
+  }
+}
+
+} //namespace grctk
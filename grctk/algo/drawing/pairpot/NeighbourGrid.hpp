@@ -0,0 +1,69 @@
+/*
+  The NeighbourGrid class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_NeighbourGrid_hpp
+#define grctk_NeighbourGrid_hpp
+
+#include <yaatk/VectorXD.hpp>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+namespace grctk
+{
+
+/*
+  Uniform grid of points with cells of the cutoff size, used to find
+  all the points closer than the cutoff to a given position.
+
+  Only the first (up to) three coordinates are hashed: the projected
+  distance never exceeds the full one, so the 3^d neighbouring cells of
+  the projection still contain every point within the cutoff, while
+  their number stays bounded in any dimension. Callers check the full
+  distance of the candidates.
+*/
+class NeighbourGrid
+{
+  typedef uint64_t CellKey;
+  typedef std::map<CellKey, std::vector<size_t> > Cells;
+  double cellSize;
+  size_t gridDim;
+  Cells cells;
+  std::vector<CellKey> cellOf;
+  std::vector<size_t> slotOf;
+  CellKey key(const long* c) const;
+  void cellCoords(const yaatk::VectorXD& pos, long* c) const;
+  void insert(size_t i, CellKey k);
+  void erase(size_t i);
+public:
+  NeighbourGrid();
+  // positions[i] is the position of point i
+  void build(const std::vector<const yaatk::VectorXD*>& positions,
+             double cutoff);
+  void move(size_t i, const yaatk::VectorXD& newPos);
+  // appends the points in the cells around pos to result
+  void candidates(const yaatk::VectorXD& pos,
+                  std::vector<size_t>& result) const;
+};
+
+} //namespace grctk
+
+#endif
@@ -0,0 +1,390 @@
+/*
+  The PairKernel class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PairKernel.hpp"
+#include "Potentials.hpp"
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+  (defined(__x86_64__) || defined(__i386__))
+#define GRCTK_PAIRKERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace grctk
+{
+
+static
+double
+energyPassScalar(const PairKernel::Params& p,
+                 const double* coords, size_t stride,
+                 size_t dim, const double* pos,
+                 size_t begin, size_t end, double* factor, double* energy)
+{
+  double sum = 0;
+  for(size_t j = begin; j < end; ++j)
+  {
+    double R2 = 0;
+    for(size_t d = 0; d < dim; ++d)
+    {
+      double t = pos[d] - coords[d*stride + j];
+      R2 += t*t;
+    }
+    double R = std::sqrt(R2);
+    double x = p.alpha0*(p.r0 - R);
+    double e = (R < p.cutoff) ?
+      p.k*(p.scalarFastExp ? p.exp(x) : std::exp(x)) : 0.0;
+    sum += e;
+    energy[j] = e;
+    factor[j] = -p.alpha0*e/R;
+  }
+  return sum;
+}
+
+static
+void
+gradientPassScalar(const double* coords, size_t stride,
+                   size_t dim, const double* pos,
+                   size_t n, const double* factor,
+                   double* grad)
+{
+  for(size_t d = 0; d < dim; ++d)
+  {
+    const double* c = coords + d*stride;
+    double sum = 0;
+    for(size_t j = 0; j < n; ++j)
+      sum += (pos[d] - c[j])*factor[j];
+    grad[d] = sum;
+  }
+}
+
+#ifdef GRCTK_PAIRKERNEL_X86
+
+// the vector counterparts of yaatk::FastExp
+#define GRCTK_EXP_MAX 708.0
+#define GRCTK_LN2_HI 6.93145751953125E-1
+#define GRCTK_LN2_LO 1.42860682030941723212E-6
+#define GRCTK_LOG2E 1.4426950408889634074
+
+__attribute__((target("avx2,fma")))
+static inline
+__m256d
+expAvx2(__m256d x, const double* coef, int degree)
+{
+  x = _mm256_min_pd(_mm256_max_pd(x,_mm256_set1_pd(-GRCTK_EXP_MAX)),
+                    _mm256_set1_pd(GRCTK_EXP_MAX));
+  __m256d n = _mm256_round_pd(_mm256_mul_pd(x,_mm256_set1_pd(GRCTK_LOG2E)),
+                              _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC);
+  __m256d r = _mm256_fnmadd_pd(n,_mm256_set1_pd(GRCTK_LN2_HI),x);
+  r = _mm256_fnmadd_pd(n,_mm256_set1_pd(GRCTK_LN2_LO),r);
+  __m256d p = _mm256_set1_pd(coef[degree]);
+  for(int c = degree - 1; c >= 0; --c)
+    p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(coef[c]));
+  __m256i e = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+  e = _mm256_slli_epi64(_mm256_add_epi64(e,_mm256_set1_epi64x(1023)),52);
+  return _mm256_mul_pd(p,_mm256_castsi256_pd(e));
+}
+
+__attribute__((target("avx2,fma")))
+static inline
+double
+sumAvx2(__m256d v)
+{
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v),
+                         _mm256_extractf128_pd(v,1));
+  return _mm_cvtsd_f64(_mm_add_sd(s,_mm_unpackhi_pd(s,s)));
+}
+
+__attribute__((target("avx2,fma")))
+static
+double
+energyPassAvx2(const PairKernel::Params& p,
+               const double* coords, size_t stride,
+               size_t dim, const double* pos,
+               size_t begin, size_t end, double* factor, double* energy)
+{
+  const __m256d alpha0 = _mm256_set1_pd(p.alpha0);
+  const __m256d minusAlpha0 = _mm256_set1_pd(-p.alpha0);
+  const __m256d k = _mm256_set1_pd(p.k);
+  const __m256d r0 = _mm256_set1_pd(p.r0);
+  const __m256d cutoff = _mm256_set1_pd(p.cutoff);
+  const double* coef = p.exp.coefficients();
+  const int degree = p.exp.degree();
+  __m256d sum = _mm256_setzero_pd();
+  size_t j = begin;
+  for(; j + 4 <= end; j += 4)
+  {
+    __m256d R2 = _mm256_setzero_pd();
+    for(size_t d = 0; d < dim; ++d)
+    {
+      __m256d t = _mm256_sub_pd(_mm256_set1_pd(pos[d]),
+                                _mm256_loadu_pd(coords + d*stride + j));
+      R2 = _mm256_fmadd_pd(t,t,R2);
+    }
+    __m256d R = _mm256_sqrt_pd(R2);
+    __m256d e = _mm256_mul_pd(k,expAvx2(_mm256_mul_pd(alpha0,
+                                                      _mm256_sub_pd(r0,R)),
+                                        coef,degree));
+    e = _mm256_and_pd(e,_mm256_cmp_pd(R,cutoff,_CMP_LT_OQ));
+    sum = _mm256_add_pd(sum,e);
+    _mm256_storeu_pd(energy + j,e);
+    _mm256_storeu_pd(factor + j,_mm256_div_pd(_mm256_mul_pd(minusAlpha0,e),R));
+  }
+  return sumAvx2(sum) +
+    energyPassScalar(p,coords,stride,dim,pos,j,end,factor,energy);
+}
+
+__attribute__((target("avx2,fma")))
+static
+void
+gradientPassAvx2(const double* coords, size_t stride,
+                 size_t dim, const double* pos,
+                 size_t n, const double* factor,
+                 double* grad)
+{
+  for(size_t d = 0; d < dim; ++d)
+  {
+    const double* c = coords + d*stride;
+    const __m256d pd = _mm256_set1_pd(pos[d]);
+    __m256d acc = _mm256_setzero_pd();
+    size_t j = 0;
+    for(; j + 4 <= n; j += 4)
+      acc = _mm256_fmadd_pd(_mm256_sub_pd(pd,_mm256_loadu_pd(c + j)),
+                            _mm256_loadu_pd(factor + j),acc);
+    double sum = sumAvx2(acc);
+    for(; j < n; ++j)
+      sum += (pos[d] - c[j])*factor[j];
+    grad[d] = sum;
+  }
+}
+
+__attribute__((target("avx512f")))
+static inline
+__m512d
+expAvx512(__m512d x, const double* coef, int degree)
+{
+  x = _mm512_min_pd(_mm512_max_pd(x,_mm512_set1_pd(-GRCTK_EXP_MAX)),
+                    _mm512_set1_pd(GRCTK_EXP_MAX));
+  __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x,_mm512_set1_pd(GRCTK_LOG2E)),
+                                   _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC);
+  __m512d r = _mm512_fnmadd_pd(n,_mm512_set1_pd(GRCTK_LN2_HI),x);
+  r = _mm512_fnmadd_pd(n,_mm512_set1_pd(GRCTK_LN2_LO),r);
+  __m512d p = _mm512_set1_pd(coef[degree]);
+  for(int c = degree - 1; c >= 0; --c)
+    p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(coef[c]));
+  return _mm512_scalef_pd(p,n);
+}
+
+__attribute__((target("avx512f")))
+static
+double
+energyPassAvx512(const PairKernel::Params& p,
+                 const double* coords, size_t stride,
+                 size_t dim, const double* pos,
+                 size_t begin, size_t end, double* factor, double* energy)
+{
+  const __m512d alpha0 = _mm512_set1_pd(p.alpha0);
+  const __m512d minusAlpha0 = _mm512_set1_pd(-p.alpha0);
+  const __m512d k = _mm512_set1_pd(p.k);
+  const __m512d r0 = _mm512_set1_pd(p.r0);
+  const __m512d cutoff = _mm512_set1_pd(p.cutoff);
+  const double* coef = p.exp.coefficients();
+  const int degree = p.exp.degree();
+  __m512d sum = _mm512_setzero_pd();
+  size_t j = begin;
+  for(; j + 8 <= end; j += 8)
+  {
+    __m512d R2 = _mm512_setzero_pd();
+    for(size_t d = 0; d < dim; ++d)
+    {
+      __m512d t = _mm512_sub_pd(_mm512_set1_pd(pos[d]),
+                                _mm512_loadu_pd(coords + d*stride + j));
+      R2 = _mm512_fmadd_pd(t,t,R2);
+    }
+    __m512d R = _mm512_sqrt_pd(R2);
+    __m512d e = _mm512_mul_pd(k,expAvx512(_mm512_mul_pd(alpha0,
+                                                        _mm512_sub_pd(r0,R)),
+                                          coef,degree));
+    e = _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(R,cutoff,_CMP_LT_OQ),e);
+    sum = _mm512_add_pd(sum,e);
+    _mm512_storeu_pd(energy + j,e);
+    _mm512_storeu_pd(factor + j,_mm512_div_pd(_mm512_mul_pd(minusAlpha0,e),R));
+  }
+  return _mm512_reduce_add_pd(sum) +
+    energyPassScalar(p,coords,stride,dim,pos,j,end,factor,energy);
+}
+
+__attribute__((target("avx512f")))
+static
+void
+gradientPassAvx512(const double* coords, size_t stride,
+                   size_t dim, const double* pos,
+                   size_t n, const double* factor,
+                   double* grad)
+{
+  for(size_t d = 0; d < dim; ++d)
+  {
+    const double* c = coords + d*stride;
+    const __m512d pd = _mm512_set1_pd(pos[d]);
+    __m512d acc = _mm512_setzero_pd();
+    size_t j = 0;
+    for(; j + 8 <= n; j += 8)
+      acc = _mm512_fmadd_pd(_mm512_sub_pd(pd,_mm512_loadu_pd(c + j)),
+                            _mm512_loadu_pd(factor + j),acc);
+    double sum = _mm512_reduce_add_pd(acc);
+    for(; j < n; ++j)
+      sum += (pos[d] - c[j])*factor[j];
+    grad[d] = sum;
+  }
+}
+
+#endif
+
+PairKernel::Isa
+PairKernel::detectIsa()
+{
+#ifdef GRCTK_PAIRKERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return ISA_AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return ISA_AVX2;
+#endif
+  return ISA_SCALAR;
+}
+
+const char*
+PairKernel::isaName(Isa isa)
+{
+  switch (isa)
+  {
+  case ISA_AVX512: return "AVX-512";
+  case ISA_AVX2: return "AVX2";
+  default: return "scalar";
+  }
+}
+
+PairKernel::PairKernel():
+  params(),isa(ISA_SCALAR),
+  energyPass(energyPassScalar),gradientPass(gradientPassScalar),
+  n(0),dim(0),stride(0),
+  coords(),adjacent(),factor(),energy(),pos()
+{
+}
+
+void
+PairKernel::setup(double alpha0, double alpha1, double k, double r0,
+                  const std::vector<std::vector<size_t> >& adjacentLists,
+                  size_t dim_, Isa requested)
+{
+  params.alpha0 = alpha0;
+  params.alpha1 = alpha1;
+  params.k = k;
+  params.r0 = r0;
+  params.cutoff = HUGE_VAL;
+  params.exp = yaatk::FastExp();
+  params.scalarFastExp = false;
+
+  n = adjacentLists.size();
+  dim = dim_;
+  // rows start at 64-byte boundaries relative to each other
+  stride = (n + 7)/8*8;
+  coords.assign(dim*stride,0.0);
+  adjacent = adjacentLists;
+  factor.assign(stride,0.0);
+  energy.assign(stride,0.0);
+  pos.assign(dim,0.0);
+
+  Isa best = detectIsa();
+  isa = (requested > best) ? best : requested;
+  energyPass = energyPassScalar;
+  gradientPass = gradientPassScalar;
+#ifdef GRCTK_PAIRKERNEL_X86
+  if (isa == ISA_AVX512)
+  {
+    energyPass = energyPassAvx512;
+    gradientPass = gradientPassAvx512;
+  }
+  if (isa == ISA_AVX2)
+  {
+    energyPass = energyPassAvx2;
+    gradientPass = gradientPassAvx2;
+  }
+#endif
+}
+
+void
+PairKernel::setApproximation(double expMaxError, double cutoff)
+{
+  params.cutoff = (cutoff > 0) ? cutoff : HUGE_VAL;
+  params.exp = yaatk::FastExp(expMaxError);
+  params.scalarFastExp = (expMaxError > 0);
+}
+
+void
+PairKernel::setPosition(size_t i, const yaatk::VectorXD& v)
+{
+  for(size_t d = 0; d < dim; ++d)
+    coords[d*stride + i] = v[d];
+}
+
+double
+PairKernel::evaluate(size_t i, double* grad, double* pairEnergy) const
+{
+  for(size_t d = 0; d < dim; ++d)
+    pos[d] = coords[d*stride + i];
+
+  double* e = pairEnergy ? pairEnergy : &energy[0];
+  double result =
+    energyPass(params,&coords[0],stride,dim,&pos[0],0,i,&factor[0],e) +
+    energyPass(params,&coords[0],stride,dim,&pos[0],i+1,n,&factor[0],e);
+  factor[i] = 0;
+  e[i] = 0;
+
+  PPhi phi(params.alpha0,params.alpha1,params.k,params.r0);
+  if (params.scalarFastExp)
+    phi.setExp(&params.exp);
+  phi.setCutoff(params.cutoff);
+  const std::vector<size_t>& adj = adjacent[i];
+  for(size_t a = 0; a < adj.size(); ++a)
+  {
+    size_t j = adj[a];
+    double R2 = 0;
+    for(size_t d = 0; d < dim; ++d)
+    {
+      double t = pos[d] - coords[d*stride + j];
+      R2 += t*t;
+    }
+    double R = std::sqrt(R2);
+    // the passes added the non-adjacent term, kept in e[j]
+    double adjacentEnergy = phi.value(R,1);
+    result += adjacentEnergy - e[j];
+    e[j] = adjacentEnergy;
+    factor[j] = phi.derivative(R,1)/R;
+  }
+
+  if (grad)
+    gradientPass(&coords[0],stride,dim,&pos[0],n,&factor[0],grad);
+
+  return result;
+}
+
+} //namespace grctk
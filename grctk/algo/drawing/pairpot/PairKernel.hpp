@@ -0,0 +1,104 @@
+/*
+  The PairKernel class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_PairKernel_hpp
+#define grctk_PairKernel_hpp
+
+#include <yaatk/VectorXD.hpp>
+#include <yaatk/FastExp.hpp>
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Energy and gradient of one vertex against all the others, computed
+  over a packed structure-of-arrays copy of the coordinates.
+
+  The main pass applies the non-adjacent term phi0 to every pair and
+  stores d(phi)/dR / R per pair; the (few) adjacent pairs are then
+  corrected to phi1 one by one, and a second pass folds the stored
+  factors into the gradient. Both passes run with AVX-512, AVX2 or
+  plain scalar code, whichever the processor supports. All the buffers
+  are allocated by setup().
+*/
+class PairKernel
+{
+public:
+  enum Isa {ISA_SCALAR, ISA_AVX2, ISA_AVX512};
+  // the best instruction set supported by the processor
+  static Isa detectIsa();
+  static const char* isaName(Isa isa);
+  struct Params
+  {
+    double alpha0;
+    double alpha1;
+    double k;
+    double r0;
+    // phi0 is zero from this distance on
+    double cutoff;
+    // the vector passes always use polynomial exp, the scalar ones
+    // only when an error bound is set
+    yaatk::FastExp exp;
+    bool scalarFastExp;
+  };
+  typedef double (*EnergyPass)(const Params& p,
+                               const double* coords, size_t stride,
+                               size_t dim, const double* pos,
+                               size_t begin, size_t end,
+                               double* factor, double* energy);
+  typedef void (*GradientPass)(const double* coords, size_t stride,
+                               size_t dim, const double* pos,
+                               size_t n, const double* factor,
+                               double* grad);
+private:
+  Params params;
+  Isa isa;
+  EnergyPass energyPass;
+  GradientPass gradientPass;
+  size_t n;
+  size_t dim;
+  size_t stride;
+  std::vector<double> coords;
+  std::vector<std::vector<size_t> > adjacent;
+  mutable std::vector<double> factor;
+  mutable std::vector<double> energy;
+  mutable std::vector<double> pos;
+public:
+  PairKernel();
+  // ISAs the processor lacks fall back to the best supported one
+  void setup(double alpha0, double alpha1, double k, double r0,
+             const std::vector<std::vector<size_t> >& adjacentLists,
+             size_t dim, Isa requested = detectIsa());
+  // exp with the given max relative error (0 = exact) and a cutoff of
+  // phi0 (0 = none); call after setup()
+  void setApproximation(double expMaxError, double cutoff);
+  Isa selectedIsa() const {return isa;}
+  void setPosition(size_t i, const yaatk::VectorXD& v);
+  // energy of vertex i; the gradient is stored to grad[0..dim) and the
+  // energies of the pairs (i,j) to pairEnergy[j], pairEnergy[i] = 0,
+  // unless the pointers are NULL
+  double evaluate(size_t i, double* grad, double* pairEnergy = NULL) const;
+};
+
+} //namespace grctk
+
+#endif
@@ -27,16 +27,202 @@
   along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+
 #include "PairPot.hpp"
+#include "grctk/algo/formats/BinCode.hpp"
+#include <yaatk/Hash.hpp>
+#include "zthread/PoolExecutor.h"
+#include "zthread/Runnable.h"
 #include <cstdlib>
+#include <cmath>
 #include <ctime>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace grctk
 {
 
+struct PairPotStartResult
+{
+  std::vector<yaatk::VectorXD> positions;
+  double energy;
+  std::vector<double> energyTrace;
+  bool aborted;
+  std::string error;
+  // set by the worker once the fields above are filled
+  std::atomic<bool> done;
+  bool skipped;
+  PairPotStartResult():
+    positions(),energy(0),energyTrace(),aborted(false),error(),
+    done(false),skipped(false) {}
+};
+
+/*
+  The early stopping criteria of PairPot::InputParams. The energies are
+  added in the order of the starts; add() returns true once the starts
+  added so far are enough.
+*/
+class PairPotStopCriteria
+{
+  const PairPot::InputParams& input;
+  size_t count;
+  double best;
+  size_t lastImprovement;
+  std::vector<double> minima;
+public:
+  std::string reason;
+  PairPotStopCriteria(const PairPot::InputParams& inp):
+    input(inp),count(0),best(0),lastImprovement(0),minima(),reason() {}
+  bool add(double energy)
+    {
+      if (count == 0 || energy < best - input.inp_EnergyTolerance)
+        lastImprovement = count;
+      if (count == 0 || energy < best)
+        best = energy;
+      ++count;
+      if (input.inp_StallStarts > 0 &&
+          count - 1 - lastImprovement >= input.inp_StallStarts)
+      {
+        std::ostringstream os;
+        os << "no improvement in " << input.inp_StallStarts << " starts";
+        reason = os.str();
+        return true;
+      }
+      bool known = false;
+      for(size_t i = 0; i < minima.size() && !known; ++i)
+        known = (std::fabs(minima[i] - energy) <= input.inp_EnergyTolerance);
+      if (!known)
+        minima.push_back(energy);
+      if (input.inp_DistinctMinima > 0 &&
+          minima.size() >= input.inp_DistinctMinima)
+      {
+        std::ostringstream os;
+        os << minima.size() << " distinct minima found";
+        reason = os.str();
+        return true;
+      }
+      return false;
+    }
+};
+
+/*
+  One start of the stochastic search. The graph crosses into the
+  worker thread as a BinCode and is decoded in a universe of the
+  worker's own; the positions come back as plain vectors.
+*/
+class PairPotStart : public ZThread::Runnable
+{
+  const BinCode& code;
+  const std::vector<yaatk::Vector3D>& initial;
+  const PairPotBase::InputParams& inputBase;
+  PairPotBase::TuneParams tune;
+  const size_t dim;
+  const bool useExisted;
+  const unsigned long seed;
+  const bool multilevel;
+  const size_t index;
+  // starts from limit on are not needed any more
+  const std::atomic<size_t>& limit;
+  std::atomic<bool>& stop;
+  PairPotStartResult& result;
+public:
+  PairPotStart(const BinCode& c,
+               const std::vector<yaatk::Vector3D>& initialPositions,
+               const PairPotBase::InputParams& inp,
+               const PairPotBase::TuneParams& tune_params,
+               size_t dimensions, bool useExistedPositions,
+               unsigned long startSeed, bool multilevelStart,
+               size_t startIndex, const std::atomic<size_t>& startLimit,
+               std::atomic<bool>& stopFlag, PairPotStartResult& res):
+    code(c),initial(initialPositions),inputBase(inp),tune(tune_params),
+    dim(dimensions),useExisted(useExistedPositions),seed(startSeed),
+    multilevel(multilevelStart),index(startIndex),limit(startLimit),
+    stop(stopFlag),result(res)
+    {
+    }
+  virtual void run()
+    {
+      if (stop.load())
+      {
+        result.aborted = true;
+        return;
+      }
+      if (index >= limit.load())
+      {
+        result.skipped = true;
+        return;
+      }
+      try
+      {
+        Universe universe;
+        UniverseScope scope(universe);
+        AdjMatrix g = code.decode();
+        Attribute<yaatk::Vector3D> a3D;
+        if (useExisted)
+          for(size_t i = 0; i < g.size(); ++i)
+            a3D[g[i]] = initial[i];
+        PairPotBase::InputParams input(
+          a3D,
+          inputBase.inp_LInit,
+          inputBase.inp_Eps,
+          useExisted,
+          inputBase.inp_Approximate,
+          inputBase.inp_ErrorBound,
+          seed,
+          inputBase.inp_Optimizer,
+          inputBase.inp_ExpMaxError,
+          inputBase.inp_Cutoff,
+          inputBase.inp_Spectral);
+        GraphRep rep(g, dim);
+        if (multilevel)
+        {
+          Multilevel alg(tune);
+          alg(input,Multilevel::InputParams(),rep);
+        }
+        else
+        {
+          PairPotBase alg(tune);
+          alg(input,rep);
+        }
+        result.positions.resize(g.size());
+        for(size_t i = 0; i < g.size(); ++i)
+          result.positions[i] = rep.aXD[rep.g[i]];
+        result.energy = rep.energy;
+        result.energyTrace = rep.energyTrace;
+        result.done.store(true);
+      }
+      catch(AbortAlgException&)
+      {
+        // interrupted by early stopping
+        if (index >= limit.load())
+        {
+          result.skipped = true;
+          return;
+        }
+        result.aborted = true;
+        stop.store(true);
+      }
+      catch(std::exception& e)
+      {
+        result.error = e.what();
+        stop.store(true);
+      }
+      catch(...)
+      {
+        result.error = "Unknown exception";
+        stop.store(true);
+      }
+    }
+};
+
 PairPot::PairPot(const PairPotBase::TuneParams &tune_params, Log& setlog):
   AlgBase(setlog),
-  tune(tune_params)
+  tune(tune_params),
+  skippedStarts(0)
 {
 }
 
@@ -47,29 +233,135 @@ PairPot::operator()(const PairPotBase::InputParams &inputBase,
   logStream() << "\nPairPot started\n";
   flushLogStreams();
 
-  time_t t;
-  srand((unsigned)time(&t));
+  unsigned long masterSeed = input.inp_Seed;
+  if (masterSeed == 0)
+  {
+    time_t t;
+    masterSeed = (unsigned long)time(&t);
+  }
+  size_t threads = input.inp_Threads;
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads == 0)
+    threads = 1;
+  if (input.inp_MaxIterations > 0 && threads > size_t(input.inp_MaxIterations))
+    threads = input.inp_MaxIterations;
+
+  logStream() << "Building " << input.inp_MaxIterations
+              << (input.inp_Multilevel ? " multilevel" : "")
+              << " representations on " << threads << " thread(s), seed = "
+              << masterSeed << "\n";
+  flushLogStreams();
 
-  for(long i = 0; i < input.inp_MaxIterations; i++)
+  const AdjMatrix& g = graphMultiRep.g;
+  BinCode code(g.size());
+  code.encode(g);
+  std::vector<yaatk::Vector3D> initial;
+  if (inputBase.inp_UseExisted)
+    for(size_t i = 0; i < g.size(); ++i)
+      initial.push_back(inputBase.a3D[g[i]]);
+
+  std::vector<PairPotStartResult> results(
+    (input.inp_MaxIterations > 0) ? input.inp_MaxIterations : 0);
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> limit(results.size());
+  std::chrono::steady_clock::time_point started =
+    std::chrono::steady_clock::now();
+  bool budgetExhausted = false;
   {
-    checkAborted();
+    ZThread::PoolExecutor pool(threads);
+    for(size_t i = 0; i < results.size(); i++)
+    {
+      unsigned long seed =
+        (unsigned long)(yaatk::hashCombine(masterSeed,i) & 0xffffffffUL);
+      pool.execute(ZThread::Task(new PairPotStart(
+                                   code,initial,inputBase,tune,
+                                   graphMultiRep.dim,
+                                   inputBase.inp_UseExisted && i == 0,
+                                   (seed != 0) ? seed : 1,
+                                   input.inp_Multilevel,
+                                   i,limit,stop,results[i])));
+    }
+    PairPotStopCriteria criteria(input);
+    size_t judged = 0;
+    bool cut = false;
+    try
+    {
+      // an interrupt of this thread makes wait() throw
+      while (!pool.wait(100))
+      {
+        checkAborted();
+        while (judged < limit.load() && results[judged].done.load())
+          if (criteria.add(results[judged++].energy))
+            limit.store(judged);
+        if (input.inp_TimeBudget > 0 &&
+            std::chrono::duration<double>(
+              std::chrono::steady_clock::now() - started).count()
+            >= input.inp_TimeBudget)
+        {
+          budgetExhausted = true;
+          limit.store(0);
+        }
+        if (!cut && limit.load() < results.size())
+        {
+          cut = true;
+          pool.interrupt();
+        }
+      }
+    }
+    catch(...)
+    {
+      // the tasks refer to the results and the flags
+      stop.store(true);
+      pool.interrupt();
+      pool.wait();
+      throw AbortAlgException("Exiting via the flag...");
+    }
+  }
+
+  for(size_t i = 0; i < results.size(); i++)
+    if (results[i].error != "")
+      throw std::runtime_error("PairPot: " + results[i].error);
+  for(size_t i = 0; i < results.size(); i++)
+    if (results[i].aborted)
+      throw AbortAlgException("Exiting via the flag...");
 
-    logStream() << "Building representation number " << i+1 << "...\n";
+  // the starts that finished between two checks above may have been
+  // enough already, so the criteria are applied once more over all of
+  // them in order
+  std::vector<size_t> kept;
+  PairPotStopCriteria criteria(input);
+  bool criteriaMet = false;
+  for(size_t i = 0; i < results.size() && !criteriaMet; i++)
+    if (results[i].done.load())
+    {
+      kept.push_back(i);
+      criteriaMet = criteria.add(results[i].energy);
+    }
+  skippedStarts = results.size() - kept.size();
+  if (skippedStarts > 0)
+  {
+    logStream() << "Skipped " << skippedStarts << " of " << results.size()
+                << " starts: "
+                << (criteriaMet ? criteria.reason : std::string(
+                      budgetExhausted ? "time budget exhausted" : ""))
+                << "\n";
     flushLogStreams();
+  }
 
-    bool useExisted = inputBase.inp_UseExisted;
-    if (i > 0)
-      useExisted = false;
-    PairPotBase::InputParams inputBaseMod(
-      inputBase.a3D,
-      inputBase.inp_LInit,
-      inputBase.inp_Eps,
-      useExisted);
-    GraphRep rep(graphMultiRep.g, graphMultiRep.dim);
-
-    PairPotBase alg(tune);
-    alg(inputBaseMod,rep);
+  for(size_t k = 0; k < kept.size(); k++)
+  {
+    const PairPotStartResult& result = results[kept[k]];
+    GraphRep rep(g, graphMultiRep.dim);
+    for(size_t v = 0; v < g.size(); ++v)
+      rep.aXD[rep.g[v]] = result.positions[v];
+    rep.energy = result.energy;
+    rep.energyTrace = result.energyTrace;
     graphMultiRep.addRep(rep);
+
+    logStream() << "Representation number " << k+1
+                << ", energy = " << rep.energy << "\n";
+    flushLogStreams();
   }
 
   {
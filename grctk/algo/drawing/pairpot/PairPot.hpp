@@ -32,6 +32,7 @@
 #define grctk_PairPot_hpp
 
 #include "PairPotBase.hpp"
+#include "Multilevel.hpp"
 #include "grctk/algo/drawing/GraphMultiRep.hpp"
 #include <yaatk/VectorXD.hpp>
 #include <sstream>
@@ -51,14 +52,49 @@ public:
   {
     long inp_MaxIterations;
     bool inp_SaveEvery;
+    // every start gets its own generator seeded from inp_Seed and the
+    // start number, so the result does not depend on inp_Threads;
+    // 0 takes the seed from the clock
+    unsigned long inp_Seed;
+    // 0 runs one thread per processor
+    size_t inp_Threads;
+    // every start is a Multilevel layout instead of a PairPotBase one
+    bool inp_Multilevel;
+    // early stopping, judged on the starts in their order so that the
+    // result does not depend on inp_Threads: after inp_StallStarts
+    // starts in a row that did not lower the best energy by more than
+    // inp_EnergyTolerance, or once inp_DistinctMinima energies farther
+    // than inp_EnergyTolerance apart are found; 0 disables either
+    size_t inp_StallStarts;
+    size_t inp_DistinctMinima;
+    double inp_EnergyTolerance;
+    // wall-clock budget in seconds, 0 = none; the starts finished by
+    // then are kept, the rest are skipped
+    double inp_TimeBudget;
     InputParams(
       long inp_MaxIterations_def = 1,
-      bool inp_SaveEvery_def = false):
+      bool inp_SaveEvery_def = false,
+      unsigned long inp_Seed_def = 0,
+      size_t inp_Threads_def = 1,
+      bool inp_Multilevel_def = false,
+      size_t inp_StallStarts_def = 0,
+      size_t inp_DistinctMinima_def = 0,
+      double inp_EnergyTolerance_def = 1.0e-6,
+      double inp_TimeBudget_def = 0.0):
       inp_MaxIterations(inp_MaxIterations_def),
-      inp_SaveEvery(inp_SaveEvery_def)
+      inp_SaveEvery(inp_SaveEvery_def),
+      inp_Seed(inp_Seed_def),
+      inp_Threads(inp_Threads_def),
+      inp_Multilevel(inp_Multilevel_def),
+      inp_StallStarts(inp_StallStarts_def),
+      inp_DistinctMinima(inp_DistinctMinima_def),
+      inp_EnergyTolerance(inp_EnergyTolerance_def),
+      inp_TimeBudget(inp_TimeBudget_def)
       {
       }
   };
+  // the number of starts of the last run cut off by early stopping
+  size_t skippedStarts;
   void operator()(const PairPotBase::InputParams &inputBase,
                   const InputParams &input, GraphMultiRep &graphMultiRep);
   PairPot(const PairPotBase::TuneParams &tune_params, Log& setlog = nullLog);
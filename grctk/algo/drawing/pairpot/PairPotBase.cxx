@@ -29,8 +29,11 @@
 
 #include "PairPotBase.hpp"
 #include "grctk/algo/drawing/transform/MovePositions.hpp"
+#include "grctk/algo/drawing/spectral/SpectralPositions.hpp"
+#include <gsl/gsl_rng.h>
 #include <cstdlib>
 #include <ctime>
+#include <cmath>
 
 namespace grctk
 {
@@ -44,34 +47,240 @@ PairPotBase::Normalize(GraphRep &rep)
     yaatk::normalize(rep.aXD[rep.g[i]]);
 }
 
+/*
+  The eigenvectors are scaled to the mean edge length r0 and scattered
+  by a thousandth of it, since vertices with equal neighbourhoods (the
+  leaves of a star) get equal coordinates.
+*/
+void
+PairPotBase::spectralPositions(const InputParams &input, GraphRep &rep)
+{
+  size_t n = rep.g.size();
+  SpectralPositions::AdjacencyLists adjacentLists(n);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      if (i != j && rep.g.s(i,j))
+        adjacentLists[i].push_back(j);
+
+  unsigned long seed = input.inp_Seed;
+  if (seed == 0)
+    seed = (unsigned long)(rand()) + 1;
+  std::vector<VectorXD> positions;
+  SpectralPositions spectral(log);
+  spectral(adjacentLists,rep.dim,
+           SpectralPositions::InputParams(0,100,1.0e-5,seed),positions);
+
+  double sum = 0;
+  size_t count = 0;
+  for(size_t i = 0; i < n; ++i)
+    for(size_t a = 0; a < adjacentLists[i].size(); ++a)
+    {
+      sum += yaatk::module(VectorXD(positions[i] -
+                                    positions[adjacentLists[i][a]]));
+      ++count;
+    }
+  double scale = (sum > 0) ? tune.r0*count/sum : 1.0;
+
+  gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+  REQUIRE(rng != NULL);
+  gsl_rng_set(rng, seed);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t d = 0; d < rep.dim; ++d)
+      rep.aXD[rep.g[i]][d] = scale*positions[i][d] +
+        1e-3*tune.r0*(2.0*gsl_rng_uniform(rng) - 1.0);
+  gsl_rng_free(rng);
+}
+
+static
 double
-PairPotBase::Phi(size_t i, GraphRep &rep)
+distanceXD(const VectorXD& v1, const VectorXD& v2)
 {
-  double result = 0;
-  for(size_t j = 0; j < rep.g.size(); ++j)
-    if (j != i)
-      result += phi(rep.aXD[rep.g[j]],rep.aXD[rep.g[i]],rep.g(j,i));
-  return result;
+  double sum = 0;
+  for(size_t d = 0; d < v1.size(); ++d)
+    sum += yaatk::SQR(v1[d]-v2[d]);
+  return std::sqrt(sum);
+}
+
+void
+PairPotBase::prepareKernel(const InputParams &input, GraphRep &rep)
+{
+  if (input.inp_ExpMaxError > 0)
+  {
+    fastExp = yaatk::FastExp(input.inp_ExpMaxError);
+    phi.setExp(&fastExp);
+  }
+  else
+    phi.setExp(NULL);
+  phi.setCutoff(input.inp_Cutoff);
+
+  size_t n = rep.g.size();
+  adjacent.assign(n,std::vector<size_t>());
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      if (j != i && rep.g.s(i,j))
+        adjacent[i].push_back(j);
+
+  kernel.setup(tune.alpha0,tune.alpha1,tune.k,tune.r0,adjacent,rep.dim);
+  kernel.setApproximation(input.inp_ExpMaxError,input.inp_Cutoff);
+  oldPairs.assign(n,0.0);
+  newPairs.assign(n,0.0);
+  for(size_t i = 0; i < n; ++i)
+    kernel.setPosition(i,rep.aXD[rep.g[i]]);
+
+  logStream() << "Pair kernel: "
+              << PairKernel::isaName(kernel.selectedIsa()) << "\n";
+  if (input.inp_ExpMaxError > 0)
+    logStream() << "Approximate exp, polynomial degree "
+                << fastExp.degree() << "\n";
+  flushLogStreams();
+}
+
+void
+PairPotBase::prepareApproximation(const InputParams &input, GraphRep &rep)
+{
+  approximate = input.inp_Approximate;
+  if (!approximate)
+    return;
+
+  REQUIRE(input.inp_ErrorBound > 0 && input.inp_ErrorBound < 1);
+  cutoff = phi.phi0Cutoff(input.inp_ErrorBound);
+  if (input.inp_Cutoff > 0 && input.inp_Cutoff < cutoff)
+    cutoff = input.inp_Cutoff;
+
+  size_t n = rep.g.size();
+  std::vector<const VectorXD*> positions(n);
+  for(size_t i = 0; i < n; ++i)
+    positions[i] = &rep.aXD[rep.g[i]];
+  grid.build(positions,cutoff);
+
+  logStream() << "Approximate mode, cutoff = " << cutoff << "\n";
+  flushLogStreams();
 }
 
 double
-PairPotBase::fullEnergy(GraphRep &rep)
+PairPotBase::PhiApprox(size_t i, GraphRep &rep, PairTerms* terms)
 {
+  const VectorXD& pi = rep.aXD[rep.g[i]];
   double result = 0;
-  for(size_t i = 0; i < rep.g.size(); ++i)
-    result += Phi(i,rep);
+  if (terms)
+    terms->clear();
+  for(size_t k = 0; k < adjacent[i].size(); ++k)
+  {
+    size_t j = adjacent[i][k];
+    double e = phi.value(distanceXD(rep.aXD[rep.g[j]],pi),1);
+    result += e;
+    if (terms)
+      terms->push_back(std::make_pair(j,e));
+  }
+
+  nearby.clear();
+  grid.candidates(pi,nearby);
+  for(size_t k = 0; k < nearby.size(); ++k)
+  {
+    size_t j = nearby[k];
+    if (j == i || rep.g.s(i,j))
+      continue;
+    double R = distanceXD(rep.aXD[rep.g[j]],pi);
+    if (R < cutoff)
+    {
+      double e = phi.value(R,0);
+      result += e;
+      if (terms)
+        terms->push_back(std::make_pair(j,e));
+    }
+  }
   return result;
 }
 
-VectorXD
-PairPotBase::Fi(size_t i, GraphRep &rep)
+void
+PairPotBase::FiApprox(size_t i, GraphRep &rep, VectorXD& tmp)
 {
-  VectorXD tmp(rep.dim);
-  size_t sz = rep.g.size();
-  for (size_t j = 0; j < sz; ++j)
-    if (j != i)
-      tmp += phi.grad(rep.aXD[rep.g[i]],rep.aXD[rep.g[j]],rep.g(j,i));
-  return tmp;
+  const VectorXD& pi = rep.aXD[rep.g[i]];
+  tmp = 0.0;
+  for(size_t k = 0; k < adjacent[i].size(); ++k)
+  {
+    const VectorXD& pj = rep.aXD[rep.g[adjacent[i][k]]];
+    double R = distanceXD(pi,pj);
+    double Der = phi.derivative(R,1)/R;
+    for(size_t d = 0; d < rep.dim; ++d)
+      tmp[d] += (pi[d]-pj[d])*Der;
+  }
+
+  nearby.clear();
+  grid.candidates(pi,nearby);
+  for(size_t k = 0; k < nearby.size(); ++k)
+  {
+    size_t j = nearby[k];
+    if (j == i || rep.g.s(i,j))
+      continue;
+    const VectorXD& pj = rep.aXD[rep.g[j]];
+    double R = distanceXD(pi,pj);
+    if (R >= cutoff)
+      continue;
+    double Der = phi.derivative(R,0)/R;
+    for(size_t d = 0; d < rep.dim; ++d)
+      tmp[d] += (pi[d]-pj[d])*Der;
+  }
+}
+
+double
+PairPotBase::Phi(size_t i, GraphRep &rep)
+{
+  if (approximate)
+    return PhiApprox(i,rep);
+  return kernel.evaluate(i,NULL);
+}
+
+double
+PairPotBase::PhiFi(size_t i, GraphRep &rep, VectorXD& grad)
+{
+  if (approximate)
+  {
+    FiApprox(i,rep,grad);
+    return PhiApprox(i,rep,&oldTerms);
+  }
+  return kernel.evaluate(i,&grad[0],&oldPairs[0]);
+}
+
+double
+PairPotBase::PhiMoved(size_t i, GraphRep &rep)
+{
+  if (approximate)
+    return PhiApprox(i,rep,&newTerms);
+  return kernel.evaluate(i,NULL,&newPairs[0]);
+}
+
+void
+PairPotBase::initEnergies(GraphRep &rep)
+{
+  size_t n = rep.g.size();
+  partial.resize(n);
+  total = 0;
+  for(size_t i = 0; i < n; ++i)
+  {
+    partial[i] = Phi(i,rep);
+    total += partial[i];
+  }
+}
+
+void
+PairPotBase::moveAccepted(size_t i, double PhiOld, double PhiNew)
+{
+  if (approximate)
+  {
+    for(size_t k = 0; k < oldTerms.size(); ++k)
+      partial[oldTerms[k].first] -= oldTerms[k].second;
+    for(size_t k = 0; k < newTerms.size(); ++k)
+      partial[newTerms[k].first] += newTerms[k].second;
+  }
+  else
+  {
+    for(size_t j = 0; j < partial.size(); ++j)
+      partial[j] += newPairs[j] - oldPairs[j];
+  }
+  partial[i] = PhiNew;
+  // every pair is counted in both of its partial energies
+  total += 2*(PhiNew - PhiOld);
 }
 
 void
@@ -81,6 +290,10 @@ PairPotBase::buildCurrent(const InputParams &input, GraphRep &rep)
 
   VectorXD oldPos(rep.dim), FiVec(rep.dim);
 
+  initEnergies(rep);
+  rep.energyTrace.clear();
+  rep.energyTrace.push_back(total);
+
   while (1)
   {
     bool moreOptimal = false;
@@ -88,8 +301,7 @@ PairPotBase::buildCurrent(const InputParams &input, GraphRep &rep)
     {
       checkAborted();
 
-      double PhiOld = Phi(i,rep);
-      FiVec = Fi(i,rep);
+      double PhiOld = PhiFi(i,rep,FiVec);
       oldPos = rep.aXD[rep.g[i]];
 
       if (yaatk::module(FiVec) == 0)
@@ -100,13 +312,23 @@ PairPotBase::buildCurrent(const InputParams &input, GraphRep &rep)
       }
 
       rep.aXD[rep.g[i]] = oldPos - L*FiVec/yaatk::module(FiVec);
-      double PhiNew = Phi(i,rep);
+      kernel.setPosition(i,rep.aXD[rep.g[i]]);
+      double PhiNew = PhiMoved(i,rep);
 
       if (PhiNew >= PhiOld)
+      {
         rep.aXD[rep.g[i]] = oldPos;
+        kernel.setPosition(i,oldPos);
+      }
       else
+      {
         moreOptimal = true;
+        moveAccepted(i,PhiOld,PhiNew);
+        if (approximate)
+          grid.move(i,rep.aXD[rep.g[i]]);
+      }
     }
+    rep.energyTrace.push_back(total);
     if (!moreOptimal)
     {
       if (L < input.inp_Eps)
@@ -116,12 +338,216 @@ PairPotBase::buildCurrent(const InputParams &input, GraphRep &rep)
     }
   }
 
-  rep.energy = fullEnergy(rep);
+  rep.energy = total;
+
+  logStream() << "Sweeps: " << rep.energyTrace.size()-1
+              << ", energy " << rep.energyTrace.front()
+              << " -> " << rep.energy << "\n";
+  flushLogStreams();
+}
+
+void
+PairPotBase::setPositions(GraphRep &rep, const std::vector<double>& x)
+{
+  for(size_t i = 0; i < rep.g.size(); ++i)
+  {
+    VectorXD& p = rep.aXD[rep.g[i]];
+    for(size_t d = 0; d < rep.dim; ++d)
+      p[d] = x[i*rep.dim + d];
+    kernel.setPosition(i,p);
+    if (approximate)
+      grid.move(i,p);
+  }
+}
+
+double
+PairPotBase::energyAndGradient(GraphRep &rep, std::vector<double>& gradient)
+{
+  VectorXD FiVec(rep.dim);
+  double result = 0;
+  for(size_t i = 0; i < rep.g.size(); ++i)
+  {
+    result += PhiFi(i,rep,FiVec);
+    // the energy counts every pair twice, so does its gradient
+    for(size_t d = 0; d < rep.dim; ++d)
+      gradient[i*rep.dim + d] = 2*FiVec[d];
+  }
+  return result;
+}
+
+// the largest displacement of a vertex along the direction v
+static
+double
+maxVertexShift(const std::vector<double>& v, size_t dim)
+{
+  double result = 0;
+  for(size_t i = 0; i < v.size(); i += dim)
+  {
+    double sum = 0;
+    for(size_t d = 0; d < dim; ++d)
+      sum += yaatk::SQR(v[i + d]);
+    if (sum > result)
+      result = sum;
+  }
+  return std::sqrt(result);
+}
+
+static
+double
+dotProduct(const std::vector<double>& a, const std::vector<double>& b)
+{
+  double result = 0;
+  for(size_t k = 0; k < a.size(); ++k)
+    result += a[k]*b[k];
+  return result;
+}
+
+/*
+  L-BFGS with a backtracking (Armijo) line search. No vertex moves
+  farther than inp_LInit in one iteration; the search stops when the
+  largest accepted vertex displacement drops below inp_Eps.
+*/
+void
+PairPotBase::buildCurrentLBFGS(const InputParams &input, GraphRep &rep)
+{
+  const size_t dim = rep.dim;
+  const size_t N = rep.g.size()*dim;
+  const size_t m = 8;
+
+  std::vector<double> x(N), grad(N), xNew(N), gradNew(N), dir(N);
+  std::vector<std::vector<double> > s(m,std::vector<double>(N));
+  std::vector<std::vector<double> > y(m,std::vector<double>(N));
+  std::vector<double> rho(m), a(m);
+  size_t stored = 0, newest = 0;
+
+  for(size_t i = 0; i < rep.g.size(); ++i)
+    for(size_t d = 0; d < dim; ++d)
+      x[i*dim + d] = rep.aXD[rep.g[i]][d];
+  double f = energyAndGradient(rep,grad);
+  rep.energyTrace.clear();
+  rep.energyTrace.push_back(f);
+
+  while (1)
+  {
+    checkAborted();
+
+    // two-loop recursion: dir = -H*grad
+    dir = grad;
+    for(size_t c = 0; c < stored; ++c)
+    {
+      size_t k = (newest + m - c) % m;
+      a[k] = rho[k]*dotProduct(s[k],dir);
+      for(size_t l = 0; l < N; ++l)
+        dir[l] -= a[k]*y[k][l];
+    }
+    if (stored > 0)
+    {
+      double gamma = dotProduct(s[newest],y[newest])/
+        dotProduct(y[newest],y[newest]);
+      for(size_t l = 0; l < N; ++l)
+        dir[l] *= gamma;
+    }
+    for(size_t c = stored; c > 0; --c)
+    {
+      size_t k = (newest + m - c + 1) % m;
+      double b = rho[k]*dotProduct(y[k],dir);
+      for(size_t l = 0; l < N; ++l)
+        dir[l] += s[k][l]*(a[k] - b);
+    }
+    for(size_t l = 0; l < N; ++l)
+      dir[l] = -dir[l];
+
+    double slope = dotProduct(grad,dir);
+    if (!(slope < 0))
+    {
+      stored = 0;
+      for(size_t l = 0; l < N; ++l)
+        dir[l] = -grad[l];
+      slope = -dotProduct(grad,grad);
+    }
+    double shift = maxVertexShift(dir,dim);
+    if (shift == 0)
+      break;
+
+    double t = (stored == 0) ? input.inp_LInit/shift : 1.0;
+    if (t*shift > input.inp_LInit)
+      t = input.inp_LInit/shift;
+
+    double fNew;
+    bool accepted = false;
+    while (1)
+    {
+      for(size_t l = 0; l < N; ++l)
+        xNew[l] = x[l] + t*dir[l];
+      setPositions(rep,xNew);
+      fNew = energyAndGradient(rep,gradNew);
+      if (fNew <= f + 1e-4*t*slope)
+      {
+        accepted = true;
+        break;
+      }
+      if (t*shift < input.inp_Eps)
+        break;
+      t /= 2;
+    }
+    if (!accepted)
+    {
+      setPositions(rep,x);
+      break;
+    }
+
+    size_t next = (stored == 0) ? newest : (newest + 1) % m;
+    for(size_t l = 0; l < N; ++l)
+    {
+      s[next][l] = xNew[l] - x[l];
+      y[next][l] = gradNew[l] - grad[l];
+    }
+    double sy = dotProduct(s[next],y[next]);
+    if (sy > 1e-12*std::sqrt(dotProduct(s[next],s[next])*
+                             dotProduct(y[next],y[next])))
+    {
+      rho[next] = 1.0/sy;
+      newest = next;
+      if (stored < m)
+        stored++;
+    }
+    else if (stored == m)
+      // the pair overwrote the oldest one
+      stored--;
+
+    x.swap(xNew);
+    grad.swap(gradNew);
+    f = fNew;
+    rep.energyTrace.push_back(f);
+
+    if (t*shift < input.inp_Eps)
+      break;
+  }
+
+  rep.energy = f;
+
+  logStream() << "L-BFGS iterations: " << rep.energyTrace.size()-1
+              << ", energy " << rep.energyTrace.front()
+              << " -> " << rep.energy << "\n";
+  flushLogStreams();
 }
 
 PairPotBase::PairPotBase(TuneParams &tune_params, Log& setlog)
   :AlgBase(setlog),
-   tune(tune_params)
+   tune(tune_params),
+   adjacent(),
+   kernel(),
+   fastExp(),
+   approximate(false),
+   cutoff(0),
+   grid(),
+   nearby(),
+   partial(),
+   total(0),
+   oldPairs(),
+   newPairs(),
+   oldTerms(),
+   newTerms()
 {
   phi = PPhi(tune.alpha0, tune.alpha1, tune.k, tune.r0);
 }
@@ -146,6 +572,20 @@ PairPotBase::operator()(const InputParams &input, GraphRep &rep)
         rep.aXD[rep.g[i]][j] = input.a3D[rep.g[i]].X(j);
     }
   }
+  else if (input.inp_Spectral)
+    spectralPositions(input,rep);
+  else if (input.inp_Seed != 0)
+  {
+    gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+    REQUIRE(rng != NULL);
+    gsl_rng_set(rng, input.inp_Seed);
+    for(size_t j = 0; j < rep.g.size(); j++)
+    {
+      for(size_t coord = 0; coord < rep.dim; coord++)
+        rep.aXD[rep.g[j]][coord] = gsl_rng_uniform(rng);
+    }
+    gsl_rng_free(rng);
+  }
   else
   {
     for(size_t j = 0; j < rep.g.size(); j++)
@@ -155,15 +595,28 @@ PairPotBase::operator()(const InputParams &input, GraphRep &rep)
     }
   }
 
-  Normalize(rep);
+  if (input.inp_UseExisted || !input.inp_Spectral)
+    Normalize(rep);
 
-  buildCurrent(input,rep);
-
-  MovePositions move;
-  move.moveMassCenterToOrigin(rep.g,rep.aXD);
+  refine(input,rep);
 
   logStream() << "PairPotBase finished\n" ;
   flushLogStreams();
 }
 
+void
+PairPotBase::refine(const InputParams &input, GraphRep &rep)
+{
+  prepareKernel(input,rep);
+  prepareApproximation(input,rep);
+
+  if (input.inp_Optimizer == LBFGS)
+    buildCurrentLBFGS(input,rep);
+  else
+    buildCurrent(input,rep);
+
+  MovePositions move;
+  move.moveMassCenterToOrigin(rep.g,rep.aXD);
+}
+
 }
@@ -32,6 +32,8 @@
 #define grctk_PairPotBase_hpp
 
 #include "Potentials.hpp"
+#include "NeighbourGrid.hpp"
+#include "PairKernel.hpp"
 
 #include "grctk/algo/AlgBase.hpp"
 #include "grctk/AdjMatrix.hpp"
@@ -41,6 +43,8 @@
 #include <yaatk/VectorXD.hpp>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <utility>
 
 namespace grctk
 {
@@ -48,6 +52,9 @@ namespace grctk
 class PairPotBase : public AlgBase
 {
 public:
+  // coordinate-wise descent with a global step halved down to inp_Eps,
+  // or L-BFGS over all the coordinates at once
+  enum Optimizer {COORDINATE_DESCENT, LBFGS};
   struct TuneParams
   {
     const double alpha0;
@@ -69,15 +76,44 @@ public:
     const double inp_Eps;
     const bool inp_UseExisted;
     const Attribute<yaatk::Vector3D>& a3D;
+    // non-adjacent pairs farther than the cutoff are ignored, each of
+    // them contributing less than k*inp_ErrorBound to the energy
+    const bool inp_Approximate;
+    const double inp_ErrorBound;
+    // seed of the initial positions, 0 uses rand()
+    const unsigned long inp_Seed;
+    const Optimizer inp_Optimizer;
+    // exp with this max relative error instead of the exact one (0),
+    // and the distance beyond which non-adjacent pairs do not interact
+    // (0 = none)
+    const double inp_ExpMaxError;
+    const double inp_Cutoff;
+    // initial positions from the Laplacian eigenvectors instead of
+    // random ones (unless inp_UseExisted)
+    const bool inp_Spectral;
     InputParams(
       const Attribute<yaatk::Vector3D>& a3D_def,
       const double inp_LInit_def = 0.0L,
       const double inp_Eps_def = 0.0001,
-      const bool inp_UseExisted_def = false) :
+      const bool inp_UseExisted_def = false,
+      const bool inp_Approximate_def = false,
+      const double inp_ErrorBound_def = 1.0e-6,
+      const unsigned long inp_Seed_def = 0,
+      const Optimizer inp_Optimizer_def = COORDINATE_DESCENT,
+      const double inp_ExpMaxError_def = 0,
+      const double inp_Cutoff_def = 0,
+      const bool inp_Spectral_def = false) :
       inp_LInit((inp_LInit_def>0)?inp_LInit_def:(10.0L*rand()/double(RAND_MAX))),
       inp_Eps(inp_Eps_def),
       inp_UseExisted(inp_UseExisted_def),
-      a3D(a3D_def)
+      a3D(a3D_def),
+      inp_Approximate(inp_Approximate_def),
+      inp_ErrorBound(inp_ErrorBound_def),
+      inp_Seed(inp_Seed_def),
+      inp_Optimizer(inp_Optimizer_def),
+      inp_ExpMaxError(inp_ExpMaxError_def),
+      inp_Cutoff(inp_Cutoff_def),
+      inp_Spectral(inp_Spectral_def)
       {
       }
   };
@@ -86,13 +122,48 @@ protected:
   TuneParams tune;
   double L;
   void Normalize(GraphRep&);
+  void spectralPositions(const InputParams &input, GraphRep &rep);
+protected:
+  std::vector<std::vector<size_t> > adjacent;
+  PairKernel kernel;
+  yaatk::FastExp fastExp;
+  void prepareKernel(const InputParams &input, GraphRep &rep);
+protected:
+  // approximate mode: exact terms for edges, grid with cutoff for the rest
+  bool approximate;
+  double cutoff;
+  NeighbourGrid grid;
+  std::vector<size_t> nearby;
+  typedef std::vector<std::pair<size_t,double> > PairTerms;
+  void prepareApproximation(const InputParams &input, GraphRep &rep);
+  double PhiApprox(size_t i, GraphRep&, PairTerms* terms = NULL);
+  void FiApprox(size_t i, GraphRep&, yaatk::VectorXD& grad);
+protected:
+  // partial[i] == Phi(i) and total == their sum, kept up to date by
+  // the pair energies of the moved vertex before and after the move
+  std::vector<double> partial;
+  double total;
+  std::vector<double> oldPairs, newPairs;
+  PairTerms oldTerms, newTerms;
+  void initEnergies(GraphRep&);
+  void moveAccepted(size_t i, double PhiOld, double PhiNew);
+protected:
+  // L-BFGS: positions as one vector of n*dim coordinates
+  void setPositions(GraphRep&, const std::vector<double>& x);
+  double energyAndGradient(GraphRep&, std::vector<double>& gradient);
+  void buildCurrentLBFGS(const InputParams &input, GraphRep &rep);
 protected:
   void buildCurrent(const InputParams &input, GraphRep &rep);
   double Phi(size_t i, GraphRep&);
-  yaatk::VectorXD Fi(size_t i, GraphRep&);
-  double fullEnergy(GraphRep&);
+  // energy of vertex i and its gradient, stored to grad, before a move
+  double PhiFi(size_t i, GraphRep&, yaatk::VectorXD& grad);
+  // energy of vertex i after a trial move
+  double PhiMoved(size_t i, GraphRep&);
 public:
   void operator()(const InputParams &input, GraphRep &graphRep);
+  // optimizes the positions already stored in rep.aXD (inp_UseExisted
+  // and inp_Seed are ignored), starting with the step inp_LInit
+  void refine(const InputParams &input, GraphRep &rep);
   PairPotBase(TuneParams &tune_params, Log& setlog = nullLog);
 private:
   PairPotBase(const PairPotBase &);
@@ -32,8 +32,10 @@
 #define grctk_Potentials_hpp
 
 #include <yaatk/VectorXD.hpp>
+#include <yaatk/FastExp.hpp>
 #include <sstream>
 #include <string>
+#include <cmath>
 
 namespace grctk
 {
@@ -44,26 +46,63 @@ class PPhi
   double alpha1;
   double k;
   double r0;
+  // optional approximations: exp with a bounded relative error, and
+  // the distance beyond which phi0 is taken as zero
+  const yaatk::FastExp* fastExp;
+  double cutoff;
+  double ex(double x) const
+    {
+      return fastExp ? (*fastExp)(x) : exp(x);
+    }
   // interaction in case of vertex adjacency
   double phi0(double r) const
     {
-      return (k*exp(alpha0*(r0-r)));
+      if (r >= cutoff)
+        return 0;
+      return (k*ex(alpha0*(r0-r)));
     }
   double phi0der(double r) const
     {
-      return (-alpha0*k*exp(alpha0*(r0-r)));
+      if (r >= cutoff)
+        return 0;
+      return (-alpha0*k*ex(alpha0*(r0-r)));
     }
   // interaction in case of no vertex adjacency
   double phi1(double r) const
     {
-      return (exp(2.0*alpha1*(r0-r))-2.0*exp(alpha1*(r0-r)));
+      double tmp = ex(alpha1*(r0-r));
+      return (tmp*tmp-2.0*tmp);
     }
   double phi1der(double r) const
     {
-      double tmp = exp(alpha1*(r0-r));
+      double tmp = ex(alpha1*(r0-r));
       return (-2.0*alpha1*tmp*(tmp-1.0));
     }
 public:
+  // NULL restores the exact exp; fe must outlive the object
+  void setExp(const yaatk::FastExp* fe)
+    {
+      fastExp = fe;
+    }
+  // 0 disables the cutoff
+  void setCutoff(double c)
+    {
+      cutoff = (c > 0) ? c : HUGE_VAL;
+    }
+  // the same as below, for a known distance R
+  double value(double R, const int s) const
+    {
+      return (1-s)*phi0(R) + s*phi1(R);
+    }
+  double derivative(double R, const int s) const
+    {
+      return (1-s)*phi0der(R) + s*phi1der(R);
+    }
+  // distance beyond which phi0 stays below k*eps
+  double phi0Cutoff(double eps) const
+    {
+      return r0 + std::log(1.0/eps)/alpha0;
+    }
   double operator()(const yaatk::VectorXD &v1, const yaatk::VectorXD &v2,
                     const int s) const
     {
@@ -86,7 +125,9 @@ public:
     alpha0(alpha0_),
     alpha1(alpha1_),
     k(k_),
-    r0(r0_)
+    r0(r0_),
+    fastExp(NULL),
+    cutoff(HUGE_VAL)
     {
     }
 };
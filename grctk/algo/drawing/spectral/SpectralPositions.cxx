@@ -0,0 +1,434 @@
+/*
+  The SpectralPositions algorithm.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SpectralPositions.hpp"
+#include "grctk/algo/drawing/pairpot/Multilevel.hpp"
+#include <gsl/gsl_rng.h>
+#include <cmath>
+#include <algorithm>
+
+namespace grctk
+{
+
+typedef std::vector<double> Vector;
+
+static
+double
+dot(const Vector& a, const Vector& b)
+{
+  double sum = 0;
+  for(size_t i = 0; i < a.size(); ++i)
+    sum += a[i]*b[i];
+  return sum;
+}
+
+static
+void
+laplacianProduct(const SpectralPositions::AdjacencyLists& adjacent,
+                 const Vector& x, Vector& y)
+{
+  for(size_t v = 0; v < adjacent.size(); ++v)
+  {
+    double sum = adjacent[v].size()*x[v];
+    for(size_t a = 0; a < adjacent[v].size(); ++a)
+      sum -= x[adjacent[v][a]];
+    y[v] = sum;
+  }
+}
+
+/*
+  Removes the components along the null space of L, i.e. the mean over
+  every connected component, and along the locked vectors.
+*/
+class Deflation
+{
+  std::vector<size_t> component;
+  std::vector<size_t> componentSize;
+  std::vector<Vector> locked;
+  mutable Vector sums;
+public:
+  Deflation(const SpectralPositions::AdjacencyLists& adjacent):
+    component(adjacent.size(),size_t(-1)),componentSize(),locked(),sums()
+    {
+      std::vector<size_t> stack;
+      for(size_t s = 0; s < adjacent.size(); ++s)
+      {
+        if (component[s] != size_t(-1))
+          continue;
+        size_t c = componentSize.size();
+        componentSize.push_back(0);
+        component[s] = c;
+        stack.push_back(s);
+        while (!stack.empty())
+        {
+          size_t v = stack.back();
+          stack.pop_back();
+          ++componentSize[c];
+          for(size_t a = 0; a < adjacent[v].size(); ++a)
+          {
+            size_t u = adjacent[v][a];
+            if (component[u] == size_t(-1))
+            {
+              component[u] = c;
+              stack.push_back(u);
+            }
+          }
+        }
+      }
+    }
+  size_t components() const { return componentSize.size(); }
+  // the eigenvectors found so far are removed as well
+  void lock(const Vector& x)
+    {
+      locked.push_back(x);
+    }
+  void operator()(Vector& x) const
+    {
+      sums.assign(componentSize.size(),0.0);
+      for(size_t v = 0; v < x.size(); ++v)
+        sums[component[v]] += x[v];
+      for(size_t c = 0; c < sums.size(); ++c)
+        sums[c] /= componentSize[c];
+      for(size_t v = 0; v < x.size(); ++v)
+        x[v] -= sums[component[v]];
+      for(size_t l = 0; l < locked.size(); ++l)
+      {
+        double c = dot(locked[l],x);
+        for(size_t v = 0; v < x.size(); ++v)
+          x[v] -= c*locked[l][v];
+      }
+    }
+};
+
+/*
+  Cyclic Jacobi method for the small dense projected matrix h (m x m,
+  row-major, destroyed): eigenvalues in ascending order, eigenvectors
+  in the columns of s.
+*/
+static
+void
+symmetricEigen(size_t m, Vector& h, Vector& values, Vector& s)
+{
+  s.assign(m*m,0.0);
+  for(size_t i = 0; i < m; ++i)
+    s[i*m + i] = 1.0;
+  for(size_t sweep = 0; sweep < 100; ++sweep)
+  {
+    double off = 0, diag = 0;
+    for(size_t i = 0; i < m; ++i)
+      for(size_t j = 0; j < m; ++j)
+        if (i != j)
+          off += h[i*m + j]*h[i*m + j];
+        else
+          diag += h[i*m + i]*h[i*m + i];
+    if (off <= 1e-30*diag || off == 0)
+      break;
+    for(size_t p = 0; p < m; ++p)
+      for(size_t q = p + 1; q < m; ++q)
+      {
+        double hpq = h[p*m + q];
+        if (hpq == 0)
+          continue;
+        double theta = (h[q*m + q] - h[p*m + p])/(2.0*hpq);
+        double t = ((theta >= 0) ? 1.0 : -1.0)/
+          (std::fabs(theta) + std::sqrt(theta*theta + 1.0));
+        double c = 1.0/std::sqrt(t*t + 1.0);
+        double sn = t*c;
+        for(size_t k = 0; k < m; ++k)
+        {
+          double hkp = h[k*m + p], hkq = h[k*m + q];
+          h[k*m + p] = c*hkp - sn*hkq;
+          h[k*m + q] = sn*hkp + c*hkq;
+        }
+        for(size_t k = 0; k < m; ++k)
+        {
+          double hpk = h[p*m + k], hqk = h[q*m + k];
+          h[p*m + k] = c*hpk - sn*hqk;
+          h[q*m + k] = sn*hpk + c*hqk;
+        }
+        for(size_t k = 0; k < m; ++k)
+        {
+          double skp = s[k*m + p], skq = s[k*m + q];
+          s[k*m + p] = c*skp - sn*skq;
+          s[k*m + q] = sn*skp + c*skq;
+        }
+      }
+  }
+
+  std::vector<std::pair<double,size_t> > order(m);
+  for(size_t i = 0; i < m; ++i)
+    order[i] = std::make_pair(h[i*m + i],i);
+  std::sort(order.begin(),order.end());
+  Vector sorted(m*m);
+  values.resize(m);
+  for(size_t j = 0; j < m; ++j)
+  {
+    values[j] = order[j].first;
+    for(size_t k = 0; k < m; ++k)
+      sorted[k*m + j] = s[k*m + order[j].second];
+  }
+  s.swap(sorted);
+}
+
+/*
+  Orthogonalizes x against basis[0..count) twice (classical Gram-Schmidt
+  with reorthogonalization) and normalizes it; returns the norm left.
+*/
+static
+double
+orthonormalize(const std::vector<Vector>& basis, size_t count,
+               const Deflation& deflate, Vector& x)
+{
+  for(size_t pass = 0; pass < 2; ++pass)
+  {
+    deflate(x);
+    for(size_t i = 0; i < count; ++i)
+    {
+      double c = dot(basis[i],x);
+      for(size_t v = 0; v < x.size(); ++v)
+        x[v] -= c*basis[i][v];
+    }
+  }
+  double norm = std::sqrt(dot(x,x));
+  if (norm > 0)
+    for(size_t v = 0; v < x.size(); ++v)
+      x[v] /= norm;
+  return norm;
+}
+
+// graphs this large start from the eigenvectors of a coarsened one
+static const size_t coarseningThreshold = 1000;
+
+/*
+  The k lowest non-trivial eigenvectors; vectors may hold approximations
+  to start from. Returns the number of non-trivial eigenvectors found
+  (less than k for small graphs).
+*/
+static
+size_t
+lowestEigenvectors(const SpectralPositions::AdjacencyLists& adjacent,
+                   size_t k, const SpectralPositions::InputParams& input,
+                   gsl_rng* rng, std::vector<Vector>& vectors,
+                   std::vector<double>& eigenvalues,
+                   size_t& restarts, double& residual)
+{
+  const size_t n = adjacent.size();
+  Deflation deflate(adjacent);
+  // the number of non-trivial eigenvectors
+  const size_t available = n - deflate.components();
+  k = std::min(k,available);
+  vectors.resize(k);
+  eigenvalues.clear();
+  residual = 0;
+  if (k == 0)
+    return 0;
+
+  if (n > coarseningThreshold)
+  {
+    std::vector<size_t> order(n), parent;
+    for(size_t i = 0; i < n; ++i)
+      order[i] = i;
+    for(size_t i = n; i > 1; --i)
+      std::swap(order[i-1],order[gsl_rng_uniform_int(rng,i)]);
+    size_t coarseSize = Multilevel::matchingCoarsening(adjacent,order,parent);
+    if (4*coarseSize <= 3*n)
+    {
+      std::vector<Vector> coarseVectors;
+      std::vector<double> coarseValues;
+      double coarseResidual;
+      size_t found = lowestEigenvectors(
+        Multilevel::coarseAdjacency(adjacent,parent,coarseSize),k,input,
+        rng,coarseVectors,coarseValues,restarts,coarseResidual);
+      for(size_t d = 0; d < found; ++d)
+      {
+        vectors[d].resize(n);
+        for(size_t v = 0; v < n; ++v)
+          vectors[d][v] = coarseVectors[d][parent[v]];
+      }
+    }
+  }
+
+  size_t basisSize = input.inp_BasisSize;
+  if (basisSize == 0)
+    basisSize = 40;
+  // an upper bound of the spectrum, the scale of the tolerance
+  double lmax = 0;
+  for(size_t v = 0; v < n; ++v)
+    lmax = std::max(lmax,2.0*adjacent[v].size());
+
+  /*
+    One eigenvector at a time, each found in the complement of the ones
+    found before: a single Krylov sequence contains only one vector of a
+    multiple eigenvalue (the two lowest modes of a square grid), and
+    these are exactly the directions a layout needs.
+  */
+  for(size_t d = 0; d < k; ++d)
+  {
+    const size_t m = std::min(std::max(basisSize,size_t(3)),available - d);
+    // Ritz vectors kept on restart
+    const size_t q = std::max(size_t(1),std::min(1 + (m - 1)/2,m - 1));
+
+    std::vector<Vector> basis(m,Vector(n,0.0));
+    Vector w(n), next(n), h(m*m,0.0), values, s;
+    std::vector<Vector> ritz(q,Vector(n,0.0));
+    size_t kept = 0;
+    size_t runRestarts = 0;
+    double runResidual = 0;
+    // a random start, or the prolonged coarse eigenvector slightly
+    // perturbed so that it is not orthogonal to the wanted one
+    for(size_t v = 0; v < n; ++v)
+      next[v] = gsl_rng_uniform(rng) - 0.5;
+    if (vectors[d].size() == n)
+    {
+      double scale = 1e-3*std::sqrt(dot(vectors[d],vectors[d])/n);
+      for(size_t v = 0; v < n; ++v)
+        next[v] = vectors[d][v] + scale*next[v];
+    }
+    orthonormalize(basis,0,deflate,next);
+
+    while (1)
+    {
+      checkAborted();
+      // basis[0..kept) are Ritz vectors with h diagonal there, next is
+      // the common direction of their residuals
+      basis[kept].swap(next);
+      for(size_t j = kept; j < m; ++j)
+      {
+        laplacianProduct(adjacent,basis[j],w);
+        deflate(w);
+        for(size_t i = 0; i <= j; ++i)
+          h[i*m + j] = h[j*m + i] = dot(basis[i],w);
+        if (orthonormalize(basis,j + 1,deflate,w) < 1e-12*lmax)
+        {
+          // invariant subspace: continue with any orthogonal direction
+          for(size_t v = 0; v < n; ++v)
+            w[v] = gsl_rng_uniform(rng) - 0.5;
+          orthonormalize(basis,j + 1,deflate,w);
+        }
+        if (j + 1 < m)
+          basis[j + 1].swap(w);
+        else
+          next.swap(w);
+      }
+
+      Vector projected(h);
+      symmetricEigen(m,projected,values,s);
+      for(size_t l = 0; l < q; ++l)
+      {
+        std::fill(ritz[l].begin(),ritz[l].end(),0.0);
+        for(size_t j = 0; j < m; ++j)
+        {
+          double c = s[j*m + l];
+          for(size_t v = 0; v < n; ++v)
+            ritz[l][v] += c*basis[j][v];
+        }
+      }
+
+      laplacianProduct(adjacent,ritz[0],w);
+      runResidual = 0;
+      for(size_t v = 0; v < n; ++v)
+        runResidual += yaatk::SQR(w[v] - values[0]*ritz[0][v]);
+      runResidual = std::sqrt(runResidual);
+      if (runResidual <= input.inp_Tolerance*lmax ||
+          runRestarts >= input.inp_MaxRestarts || m == available - d)
+        break;
+
+      ++runRestarts;
+      kept = q;
+      for(size_t l = 0; l < q; ++l)
+      {
+        basis[l].swap(ritz[l]);
+        for(size_t i = 0; i < q; ++i)
+          h[l*m + i] = (l == i) ? values[l] : 0;
+      }
+      // the direction next stays orthogonal to the new basis
+      orthonormalize(basis,q,deflate,next);
+    }
+
+    eigenvalues.push_back(values[0]);
+    restarts += runRestarts;
+    residual = std::max(residual,runResidual);
+    vectors[d] = ritz[0];
+    deflate.lock(ritz[0]);
+  }
+
+  return k;
+}
+
+void
+SpectralPositions::operator()(const AdjacencyLists &adjacent, size_t dim,
+                              const InputParams &input,
+                              std::vector<yaatk::VectorXD>& positions)
+{
+  logStream() << "\nSpectralPositions started\n";
+  flushLogStreams();
+
+  gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+  REQUIRE(rng != NULL);
+  gsl_rng_set(rng, input.inp_Seed);
+
+  restarts = 0;
+  std::vector<Vector> vectors;
+  size_t k;
+  try
+  {
+    k = lowestEigenvectors(adjacent,dim,input,rng,vectors,
+                           eigenvalues,restarts,residual);
+  }
+  catch(...)
+  {
+    gsl_rng_free(rng);
+    throw;
+  }
+
+  gsl_rng_free(rng);
+
+  positions.assign(adjacent.size(),yaatk::VectorXD(dim));
+  for(size_t v = 0; v < adjacent.size(); ++v)
+    for(size_t d = 0; d < k; ++d)
+      positions[v][d] = vectors[d][v];
+
+  logStream() << "Eigenvalues:";
+  for(size_t d = 0; d < k; ++d)
+    logStream() << " " << eigenvalues[d];
+  logStream() << "\nRestarts: " << restarts << ", residual: " << residual
+              << "\n";
+  logStream() << "SpectralPositions finished\n" ;
+  flushLogStreams();
+}
+
+void
+SpectralPositions::operator()(const AdjMatrix &g, size_t dim,
+                              const InputParams &input,
+                              Attribute<yaatk::VectorXD>& aXD)
+{
+  AdjacencyLists adjacent(g.size());
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t j = 0; j < g.size(); ++j)
+      if (i != j && g.s(i,j))
+        adjacent[i].push_back(j);
+  std::vector<yaatk::VectorXD> positions;
+  operator()(adjacent,dim,input,positions);
+  for(size_t i = 0; i < g.size(); ++i)
+    aXD[g[i]] = positions[i];
+}
+
+} //namespace grctk
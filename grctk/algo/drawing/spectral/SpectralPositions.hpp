@@ -0,0 +1,87 @@
+/*
+  The SpectralPositions algorithm (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_SpectralPositions_hpp
+#define grctk_SpectralPositions_hpp
+
+#include "grctk/algo/AlgBase.hpp"
+#include "grctk/AdjMatrix.hpp"
+#include "grctk/Universe.hpp"
+#include <yaatk/VectorXD.hpp>
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Spectral layout: coordinate d of every vertex is its component in the
+  eigenvector of the graph Laplacian L = D - A belonging to the (d+1)-th
+  smallest eigenvalue, the zero eigenvalues of the connected components
+  excluded. The eigenvectors are found by the Lanczos method with
+  Krylov-Schur restarts, which touches the graph only through products
+  L*x over the adjacency lists, so it needs O(basis size * vertex count)
+  memory besides the graph. Graphs of more than a thousand vertices
+  start from the eigenvectors of a graph coarsened by a matching.
+*/
+class SpectralPositions : public AlgBase
+{
+public:
+  typedef std::vector<std::vector<size_t> > AdjacencyLists;
+  struct InputParams
+  {
+    // Krylov basis size for each eigenvector in turn, 0 = 40
+    const size_t inp_BasisSize;
+    const size_t inp_MaxRestarts;
+    // on the residual norms |L*x - lambda*x| of the unit eigenvectors,
+    // in units of twice the maximum degree
+    const double inp_Tolerance;
+    // seed of the starting vector
+    const unsigned long inp_Seed;
+    InputParams(
+      const size_t inp_BasisSize_def = 0,
+      const size_t inp_MaxRestarts_def = 100,
+      const double inp_Tolerance_def = 1.0e-5,
+      const unsigned long inp_Seed_def = 1) :
+      inp_BasisSize(inp_BasisSize_def),
+      inp_MaxRestarts(inp_MaxRestarts_def),
+      inp_Tolerance(inp_Tolerance_def),
+      inp_Seed(inp_Seed_def)
+      {
+      }
+  };
+  // the eigenvalues and the largest residual norm of the last run
+  std::vector<double> eigenvalues;
+  double residual;
+  size_t restarts;
+  // positions[v] gets dim coordinates; dimensions without a non-trivial
+  // eigenvector (too small graphs) are zero
+  void operator()(const AdjacencyLists &adjacent, size_t dim,
+                  const InputParams &input,
+                  std::vector<yaatk::VectorXD>& positions);
+  void operator()(const AdjMatrix &g, size_t dim, const InputParams &input,
+                  Attribute<yaatk::VectorXD>& aXD);
+  SpectralPositions(Log& setlog = nullLog):
+    AlgBase(setlog), eigenvalues(), residual(0), restarts(0) {}
+};
+
+} //namespace grctk
+
+#endif
@@ -0,0 +1,340 @@
+/*
+  The StressMajorization algorithm.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StressMajorization.hpp"
+#include "grctk/algo/drawing/spectral/SpectralPositions.hpp"
+#include <gsl/gsl_rng.h>
+#include <algorithm>
+#include <cmath>
+
+namespace grctk
+{
+
+static const unsigned noPath = unsigned(-1);
+
+static
+void
+breadthFirst(const std::vector<std::vector<size_t> >& adjacent,
+             size_t source, std::vector<unsigned>& dist)
+{
+  dist.assign(adjacent.size(),noPath);
+  std::vector<size_t> queue(1,source);
+  dist[source] = 0;
+  for(size_t q = 0; q < queue.size(); q++)
+  {
+    size_t v = queue[q];
+    for(size_t a = 0; a < adjacent[v].size(); a++)
+      if (dist[adjacent[v][a]] == noPath)
+      {
+        dist[adjacent[v][a]] = dist[v] + 1;
+        queue.push_back(adjacent[v][a]);
+      }
+  }
+}
+
+// the vertices of different components get one more than the largest
+// distance within a component
+static
+void
+joinComponents(std::vector<std::vector<unsigned> >& dist)
+{
+  unsigned farthest = 0;
+  for(size_t s = 0; s < dist.size(); s++)
+    for(size_t v = 0; v < dist[s].size(); v++)
+      if (dist[s][v] != noPath)
+        farthest = std::max(farthest,dist[s][v]);
+  for(size_t s = 0; s < dist.size(); s++)
+    for(size_t v = 0; v < dist[s].size(); v++)
+      if (dist[s][v] == noPath)
+        dist[s][v] = farthest + 1;
+}
+
+void
+StressMajorization::fullStressTerms(const AdjacencyLists& adjacent)
+{
+  terms.clear();
+  distances.resize(adjacent.size());
+  for(size_t i = 0; i < adjacent.size(); i++)
+  {
+    checkAborted();
+    breadthFirst(adjacent,i,distances[i]);
+  }
+  joinComponents(distances);
+}
+
+void
+StressMajorization::sparseStressTerms(const AdjacencyLists& adjacent,
+                                      size_t pivots, unsigned long seed)
+{
+  size_t n = adjacent.size();
+  distances.clear();
+
+  gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+  REQUIRE(rng != NULL);
+  gsl_rng_set(rng, seed);
+  size_t pivot = gsl_rng_uniform_int(rng,n);
+  gsl_rng_free(rng);
+
+  // max-min pivots; every vertex belongs to the region of the nearest
+  std::vector<size_t> pivotVertex;
+  std::vector<std::vector<unsigned> > pivotDist(pivots);
+  std::vector<unsigned> nearestDist(n,noPath);
+  std::vector<size_t> nearest(n,0);
+  for(size_t p = 0; p < pivots; p++)
+  {
+    checkAborted();
+    pivotVertex.push_back(pivot);
+    breadthFirst(adjacent,pivot,pivotDist[p]);
+    for(size_t v = 0; v < n; v++)
+      if (pivotDist[p][v] < nearestDist[v])
+      {
+        nearestDist[v] = pivotDist[p][v];
+        nearest[v] = p;
+      }
+    // unreachable vertices count as the farthest ones
+    for(size_t v = 0; v < n; v++)
+      if (nearestDist[v] > nearestDist[pivot])
+        pivot = v;
+  }
+  joinComponents(pivotDist);
+
+  std::vector<std::vector<unsigned> > region(pivots);
+  for(size_t v = 0; v < n; v++)
+    region[nearest[v]].push_back(pivotDist[nearest[v]][v]);
+  for(size_t p = 0; p < pivots; p++)
+    std::sort(region[p].begin(),region[p].end());
+
+  terms.assign(n,std::vector<Term>());
+  std::vector<size_t> neighbourOf(n,size_t(-1));
+  for(size_t i = 0; i < n; i++)
+  {
+    for(size_t a = 0; a < adjacent[i].size(); a++)
+    {
+      neighbourOf[adjacent[i][a]] = i;
+      terms[i].push_back(Term(adjacent[i][a],1,1));
+    }
+    for(size_t p = 0; p < pivots; p++)
+    {
+      size_t j = pivotVertex[p];
+      if (j == i || neighbourOf[j] == i)
+        continue;
+      double d = pivotDist[p][i];
+      // the part of the region of p at most halfway from p to i
+      double s = std::upper_bound(region[p].begin(),region[p].end(),
+                                  unsigned(d/2)) - region[p].begin();
+      terms[i].push_back(Term(j,d,s/(d*d)));
+    }
+  }
+}
+
+void
+StressMajorization::sweep(std::vector<double>& x, size_t dim,
+                          double edgeLength)
+{
+  size_t n = x.size()/dim;
+  std::vector<double> sum(dim);
+  for(size_t i = 0; i < n; i++)
+  {
+    double* xi = &x[i*dim];
+    std::fill(sum.begin(),sum.end(),0.0);
+    double wsum = 0;
+    size_t count = distances.empty() ? terms[i].size() : n;
+    for(size_t t = 0; t < count; t++)
+    {
+      size_t j;
+      double d, w;
+      if (distances.empty())
+      {
+        j = terms[i][t].j;
+        d = terms[i][t].d*edgeLength;
+        w = terms[i][t].w/(edgeLength*edgeLength);
+      }
+      else
+      {
+        j = t;
+        if (j == i)
+          continue;
+        d = distances[i][j]*edgeLength;
+        w = 1.0/(d*d);
+      }
+      const double* xj = &x[j*dim];
+      double len2 = 0;
+      for(size_t k = 0; k < dim; k++)
+        len2 += (xi[k] - xj[k])*(xi[k] - xj[k]);
+      double scale = (len2 > 0) ? d/std::sqrt(len2) : 0.0;
+      for(size_t k = 0; k < dim; k++)
+        sum[k] += w*(xj[k] + scale*(xi[k] - xj[k]));
+      wsum += w;
+    }
+    if (wsum > 0)
+      for(size_t k = 0; k < dim; k++)
+        xi[k] = sum[k]/wsum;
+  }
+}
+
+double
+StressMajorization::stress(const std::vector<double>& x, size_t dim,
+                           double edgeLength) const
+{
+  size_t n = x.size()/dim;
+  double s = 0;
+  for(size_t i = 0; i < n; i++)
+  {
+    const double* xi = &x[i*dim];
+    size_t count = distances.empty() ? terms[i].size() : n;
+    for(size_t t = 0; t < count; t++)
+    {
+      size_t j;
+      double d, w;
+      if (distances.empty())
+      {
+        j = terms[i][t].j;
+        d = terms[i][t].d*edgeLength;
+        w = terms[i][t].w/(edgeLength*edgeLength);
+      }
+      else
+      {
+        j = t;
+        if (j <= i)
+          continue;
+        d = distances[i][j]*edgeLength;
+        w = 1.0/(d*d);
+      }
+      const double* xj = &x[j*dim];
+      double len2 = 0;
+      for(size_t k = 0; k < dim; k++)
+        len2 += (xi[k] - xj[k])*(xi[k] - xj[k]);
+      double e = std::sqrt(len2) - d;
+      s += w*e*e;
+    }
+  }
+  return s;
+}
+
+void
+StressMajorization::operator()(const InputParams &input, GraphRep &rep)
+{
+  logStream() << "\nStressMajorization started\n";
+  flushLogStreams();
+
+  const AdjMatrix& g = rep.g;
+  size_t n = g.size();
+  size_t dim = rep.dim;
+  double L = input.inp_EdgeLength;
+  REQUIRE(dim > 0 && L > 0);
+
+  AdjacencyLists adjacent(n);
+  for(size_t i = 0; i < n; i++)
+    for(size_t j = 0; j < n; j++)
+      if (i != j && g.s(i,j))
+        adjacent[i].push_back(j);
+
+  iterations = 0;
+  rep.energyTrace.clear();
+  if (n == 0)
+  {
+    rep.energy = 0;
+    logStream() << "StressMajorization finished\n" ;
+    flushLogStreams();
+    return;
+  }
+
+  if (input.inp_Pivots == 0 || input.inp_Pivots >= n)
+    fullStressTerms(adjacent);
+  else
+    sparseStressTerms(adjacent,input.inp_Pivots,input.inp_Seed);
+
+  std::vector<double> x(n*dim,0.0);
+  bool placed = false;
+  if (input.inp_UseExisted)
+  {
+    for(size_t v = 0; v < n; v++)
+    {
+      const yaatk::VectorXD& p = rep.aXD[g[v]];
+      REQUIRE(p.size() == dim);
+      for(size_t k = 0; k < dim; k++)
+        x[v*dim+k] = p[k];
+    }
+    placed = true;
+  }
+  else if (input.inp_Spectral)
+  {
+    SpectralPositions spectral(log);
+    std::vector<yaatk::VectorXD> positions;
+    spectral(adjacent,dim,
+             SpectralPositions::InputParams(0,100,1.0e-5,input.inp_Seed),
+             positions);
+    double sum = 0;
+    size_t count = 0;
+    for(size_t i = 0; i < n; i++)
+      for(size_t a = 0; a < adjacent[i].size(); a++, count++)
+        sum += yaatk::module(
+          yaatk::VectorXD(positions[i] - positions[adjacent[i][a]]));
+    if (count > 0 && sum > 0)
+    {
+      double scale = L*count/sum;
+      for(size_t v = 0; v < n; v++)
+        for(size_t k = 0; k < dim; k++)
+          x[v*dim+k] = scale*positions[v][k];
+      placed = true;
+    }
+  }
+  if (!placed)
+  {
+    gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+    REQUIRE(rng != NULL);
+    gsl_rng_set(rng, input.inp_Seed);
+    double side = L*std::sqrt(double(n));
+    for(size_t i = 0; i < x.size(); i++)
+      x[i] = side*gsl_rng_uniform(rng);
+    gsl_rng_free(rng);
+  }
+
+  double s = stress(x,dim,L);
+  rep.energyTrace.push_back(s);
+  while (iterations < input.inp_MaxIterations)
+  {
+    checkAborted();
+    sweep(x,dim,L);
+    ++iterations;
+    double previous = s;
+    s = stress(x,dim,L);
+    rep.energyTrace.push_back(s);
+    if (previous - s <= input.inp_Tolerance*previous)
+      break;
+  }
+
+  for(size_t v = 0; v < n; v++)
+  {
+    yaatk::VectorXD p(dim);
+    for(size_t k = 0; k < dim; k++)
+      p[k] = x[v*dim+k];
+    rep.aXD[g[v]] = p;
+  }
+  rep.energy = s;
+
+  logStream() << "Iterations: " << iterations << ", stress = " << s
+              << ((distances.empty()) ? " (sparse)" : "") << "\n";
+  logStream() << "StressMajorization finished\n" ;
+  flushLogStreams();
+}
+
+} //namespace grctk
@@ -0,0 +1,114 @@
+/*
+  The StressMajorization algorithm (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_StressMajorization_hpp
+#define grctk_StressMajorization_hpp
+
+#include "grctk/algo/AlgBase.hpp"
+#include "grctk/algo/drawing/GraphRep.hpp"
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Distance-based layout: minimizes the stress
+    sum w_ij (|x_i - x_j| - d_ij)^2,  w_ij = 1/d_ij^2,
+  d_ij being the shortest path length times inp_EdgeLength, by SMACOF
+  iterations: every vertex in turn goes to the weighted mean of the
+  places its partners would put it to, which never increases the
+  stress. Vertices of different components are kept one edge farther
+  apart than the farthest vertices of a component.
+
+  With inp_Pivots > 0 the stress is sparse: a vertex interacts with its
+  neighbours and with inp_Pivots pivots chosen by max-min distance, a
+  pivot standing for the vertices closer to it than to the other pivots
+  (Ortmann, Klimenta, Brandes, Journal of Graph Algorithms and
+  Applications 21(3), 2017), which needs O(inp_Pivots * n) memory and
+  time per iteration instead of O(n^2).
+
+  rep.energy is the final stress, rep.energyTrace the stress before
+  the first iteration and after every one.
+*/
+class StressMajorization : public AlgBase
+{
+public:
+  struct InputParams
+  {
+    const size_t inp_MaxIterations;
+    // the iterations stop when the stress decreases by a smaller part
+    const double inp_Tolerance;
+    // 0 = the full stress over all the pairs of vertices
+    const size_t inp_Pivots;
+    const double inp_EdgeLength;
+    // start from rep.aXD instead of random positions
+    const bool inp_UseExisted;
+    // start from the spectral layout (see SpectralPositions)
+    const bool inp_Spectral;
+    const unsigned long inp_Seed;
+    InputParams(
+      const size_t inp_MaxIterations_def = 500,
+      const double inp_Tolerance_def = 1.0e-5,
+      const size_t inp_Pivots_def = 0,
+      const double inp_EdgeLength_def = 1.0,
+      const bool inp_UseExisted_def = false,
+      const bool inp_Spectral_def = false,
+      const unsigned long inp_Seed_def = 1) :
+      inp_MaxIterations(inp_MaxIterations_def),
+      inp_Tolerance(inp_Tolerance_def),
+      inp_Pivots(inp_Pivots_def),
+      inp_EdgeLength(inp_EdgeLength_def),
+      inp_UseExisted(inp_UseExisted_def),
+      inp_Spectral(inp_Spectral_def),
+      inp_Seed(inp_Seed_def)
+      {
+      }
+  };
+  // iterations made by the last run
+  size_t iterations;
+  void operator()(const InputParams &input, GraphRep &rep);
+  StressMajorization(Log& setlog = nullLog):
+    AlgBase(setlog), iterations(0), terms(), distances() {}
+private:
+  struct Term
+  {
+    size_t j;
+    double d;
+    double w;
+    Term(size_t vertex, double distance, double weight):
+      j(vertex),d(distance),w(weight) {}
+  };
+  typedef std::vector<std::vector<size_t> > AdjacencyLists;
+  // the partners of every vertex, sparse stress
+  std::vector<std::vector<Term> > terms;
+  // graph distances between all the vertices, full stress
+  std::vector<std::vector<unsigned> > distances;
+  void fullStressTerms(const AdjacencyLists& adjacent);
+  void sparseStressTerms(const AdjacencyLists& adjacent, size_t pivots,
+                         unsigned long seed);
+  void sweep(std::vector<double>& x, size_t dim, double edgeLength);
+  double stress(const std::vector<double>& x, size_t dim,
+                double edgeLength) const;
+};
+
+} //namespace grctk
+
+#endif
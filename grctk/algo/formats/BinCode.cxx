@@ -32,7 +32,8 @@ BinCode::BinCode(unsigned short int vcount):
   vc(vcount)
 {
   unsigned long n = vcount;
-  bic.resize((((n*(n-1))/2-1)/(8*sizeof(BaseType))+1));
+  if (n > 1)
+    bic.resize((((n*(n-1))/2-1)/(8*sizeof(BaseType))+1));
 }
 
 BinCode::~BinCode()
@@ -56,13 +57,34 @@ BinCode::operator=(const BinCode &obj)
   return (*this);
 }
 
-AdjMatrix
-BinCode::getGraph(std::ifstream& in)
+size_t
+BinCode::edgeCount() const
 {
-  AdjMatrix g(vc);
+  size_t count = 0;
+  for(size_t i = 0; i < bic.size(); i++)
+    for(BaseType b = bic[i]; b != 0; b &= b - 1)
+      count++;
+  return count;
+}
 
+void
+BinCode::read(std::istream& in)
+{
   for(size_t i = 0; i < bic.size(); i++)
     in.read((char*)&(bic[i]), sizeof(BaseType));
+}
+
+void
+BinCode::write(std::ostream& out) const
+{
+  for(size_t i = 0; i < bic.size(); i++)
+    out.write((char*)&(bic[i]), sizeof(BaseType));
+}
+
+AdjMatrix
+BinCode::decode() const
+{
+  AdjMatrix g(vc);
 
   std::vector<bool> a;
   for(size_t i = 0; i < bic.size(); i++)
@@ -93,7 +115,7 @@ BinCode::getGraph(std::ifstream& in)
 }
 
 void
-BinCode::writeGraph(std::ofstream& out, const AdjMatrix& g)
+BinCode::encode(const AdjMatrix& g)
 {
   if (g.vertexCount() != vc)
     throw std::logic_error("BinCode::writeGraph failed !");
@@ -122,13 +144,24 @@ BinCode::writeGraph(std::ofstream& out, const AdjMatrix& g)
     int inn = sizeof(BaseType)*8 - 1 - i%(sizeof(BaseType)*8);
     bic[ibic] |= (BaseType(a[i])) << inn;
   }
+}
 
-  for(size_t i = 0; i < bic.size(); i++)
-    out.write((char*)&(bic[i]), sizeof(BaseType));
+AdjMatrix
+BinCode::getGraph(std::ifstream& in)
+{
+  read(in);
+  return decode();
+}
+
+void
+BinCode::writeGraph(std::ofstream& out, const AdjMatrix& g)
+{
+  encode(g);
+  write(out);
 }
 
 unsigned long
-BinCode::checksum()
+BinCode::checksum() const
 {
   unsigned long nChecksum = 0;
   for(size_t i = 0; i < bic.size(); i++)
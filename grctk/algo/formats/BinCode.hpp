@@ -26,6 +26,7 @@
 #include "grctk/AdjMatrix.hpp"
 #include <vector>
 #include <fstream>
+#include <iostream>
 
 namespace grctk
 {
@@ -36,16 +37,26 @@ class BinCode
   std::vector<BaseType> bic;
   unsigned short int vc;
 public:
-  size_t getLen() { return bic.size()*sizeof(BaseType); }
-  BinCode(unsigned short int vcount);
+  size_t getLen() const { return bic.size()*sizeof(BaseType); }
+  BinCode(unsigned short int vcount = 0);
   virtual ~BinCode();
   BinCode(const BinCode&);
   BinCode& operator = (const BinCode&);
 
+  unsigned short int vertexCount() const { return vc; }
+  size_t edgeCount() const;
+
+  // the code itself does not refer to any Universe, so unlike AdjMatrix
+  // it can be passed between threads
+  void read(std::istream &);
+  void write(std::ostream &) const;
+  AdjMatrix decode() const;
+  void encode(const AdjMatrix& g);
+
   AdjMatrix getGraph(std::ifstream &);
   void writeGraph(std::ofstream &, const AdjMatrix& g);
 
-  unsigned long checksum();
+  unsigned long checksum() const;
 };
 
 }
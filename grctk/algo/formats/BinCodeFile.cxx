@@ -84,20 +84,27 @@ BinCodeFileReader::listGraphs(std::vector<std::string>& items)
   }
 }
 
-AdjMatrix
-BinCodeFileReader::getGraph(unsigned long i)
+BinCode
+BinCodeFileReader::getCode(unsigned long i)
 {
-  AdjMatrix g;
+  BinCode bc(nv);
   if (/*i >=0 &&*/ i < ng)
   {
-    BinCode bc(nv);
     in.seekg(BINCODE_HEADER_LENGTH + bc.getLen()*i, std::ios::beg);
-    g.cloneFrom(bc.getGraph(in));
+    bc.read(in);
     in.seekg(BINCODE_HEADER_LENGTH, std::ios::beg);
   }
   else
     throw std::runtime_error("BinCodeFileReader: wrong graph index");
 
+  return bc;
+}
+
+AdjMatrix
+BinCodeFileReader::getGraph(unsigned long i)
+{
+  AdjMatrix g;
+  g.cloneFrom(getCode(i).decode());
   return g;
 }
 
@@ -114,25 +121,28 @@ BinCodeFileWriter::writeHeader()
 
 void
 BinCodeFileWriter::addGraph(const AdjMatrix& g)
+{
+  BinCode bc(g.size());
+  bc.encode(g);
+  addCode(bc);
+}
+
+void
+BinCodeFileWriter::addCode(const BinCode& bc)
 {
   if (ng == 0)
   {
     REQUIRE(nv == 0 && ne == 0);
-    nv = g.size();
-    ne = 0;
-    for(size_t i = 0; i < g.size(); ++i)
-      for(size_t j = i+1; j < g.size(); ++j)
-        if (g.s(i,j))
-          ++ne;
+    nv = bc.vertexCount();
+    ne = bc.edgeCount();
   }
   else
   {
-    REQUIRE(nv == g.size());
+    REQUIRE(nv == bc.vertexCount());
   }
 
-  BinCode bc(nv);
   out.seekp(BINCODE_HEADER_LENGTH + bc.getLen()*ng, std::ios::beg);
-  bc.writeGraph(out, g);
+  bc.write(out);
   out.seekp(BINCODE_HEADER_LENGTH, std::ios::beg);
 
   ng++;
@@ -24,6 +24,7 @@
 #define grctk_BinCodeFile_hpp
 
 #include "grctk/AdjMatrix.hpp"
+#include "BinCode.hpp"
 #include <vector>
 #include <string>
 #include <fstream>
@@ -49,6 +50,7 @@ public:
 
   void listGraphs(std::vector<std::string>&);
   AdjMatrix getGraph(unsigned long i);
+  BinCode getCode(unsigned long i);
 
   bool checksumIsCorrect() {return getChecksum() == checksum; }
 private:
@@ -75,6 +77,7 @@ public:
   unsigned long getChecksum() { return checksum; }
 
   void addGraph(const AdjMatrix&);
+  void addCode(const BinCode&);
 private:
   BinCodeFileWriter(const BinCodeFileWriter&);
   BinCodeFileWriter& operator=(const BinCodeFileWriter&);
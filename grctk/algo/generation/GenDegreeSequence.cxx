@@ -0,0 +1,442 @@
+/*
+  The GenDegreeSequence class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GenDegreeSequence.hpp"
+#include "grctk/algo/formats/BinCode.hpp"
+#include "grctk/algo/pipeline/Pipeline.hpp"
+#include <yaatk/Hash.hpp>
+#include "zthread/PoolExecutor.h"
+#include "zthread/Runnable.h"
+#include <gsl/gsl_rng.h>
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace grctk
+{
+
+// draws of two points in a row that could not be joined, after which
+// the free points are checked for a pair that can be joined at all
+static const size_t maxMisses = 64;
+
+static
+bool
+adjacent(const std::vector<std::vector<size_t> >& adjacency,
+         size_t u, size_t v)
+{
+  const std::vector<size_t>& shorter =
+    (adjacency[u].size() <= adjacency[v].size()) ? adjacency[u] : adjacency[v];
+  size_t other = (adjacency[u].size() <= adjacency[v].size()) ? v : u;
+  return std::find(shorter.begin(),shorter.end(),other) != shorter.end();
+}
+
+static
+bool
+joinable(const std::vector<std::vector<size_t> >& adjacency,
+         size_t u, size_t v)
+{
+  return u != v && !adjacent(adjacency,u,v);
+}
+
+static
+void
+unlink(std::vector<std::vector<size_t> >& adjacency, size_t u, size_t v)
+{
+  std::vector<size_t>& list = adjacency[u];
+  *std::find(list.begin(),list.end(),v) = list.back();
+  list.pop_back();
+}
+
+static
+void
+join(std::vector<std::vector<size_t> >& adjacency,
+     GenRandom::EdgeList& edges, size_t k, size_t u, size_t v)
+{
+  adjacency[u].push_back(v);
+  adjacency[v].push_back(u);
+  std::pair<size_t,size_t> edge(std::min(u,v),std::max(u,v));
+  if (k < edges.size())
+    edges[k] = edge;
+  else
+    edges.push_back(edge);
+}
+
+// removes the free points a and b
+static
+void
+takePoints(std::vector<size_t>& points, size_t a, size_t b)
+{
+  if (a < b)
+    std::swap(a,b);
+  points[a] = points.back();
+  points.pop_back();
+  points[b] = points.back();
+  points.pop_back();
+}
+
+static
+bool
+anyJoinable(const std::vector<std::vector<size_t> >& adjacency,
+            const std::vector<size_t>& points)
+{
+  std::vector<size_t> holders(points);
+  std::sort(holders.begin(),holders.end());
+  holders.erase(std::unique(holders.begin(),holders.end()),holders.end());
+  for(size_t i = 0; i < holders.size(); ++i)
+    for(size_t j = i + 1; j < holders.size(); ++j)
+      if (!adjacent(adjacency,holders[i],holders[j]))
+        return true;
+  return false;
+}
+
+// u and v hold free points that cannot be joined (u == v or uv is an
+// edge already): an edge xy, tried from a random one on, becomes ux
+// and vy, which uses up both points and keeps the degrees of x and y
+static
+bool
+switchEdge(gsl_rng* rng, std::vector<std::vector<size_t> >& adjacency,
+           GenRandom::EdgeList& edges, size_t u, size_t v)
+{
+  if (edges.empty())
+    return false;
+  size_t start = gsl_rng_uniform_int(rng,edges.size());
+  for(size_t t = 0; t < edges.size(); ++t)
+  {
+    size_t k = (start + t) % edges.size();
+    for(size_t o = 0; o < 2; ++o)
+    {
+      size_t x = (o == 0) ? edges[k].first : edges[k].second;
+      size_t y = (o == 0) ? edges[k].second : edges[k].first;
+      if (joinable(adjacency,u,x) && joinable(adjacency,v,y))
+      {
+        unlink(adjacency,x,y);
+        unlink(adjacency,y,x);
+        join(adjacency,edges,k,u,x);
+        join(adjacency,edges,edges.size(),v,y);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool
+GenDegreeSequence::isGraphical(const std::vector<size_t>& degrees)
+{
+  const size_t n = degrees.size();
+  std::vector<size_t> d(degrees);
+  std::sort(d.begin(),d.end(),std::greater<size_t>());
+  std::vector<uint64_t> prefix(n + 1,0);
+  for(size_t i = 0; i < n; ++i)
+    prefix[i+1] = prefix[i] + d[i];
+  if (prefix[n] % 2 != 0 || (n > 0 && d[0] >= n))
+    return false;
+  // sum of the k largest <= k(k-1) + sum over the rest of min(d_i,k);
+  // p is the number of the degrees >= k
+  size_t p = n;
+  for(size_t k = 1; k <= n; ++k)
+  {
+    while (p > 0 && d[p-1] < k)
+      --p;
+    size_t q = std::max(k,p);
+    uint64_t rhs = uint64_t(k)*(k - 1) + uint64_t(k)*(q - k)
+      + (prefix[n] - prefix[q]);
+    if (prefix[k] > rhs)
+      return false;
+  }
+  return true;
+}
+
+void
+GenDegreeSequence::sample(const std::vector<size_t>& degrees,
+                          unsigned long seed, GenRandom::EdgeList& edges)
+{
+  const size_t vc = degrees.size();
+  uint64_t total = 0;
+  for(size_t v = 0; v < vc; ++v)
+  {
+    REQUIRE(degrees[v] < vc);
+    total += degrees[v];
+  }
+  // more than half of the pairs are edges: the complement is sampled
+  // instead, as free points are rarely joinable near the end otherwise
+  const uint64_t pairs = uint64_t(vc)*(vc > 0 ? vc - 1 : 0)/2;
+  if (total > pairs)
+  {
+    std::vector<size_t> complement(vc);
+    for(size_t v = 0; v < vc; ++v)
+      complement[v] = vc - 1 - degrees[v];
+    GenRandom::EdgeList missing;
+    sample(complement,seed,missing);
+    std::vector<uint64_t> skipped(missing.size());
+    for(size_t k = 0; k < missing.size(); ++k)
+      skipped[k] = GenRandom::pairIndex(vc,missing[k].first,missing[k].second);
+    std::sort(skipped.begin(),skipped.end());
+    edges.clear();
+    edges.reserve(total/2);
+    uint64_t index = 0;
+    size_t next = 0;
+    for(size_t i = 0; i < vc; ++i)
+      for(size_t j = i + 1; j < vc; ++j, ++index)
+        if (next < skipped.size() && skipped[next] == index)
+          ++next;
+        else
+          edges.push_back(std::make_pair(i,j));
+    return;
+  }
+
+  std::vector<size_t> points;
+  std::vector<std::vector<size_t> > adjacency(vc);
+  for(size_t v = 0; v < vc; ++v)
+  {
+    points.insert(points.end(),degrees[v],v);
+    adjacency[v].reserve(degrees[v]);
+  }
+  REQUIRE(points.size() % 2 == 0);
+  edges.clear();
+  edges.reserve(points.size()/2);
+
+  gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+  REQUIRE(rng != NULL);
+  gsl_rng_set(rng, seed);
+
+  try
+  {
+    size_t misses = 0;
+    while (!points.empty())
+    {
+      size_t a = gsl_rng_uniform_int(rng,points.size());
+      size_t b = gsl_rng_uniform_int(rng,points.size() - 1);
+      if (b >= a)
+        ++b;
+      if (joinable(adjacency,points[a],points[b]))
+      {
+        join(adjacency,edges,edges.size(),points[a],points[b]);
+        takePoints(points,a,b);
+        misses = 0;
+        continue;
+      }
+      if (++misses < maxMisses)
+        continue;
+      misses = 0;
+      checkAborted();
+      if (anyJoinable(adjacency,points))
+        continue;
+      if (switchEdge(rng,adjacency,edges,points[0],points[1]))
+        takePoints(points,0,1);
+      else
+      {
+        // no single switching fits (only very dense sequences get
+        // here): a random edge goes back to the free points instead
+        size_t k = gsl_rng_uniform_int(rng,edges.size());
+        size_t x = edges[k].first, y = edges[k].second;
+        unlink(adjacency,x,y);
+        unlink(adjacency,y,x);
+        edges[k] = edges.back();
+        edges.pop_back();
+        points.push_back(x);
+        points.push_back(y);
+      }
+    }
+  }
+  catch(...)
+  {
+    gsl_rng_free(rng);
+    throw;
+  }
+
+  gsl_rng_free(rng);
+}
+
+AdjMatrix
+GenDegreeSequence::operator()(const InputParams& input)
+{
+  logStream() << "\nGenDegreeSequence started\n";
+  logStream() << "size = " << input.inp_Degrees.size() << "\n";
+  flushLogStreams();
+
+  if (!isGraphical(input.inp_Degrees))
+    throw std::logic_error("No simple graph has the given degrees");
+
+  GenRandom::EdgeList edges;
+  sample(input.inp_Degrees,
+         (input.inp_Seed != 0) ? input.inp_Seed : (unsigned long int) time(NULL),
+         edges);
+  checkAborted();
+  AdjMatrix g = GenRandom::fromEdges(input.inp_Degrees.size(),edges);
+
+  logStream() << "Edges: " << edges.size() << "\n";
+  logStream() << "GenDegreeSequence finished\n";
+  flushLogStreams();
+
+  return g;
+}
+
+struct GenDegreeSequenceResult
+{
+  BinCode code;
+  bool aborted;
+  std::string error;
+  // set by the worker once the fields above are filled, whatever the
+  // outcome
+  std::atomic<bool> finished;
+  GenDegreeSequenceResult():
+    code(),aborted(false),error(),finished(false) {}
+  void reset()
+    {
+      code = BinCode();
+      aborted = false;
+      error = "";
+      finished.store(false);
+    }
+};
+
+/*
+  One sample of the streaming call. The graph is built in a universe
+  of the worker's own and only its BinCode leaves the thread.
+*/
+class GenDegreeSequenceSample : public ZThread::Runnable
+{
+  const std::vector<size_t>& degrees;
+  const unsigned long seed;
+  GenDegreeSequenceResult& result;
+public:
+  GenDegreeSequenceSample(const std::vector<size_t>& sampleDegrees,
+                          unsigned long sampleSeed,
+                          GenDegreeSequenceResult& res):
+    degrees(sampleDegrees),seed(sampleSeed),result(res)
+    {
+    }
+  virtual void run()
+    {
+      try
+      {
+        GenRandom::EdgeList edges;
+        GenDegreeSequence::sample(degrees,seed,edges);
+        Universe universe;
+        UniverseScope scope(universe);
+        AdjMatrix g = GenRandom::fromEdges(degrees.size(),edges);
+        BinCode code(degrees.size());
+        code.encode(g);
+        result.code = code;
+      }
+      catch(AbortAlgException&)
+      {
+        result.aborted = true;
+      }
+      catch(std::exception& e)
+      {
+        result.error = e.what();
+      }
+      catch(...)
+      {
+        result.error = "Unknown exception";
+      }
+      result.finished.store(true);
+    }
+};
+
+void
+GenDegreeSequence::operator()(const InputParams& input, unsigned long samples,
+                              BinCodeFileWriter& writer)
+{
+  logStream() << "\nGenDegreeSequence started\n";
+  logStream() << "size = " << input.inp_Degrees.size() << "\n";
+  flushLogStreams();
+
+  if (!isGraphical(input.inp_Degrees))
+    throw std::logic_error("No simple graph has the given degrees");
+
+  unsigned long masterSeed = input.inp_Seed;
+  if (masterSeed == 0)
+  {
+    time_t t;
+    masterSeed = (unsigned long)time(&t);
+  }
+  size_t threads = input.inp_Threads;
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads == 0)
+    threads = 1;
+  if (samples > 0 && threads > samples)
+    threads = samples;
+
+  logStream() << "Writing " << samples << " samples on " << threads
+              << " thread(s), seed = " << masterSeed << "\n";
+  flushLogStreams();
+
+  // samples written..submitted-1 are in flight, sample i in slot
+  // i % slots.size(); the head one is written as soon as it is
+  // finished and its slot takes the next sample
+  std::vector<GenDegreeSequenceResult> slots(2*threads);
+  unsigned long submitted = 0, written = 0;
+  ZThread::PoolExecutor pool(threads);
+  try
+  {
+    while (written < samples)
+    {
+      while (submitted < samples && submitted < written + slots.size())
+      {
+        GenDegreeSequenceResult& slot = slots[submitted % slots.size()];
+        slot.reset();
+        unsigned long seed = (unsigned long)(
+          yaatk::hashCombine(masterSeed,submitted) & 0xffffffffUL);
+        pool.execute(ZThread::Task(new GenDegreeSequenceSample(
+                                     input.inp_Degrees,
+                                     (seed != 0) ? seed : 1,
+                                     slot)));
+        ++submitted;
+      }
+      GenDegreeSequenceResult& head = slots[written % slots.size()];
+      size_t attempt = 0;
+      while (!head.finished.load())
+      {
+        checkAborted();
+        PipelineControl::backoff(attempt);
+      }
+      if (head.error != "")
+        throw std::runtime_error("GenDegreeSequence: " + head.error);
+      if (head.aborted)
+        throw AbortAlgException("Exiting via the flag...");
+      writer.addCode(head.code);
+      head.code = BinCode();
+      ++written;
+    }
+  }
+  catch(...)
+  {
+    // the tasks refer to the slots
+    pool.interrupt();
+    pool.wait();
+    throw;
+  }
+  pool.wait();
+
+  logStream() << "Graphs written: " << written << "\n";
+  logStream() << "GenDegreeSequence finished\n";
+  flushLogStreams();
+}
+
+} //namespace grctk
@@ -0,0 +1,95 @@
+/*
+  The GenDegreeSequence class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_GenDegreeSequence_hpp
+#define grctk_GenDegreeSequence_hpp
+
+#include "GenRandom.hpp"
+#include "grctk/algo/AlgBase.hpp"
+#include "grctk/algo/formats/BinCodeFile.hpp"
+#include "grctk/AdjMatrix.hpp"
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Random simple graphs with the given vertex degrees, d-regular ones
+  in particular, by the pairing model with the pairs chosen one by one
+  (Steger-Wormald): two random free points are joined unless that
+  makes a loop or a multiple edge, in which case another two are
+  drawn. Nothing is ever restarted: when no free points can be joined
+  any more, an edge xy already made is switched to ux and vy, where u
+  and v hold free points. The samples are close to uniform for small
+  degrees, not exactly uniform. When more than half of the pairs are
+  edges, the complement graph is sampled instead.
+
+  The streaming call writes the given number of samples to a BinCode
+  file in the order of their numbers. Every sample has a generator of
+  its own seeded from inp_Seed and the sample number, so the file does
+  not depend on inp_Threads. At most 2*inp_Threads samples are in
+  flight, whatever their number.
+*/
+class GenDegreeSequence : public AlgBase
+{
+public:
+  struct InputParams
+  {
+    const std::vector<size_t> inp_Degrees;
+    // 0 takes the seed from the clock
+    const unsigned long inp_Seed;
+    // the streaming call only; 0 runs one thread per processor
+    const size_t inp_Threads;
+    InputParams(
+      const std::vector<size_t>& inp_Degrees_def,
+      const unsigned long inp_Seed_def = 0,
+      const size_t inp_Threads_def = 1) :
+      inp_Degrees(inp_Degrees_def),
+      inp_Seed(inp_Seed_def),
+      inp_Threads(inp_Threads_def)
+      {
+      }
+    // d-regular graphs on inp_VertexCount vertices
+    InputParams(
+      const size_t inp_VertexCount,
+      const size_t inp_Degree,
+      const unsigned long inp_Seed_def = 0,
+      const size_t inp_Threads_def = 1) :
+      inp_Degrees(inp_VertexCount,inp_Degree),
+      inp_Seed(inp_Seed_def),
+      inp_Threads(inp_Threads_def)
+      {
+      }
+  };
+  // Erdos-Gallai, O(n log n)
+  static bool isGraphical(const std::vector<size_t>& degrees);
+  // one sample, without building the graph
+  static void sample(const std::vector<size_t>& degrees, unsigned long seed,
+                     GenRandom::EdgeList& edges);
+  AdjMatrix operator()(const InputParams& input);
+  void operator()(const InputParams& input, unsigned long samples,
+                  BinCodeFileWriter& writer);
+  GenDegreeSequence(Log& setlog = nullLog): AlgBase(setlog) {}
+};
+
+} //namespace grctk
+
+#endif
@@ -21,13 +21,253 @@
 */
 
 #include "GenRandom.hpp"
-#include "grctk/algo/connectivity/ConComp.hpp"
 #include <gsl/gsl_rng.h>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <queue>
+#include <set>
 #include <stdexcept>
 
 namespace grctk
 {
 
+static
+uint64_t
+uniformIndex(gsl_rng* rng, uint64_t n)
+{
+  if (n <= gsl_rng_max(rng) - gsl_rng_min(rng))
+    return gsl_rng_uniform_int(rng,n);
+  // ranlxd2 gives 32 bits a draw
+  uint64_t x = (uint64_t(gsl_rng_get(rng)) << 32) | gsl_rng_get(rng);
+  return x % n;
+}
+
+// k distinct values of [0,n), ascending (Floyd's algorithm: one draw a
+// value, a repeated draw takes the top of its range instead)
+static
+void
+sampleIndices(gsl_rng* rng, uint64_t n, uint64_t k,
+              std::vector<uint64_t>& result)
+{
+  std::set<uint64_t> chosen;
+  for(uint64_t j = n - k; j < n; ++j)
+    if (!chosen.insert(uniformIndex(rng,j + 1)).second)
+      chosen.insert(j);
+  result.assign(chosen.begin(),chosen.end());
+}
+
+// the pairs of the ascending pair indices
+static
+void
+appendPairs(size_t vc, const std::vector<uint64_t>& indices,
+            GenRandom::EdgeList& edges)
+{
+  size_t i = 0;
+  uint64_t rowStart = 0;
+  for(size_t k = 0; k < indices.size(); ++k)
+  {
+    while (indices[k] >= rowStart + (vc - 1 - i))
+    {
+      rowStart += vc - 1 - i;
+      ++i;
+    }
+    edges.push_back(std::make_pair(i,size_t(i + 1 + (indices[k] - rowStart))));
+  }
+}
+
+// the tree of a random Pruefer code
+static
+void
+randomTree(gsl_rng* rng, size_t vc, GenRandom::EdgeList& edges)
+{
+  if (vc < 2)
+    return;
+  std::vector<size_t> code(vc - 2);
+  std::vector<size_t> degree(vc,1);
+  for(size_t k = 0; k < code.size(); ++k)
+  {
+    code[k] = gsl_rng_uniform_int(rng,vc);
+    degree[code[k]]++;
+  }
+  std::priority_queue<size_t,std::vector<size_t>,std::greater<size_t> > leaves;
+  for(size_t v = 0; v < vc; ++v)
+    if (degree[v] == 1)
+      leaves.push(v);
+  for(size_t k = 0; k < code.size(); ++k)
+  {
+    size_t leaf = leaves.top();
+    leaves.pop();
+    edges.push_back(std::make_pair(std::min(leaf,code[k]),
+                                   std::max(leaf,code[k])));
+    if (--degree[code[k]] == 1)
+      leaves.push(code[k]);
+  }
+  size_t u = leaves.top();
+  leaves.pop();
+  edges.push_back(std::make_pair(u,leaves.top()));
+}
+
+// Batagelj-Brandes: w runs over the columns of row v of the lower
+// triangle, skipping a geometrically distributed number of pairs
+static
+void
+binomialEdges(gsl_rng* rng, size_t vc, double p, GenRandom::EdgeList& edges)
+{
+  if (p <= 0 || vc < 2)
+    return;
+  const double logq = std::log(1.0 - p);
+  const double pairs = 0.5*double(vc)*double(vc - 1);
+  size_t v = 1;
+  double w = -1;
+  while (v < vc)
+  {
+    double skip = 0;
+    if (p < 1)
+      skip = std::floor(std::log(1.0 - gsl_rng_uniform(rng))/logq);
+    w += 1 + std::min(skip,pairs);
+    while (w >= v && v < vc)
+    {
+      w -= v;
+      ++v;
+    }
+    if (v < vc)
+      edges.push_back(std::make_pair(size_t(w),v));
+  }
+}
+
+static
+size_t
+findRoot(std::vector<size_t>& parent, size_t v)
+{
+  while (parent[v] != v)
+  {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+static
+bool
+isConnected(size_t vc, const GenRandom::EdgeList& edges)
+{
+  std::vector<size_t> parent(vc);
+  for(size_t v = 0; v < vc; ++v)
+    parent[v] = v;
+  size_t components = vc;
+  for(size_t k = 0; k < edges.size(); ++k)
+  {
+    size_t a = findRoot(parent,edges[k].first);
+    size_t b = findRoot(parent,edges[k].second);
+    if (a != b)
+    {
+      parent[a] = b;
+      --components;
+    }
+  }
+  return components <= 1;
+}
+
+uint64_t
+GenRandom::pairIndex(size_t vc, size_t i, size_t j)
+{
+  if (j < i)
+    std::swap(i,j);
+  return uint64_t(i)*vc - uint64_t(i)*(i + 1)/2 + (j - i - 1);
+}
+
+AdjMatrix
+GenRandom::fromEdges(size_t vc, const EdgeList& edges)
+{
+  AdjMatrix g(Universe::singleton().createVector(vc));
+  std::vector<Object> edgeObjects =
+    Universe::singleton().createVector(edges.size());
+  for(size_t k = 0; k < edges.size(); ++k)
+    g.edge(edges[k].first,edges[k].second,edgeObjects[k]);
+  return g;
+}
+
+void
+GenRandom::operator()(const InputParams& input, EdgeList& edges)
+{
+  const size_t vc = input.inp_VertexCount;
+  const uint64_t pairs = uint64_t(vc)*(vc > 0 ? vc - 1 : 0)/2;
+  const size_t ec = input.inp_EdgeCount;
+  if (input.inp_Model != GNP && ec > pairs)
+    throw std::logic_error("Number of edges is too high");
+  if (input.inp_Model == SPANNING_TREE && vc > 0 && ec < vc-1)
+    throw std::logic_error("Number of edges is too low to generate a connected graph");
+  if (input.inp_Model == GNP &&
+      !(input.inp_Probability >= 0 && input.inp_Probability <= 1))
+    throw std::logic_error("Probability is out of [0,1]");
+
+  gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
+  REQUIRE(rng != NULL);
+  gsl_rng_set(rng, (input.inp_Seed != 0) ?
+              input.inp_Seed : (unsigned long int) time(NULL));
+
+  try
+  {
+    edges.clear();
+    std::vector<uint64_t> indices;
+    if (input.inp_Model == GNM)
+    {
+      sampleIndices(rng,pairs,ec,indices);
+      appendPairs(vc,indices,edges);
+    }
+    else if (input.inp_Model == GNP)
+      binomialEdges(rng,vc,input.inp_Probability,edges);
+    else
+    {
+      randomTree(rng,vc,edges);
+      checkAborted();
+      // the extra edges are numbered among the non-tree pairs only, and
+      // shifted past the tree ones below them
+      std::vector<uint64_t> tree(edges.size());
+      for(size_t k = 0; k < edges.size(); ++k)
+        tree[k] = pairIndex(vc,edges[k].first,edges[k].second);
+      std::sort(tree.begin(),tree.end());
+      sampleIndices(rng,pairs - tree.size(),ec - tree.size(),indices);
+      size_t below = 0;
+      for(size_t k = 0; k < indices.size(); ++k)
+      {
+        while (below < tree.size() && tree[below] <= indices[k] + below)
+          ++below;
+        indices[k] += below;
+      }
+      appendPairs(vc,indices,edges);
+    }
+  }
+  catch(...)
+  {
+    gsl_rng_free(rng);
+    throw;
+  }
+
+  gsl_rng_free(rng);
+}
+
+AdjMatrix
+GenRandom::operator()(const InputParams& input)
+{
+  logStream() << "\nGenRandom started\n";
+  logStream() << "size = " << input.inp_VertexCount << "\n";
+  flushLogStreams();
+
+  EdgeList edges;
+  operator()(input,edges);
+  checkAborted();
+  AdjMatrix g = fromEdges(input.inp_VertexCount,edges);
+
+  logStream() << "Edges: " << edges.size() << "\n";
+  logStream() << "GenRandom finished\n";
+  flushLogStreams();
+
+  return g;
+}
+
 AdjMatrix
 GenRandom::operator()(size_t vc, size_t ec, bool connected_only)
 {
@@ -44,51 +284,42 @@ GenRandom::operator()(size_t vc, size_t ec, bool connected_only)
   gsl_rng *rng = gsl_rng_alloc(gsl_rng_ranlxd2);
   REQUIRE(rng != NULL);
   gsl_rng_set(rng, (unsigned long int) time(NULL));
-  REQUIRE(gsl_rng_min(rng) == 0);
-  REQUIRE(gsl_rng_max(rng) > 1000);
-
-  AdjMatrix g;
-
-  bool connected = true;
 
-  do{
-    connected = true;
-
-    g.clear();
-    for(size_t i = 0; i < vc; ++i)
+  // the samples are checked as edge lists, only the accepted one is
+  // built
+  EdgeList edges;
+  std::vector<uint64_t> indices;
+  size_t samples = 0;
+  try
+  {
+    do
     {
       checkAborted();
-      g += grctk::Universe::singleton().create();
-    }
-    logStream() << "Trying to generate a random graph ...\n";
-    flushLogStreams();
+      edges.clear();
+      sampleIndices(rng,uint64_t(vc)*(vc-1)/2,ec,indices);
+      appendPairs(vc,indices,edges);
+      ++samples;
+    } while (connected_only && !isConnected(vc,edges));
+  }
+  catch(...)
+  {
+    gsl_rng_free(rng);
+    throw;
+  }
 
-    size_t ecount = 0;
-    while (ecount < ec)
-    {
-      size_t j = gsl_rng_uniform_int(rng,vc);
-      size_t i = gsl_rng_uniform_int(rng,vc);
-      if (j!=i && !g.edge(j,i))
-      {
-        checkAborted();
-        g.edge(j,i,Universe::singleton().create());
-        ecount++;
-      }
-    }
+  gsl_rng_free(rng);
 
-    ConComp conComp;
-    size_t c = 0;
-    conComp(g,0,c);
-    if (c != 1)
-      connected = false;
+  if (samples > 1)
+  {
+    logStream() << "Samples drawn: " << samples << "\n";
+    flushLogStreams();
+  }
 
-  }while ((connected_only)?(!connected):false);
+  AdjMatrix g = fromEdges(vc,edges);
 
   logStream() << "GenRandom finished\n";
   flushLogStreams();
 
-  gsl_rng_free(rng);
-
   return g;
 }
 
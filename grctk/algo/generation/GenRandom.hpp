@@ -25,13 +25,65 @@
 
 #include "grctk/algo/AlgBase.hpp"
 #include "grctk/AdjMatrix.hpp"
+#include <vector>
+#include <utility>
+#include <stdint.h>
 
 namespace grctk
 {
 
+/*
+  Random graphs, sampled without rejection:
+  GNM - uniform over the graphs with inp_EdgeCount edges: the edges are
+        inp_EdgeCount distinct pair indices drawn by Floyd's algorithm;
+  GNP - every pair with probability inp_Probability, the gaps between
+        the taken pairs drawn from the geometric distribution
+        (Batagelj-Brandes), O(n + m);
+  SPANNING_TREE - connected: a uniform random labelled tree (a random
+        Pruefer code) plus inp_EdgeCount-(n-1) of the other pairs drawn
+        as in GNM. Unlike the connected GNM samples this is not uniform
+        over the connected graphs, trees are favoured, but it needs no
+        retries however sparse the graph is.
+  The graphs are built in one batch from the edge lists.
+*/
 class GenRandom : public AlgBase
 {
 public:
+  enum Model {GNM, GNP, SPANNING_TREE};
+  struct InputParams
+  {
+    const Model inp_Model;
+    const size_t inp_VertexCount;
+    // GNM and SPANNING_TREE
+    const size_t inp_EdgeCount;
+    // GNP
+    const double inp_Probability;
+    // 0 takes the seed from the clock
+    const unsigned long inp_Seed;
+    InputParams(
+      const Model inp_Model_def = GNM,
+      const size_t inp_VertexCount_def = 5,
+      const size_t inp_EdgeCount_def = 4,
+      const double inp_Probability_def = 0.5,
+      const unsigned long inp_Seed_def = 0) :
+      inp_Model(inp_Model_def),
+      inp_VertexCount(inp_VertexCount_def),
+      inp_EdgeCount(inp_EdgeCount_def),
+      inp_Probability(inp_Probability_def),
+      inp_Seed(inp_Seed_def)
+      {
+      }
+  };
+  typedef std::vector<std::pair<size_t,size_t> > EdgeList;
+  // the pairs i < j numbered row by row: (0,1), (0,2), ..., (1,2), ...
+  static uint64_t pairIndex(size_t vc, size_t i, size_t j);
+  static AdjMatrix fromEdges(size_t vc, const EdgeList& edges);
+  // the edges (i < j) of a sample, without building the graph
+  void operator()(const InputParams& input, EdgeList& edges);
+  AdjMatrix operator()(const InputParams& input);
+  // GNM; connected_only draws GNM samples until one is connected, which
+  // keeps the distribution uniform over the connected graphs but may
+  // take many samples for sparse ones (see SPANNING_TREE)
   AdjMatrix operator()(size_t vc, size_t ec, bool connected_only = false);
   GenRandom(Log& setlog = nullLog): AlgBase(setlog) {}
 };
@@ -0,0 +1,90 @@
+/*
+  The AutomorphismOrbits class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AutomorphismOrbits.hpp"
+
+namespace grctk
+{
+
+AutomorphismOrbits::AutomorphismOrbits(const AdjMatrix& graph):
+  g(graph),
+  edgeIndex(graph.size()),
+  vertexParent(graph.size()),
+  edgeParent()
+{
+  const size_t VC = g.size();
+  for(size_t i = 0; i < VC; i++)
+  {
+    vertexParent[i] = i;
+    for(size_t j = i+1; j < VC; j++)
+      if (g.s(i,j))
+      {
+        edgeIndex(i,j) = edgeParent.size();
+        edgeParent.push_back(edgeParent.size());
+      }
+  }
+}
+
+size_t
+AutomorphismOrbits::find(std::vector<size_t>& parent, size_t i)
+{
+  size_t root = i;
+  while (parent[root] != root)
+    root = parent[root];
+  while (parent[i] != root)
+  {
+    size_t next = parent[i];
+    parent[i] = root;
+    i = next;
+  }
+  return root;
+}
+
+void
+AutomorphismOrbits::unite(std::vector<size_t>& parent, size_t i, size_t j)
+{
+  i = find(parent,i);
+  j = find(parent,j);
+  // the smaller index becomes the root, it is also the orbit mark
+  if (i < j)
+    parent[j] = i;
+  else if (j < i)
+    parent[i] = j;
+}
+
+void
+AutomorphismOrbits::vertexOrbits(Attribute<int>& aOrbit)
+{
+  for(size_t i = 0; i < g.size(); i++)
+    aOrbit[g[i]] = find(vertexParent,i)+1;
+}
+
+void
+AutomorphismOrbits::edgeOrbits(Attribute<int>& aEdgeOrbit)
+{
+  const size_t VC = g.size();
+  for(size_t i = 0; i < VC; i++)
+    for(size_t j = i+1; j < VC; j++)
+      if (g.s(i,j))
+        aEdgeOrbit[g(i,j)] = find(edgeParent,edgeIndex(i,j))+1;
+}
+
+} //namespace grctk
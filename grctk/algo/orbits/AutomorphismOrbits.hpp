@@ -0,0 +1,75 @@
+/*
+  The AutomorphismOrbits class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_AutomorphismOrbits_hpp
+#define grctk_AutomorphismOrbits_hpp
+
+#include "grctk/AdjMatrix.hpp"
+#include <yaatk/SquareMatrix.hpp>
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Collects the automorphisms found by an orbit search and merges the
+  vertices and the edges they map onto each other (union-find), so both
+  vertex and edge orbits come out of one pass without a line graph.
+
+  An orbit is marked with the index of its first member plus one:
+  vertices are numbered as in the graph, edges in the order of (i,j),
+  i < j.
+*/
+class AutomorphismOrbits
+{
+  const AdjMatrix& g;
+  yaatk::TriangularSquareMatrix<size_t> edgeIndex;
+  std::vector<size_t> vertexParent;
+  std::vector<size_t> edgeParent;
+  static size_t find(std::vector<size_t>& parent, size_t i);
+  static void unite(std::vector<size_t>& parent, size_t i, size_t j);
+public:
+  AutomorphismOrbits(const AdjMatrix& graph);
+  size_t edgeCount() const { return edgeParent.size(); }
+  // p[i] is the image of vertex i, p must be an automorphism of g
+  template <typename Perm>
+  void addAutomorphism(const Perm& p);
+  void vertexOrbits(Attribute<int>& aOrbit);
+  void edgeOrbits(Attribute<int>& aEdgeOrbit);
+};
+
+template <typename Perm>
+void
+AutomorphismOrbits::addAutomorphism(const Perm& p)
+{
+  const size_t VC = g.size();
+  for(size_t i = 0; i < VC; i++)
+  {
+    unite(vertexParent,i,p[i]);
+    for(size_t j = i+1; j < VC; j++)
+      if (g.s(i,j))
+        unite(edgeParent,edgeIndex(i,j),edgeIndex(p[i],p[j]));
+  }
+}
+
+} //namespace grctk
+
+#endif
@@ -21,6 +21,8 @@
 */
 
 #include "FindOrbitsEdgeTensions.hpp"
+#include "grctk/algo/attrconv/ValueRanking.hpp"
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -28,7 +30,7 @@ namespace grctk
 {
 
 void
-FindOrbitsEdgeTensions::f(size_t A, size_t b, yaatk::LongInteger divider,
+FindOrbitsEdgeTensions::f(size_t A, size_t b, const yaatk::Rational& divider,
                           const AdjMatrix& g)
 {
   checkAborted();
@@ -40,12 +42,16 @@ FindOrbitsEdgeTensions::f(size_t A, size_t b, yaatk::LongInteger divider,
       vec.push_back(i);
   }
 
-  yaatk::LongInteger newDivider = divider*yaatk::LongInteger(vec.size());
+  if (vec.empty())
+    return;
+
+  yaatk::Rational newDivider = divider*yaatk::Rational(vec.size());
+  yaatk::Rational share = yaatk::Rational(1)/newDivider;
 
   for(size_t k = 0; k < vec.size();k++)
   {
     const grctk::Object& edge = g(vec[k],b);
-    eRational[edge] = eRational[edge] + yaatk::Rational(1,newDivider);
+    eRational[edge] = eRational[edge] + share;
     if (vec[k] != A)
       f(A,vec[k],newDivider, g);
   }
@@ -69,34 +75,31 @@ FindOrbitsEdgeTensions::vertexInvariants_Sum(
   }
 }
 
-template <typename edgeset>
 void
 FindOrbitsEdgeTensions::vertexInvariants_Set(
-  const AdjMatrix& gr, Attribute<yaatk::Rational>& aOrbit)
+  const AdjMatrix& gr, Attribute<yaatk::Rational>& aOrbit, bool distinctOnly)
 {
   checkAborted();
 
-  std::vector<edgeset> setList;
-  std::set<edgeset> s;
+  // sorted vectors compare exactly like the std::multiset / std::set
+  std::vector<std::vector<yaatk::Rational> > setList(gr.size());
 
   for(size_t i = 0; i < gr.size(); i++)
   {
-    edgeset sum;
+    std::vector<yaatk::Rational>& sum = setList[i];
     for(size_t j = 0; j < gr.size(); j++)
       if (gr.s(i,j))
-        sum.insert(eRational[gr(i,j)]);
-    setList.push_back(sum);
-    s.insert(sum);
+        sum.push_back(eRational[gr(i,j)]);
+    std::sort(sum.begin(), sum.end());
+    if (distinctOnly)
+      sum.erase(std::unique(sum.begin(), sum.end()), sum.end());
   }
 
-  size_t index = 1;
-  for(typename std::set<edgeset>::iterator it = s.begin(); it != s.end(); it++)
-  {
-    for(size_t i = 0; i < gr.size(); i++)
-      if (setList[i] == *it)
-        aOrbit[gr[i]] = yaatk::LongInteger(index);
-    index++;
-  }
+  std::vector<size_t> ranks;
+  rankValues(setList, ranks);
+
+  for(size_t i = 0; i < gr.size(); i++)
+    aOrbit[gr[i]] = yaatk::LongInteger(ranks[i] + 1);
 }
 
 void
@@ -142,12 +145,12 @@ FindOrbitsEdgeTensions::operator()(const AdjMatrix &g,
     logStream() << "Processing from vertex " << i << "\n" ;
     flushLogStreams();
     for(size_t j = 0/*i+1*/; j < VC; j++)
-      f(i,j,1,g);
+      f(i,j,yaatk::Rational(1),g);
   }
 
   // vertexInvariants_Sum(g,aOrbit);
-  // vertexInvariants_Set<std::set<yaatk::Rational> >(g,aOrbit);
-  vertexInvariants_Set<std::multiset<yaatk::Rational> >(g,aOrbit);
+  // vertexInvariants_Set(g,aOrbit,true);
+  vertexInvariants_Set(g,aOrbit);
 
   logStream() << "FindOrbitsEdgeTensions finished\n" ;
   flushLogStreams();
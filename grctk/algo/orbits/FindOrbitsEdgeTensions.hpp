@@ -36,10 +36,10 @@ class FindOrbitsEdgeTensions : public AlgBase
 {
   yaatk::TriangularSquareMatrix<yaatk::LongInteger> eW;
   Attribute<yaatk::Rational> eRational;
-  void f(size_t b, size_t A, yaatk::LongInteger divider, const AdjMatrix&);
+  void f(size_t b, size_t A, const yaatk::Rational& divider, const AdjMatrix&);
   void vertexInvariants_Sum(const AdjMatrix&, Attribute<yaatk::Rational>& aOrbit);
-  template <typename edgeset>
-  void vertexInvariants_Set(const AdjMatrix&, Attribute<yaatk::Rational>& aOrbit);
+  void vertexInvariants_Set(const AdjMatrix&, Attribute<yaatk::Rational>& aOrbit,
+                            bool distinctOnly = false);
 public:
   void operator()(const AdjMatrix &g, Attribute<yaatk::Rational>& aOrbit);
   FindOrbitsEdgeTensions(Log& setlog = nullLog):
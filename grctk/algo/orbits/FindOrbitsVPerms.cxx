@@ -27,14 +27,10 @@ namespace grctk
 {
 
 void
-FindOrbitsVPerms::operator()(const AdjMatrix &g, Attribute<int>& aOrbit)
+FindOrbitsVPerms::findAutomorphisms(const AdjMatrix &g,
+                                    AutomorphismOrbits& orbits)
 {
-  logStream() << "\nFindOrbitsVPerms started\n";
-  flushLogStreams();
-
-  std::vector<std::set<size_t> > orbits;
   size_t i,k,VC = g.vertexCount();
-  orbits.resize(VC);
 
   yaatk::Permutation j(VC);
   j.gen_first();
@@ -51,17 +47,39 @@ FindOrbitsVPerms::operator()(const AdjMatrix &g, Attribute<int>& aOrbit)
           am = false;
 
     if (am)
-      for(i = 0;i<VC;i++)
-        orbits[i].insert(j[i]);
+      orbits.addAutomorphism(j);
 
     checkAborted();
 
     if (!(j.gen_next())) break;
   } while (1);
+}
+
+void
+FindOrbitsVPerms::operator()(const AdjMatrix &g, Attribute<int>& aOrbit)
+{
+  logStream() << "\nFindOrbitsVPerms started\n";
+  flushLogStreams();
+
+  AutomorphismOrbits orbits(g);
+  findAutomorphisms(g,orbits);
+  orbits.vertexOrbits(aOrbit);
+
+  logStream() << "FindOrbitsVPerms finished\n" ;
+  flushLogStreams();
+}
+
+void
+FindOrbitsVPerms::operator()(const AdjMatrix &g, Attribute<int>& aOrbit,
+                             Attribute<int>& aEdgeOrbit)
+{
+  logStream() << "\nFindOrbitsVPerms started\n";
+  flushLogStreams();
 
-  for(int i = VC-1; i >=0; i--)
-    for(std::set<size_t>::iterator k=orbits[i].begin();k!=orbits[i].end();k++)
-      aOrbit[g[*k]] = i+1;
+  AutomorphismOrbits orbits(g);
+  findAutomorphisms(g,orbits);
+  orbits.vertexOrbits(aOrbit);
+  orbits.edgeOrbits(aEdgeOrbit);
 
   logStream() << "FindOrbitsVPerms finished\n" ;
   flushLogStreams();
@@ -25,14 +25,19 @@
 
 #include "grctk/algo/AlgBase.hpp"
 #include "grctk/AdjMatrix.hpp"
+#include "AutomorphismOrbits.hpp"
 
 namespace grctk
 {
 
 class FindOrbitsVPerms : public AlgBase
 {
+  void findAutomorphisms(const AdjMatrix &g, AutomorphismOrbits& orbits);
 public:
   void operator()(const AdjMatrix &g, Attribute<int>& aOrbit);
+  // edge orbits are derived from the same automorphisms
+  void operator()(const AdjMatrix &g, Attribute<int>& aOrbit,
+                  Attribute<int>& aEdgeOrbit);
   FindOrbitsVPerms(Log& setlog = nullLog): AlgBase(setlog) {}
 };
 
@@ -0,0 +1,58 @@
+/*
+  BinCode file pipeline stages.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BinCodeStages.hpp"
+
+namespace grctk
+{
+
+BinCodeFileSource::BinCodeFileSource(const std::string filename,
+                                     unsigned long begin,
+                                     unsigned long endIndex):
+  reader(filename),
+  next(begin),
+  end(endIndex)
+{
+  if (end > reader.numberOfGraphs())
+    end = reader.numberOfGraphs();
+}
+
+bool
+BinCodeFileSource::operator()(BinCode& code)
+{
+  if (next >= end)
+    return false;
+  code = reader.getCode(next++);
+  return true;
+}
+
+BinCodeFileSink::BinCodeFileSink(const std::string filename):
+  writer(filename)
+{
+}
+
+void
+BinCodeFileSink::operator()(const BinCode& code)
+{
+  writer.addCode(code);
+}
+
+} //namespace grctk
@@ -0,0 +1,61 @@
+/*
+  BinCode file pipeline stages (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_BinCodeStages_hpp
+#define grctk_BinCodeStages_hpp
+
+#include "Pipeline.hpp"
+#include "grctk/algo/formats/BinCode.hpp"
+#include "grctk/algo/formats/BinCodeFile.hpp"
+#include <string>
+
+namespace grctk
+{
+
+// yields the codes of graphs [begin, end) of a file, in file order
+class BinCodeFileSource : public PipelineSource<BinCode>
+{
+  BinCodeFileReader reader;
+  unsigned long next, end;
+public:
+  BinCodeFileSource(const std::string filename,
+                    unsigned long begin = 0,
+                    unsigned long endIndex = (unsigned long)(-1));
+  unsigned long numberOfGraphs() { return reader.numberOfGraphs(); }
+  virtual bool operator()(BinCode& code);
+};
+
+/*
+  Appends the codes to a file; with an ordered sink stage (the default)
+  the graphs come out in the order of the source.
+*/
+class BinCodeFileSink : public PipelineSink<BinCode>
+{
+  BinCodeFileWriter writer;
+public:
+  BinCodeFileSink(const std::string filename);
+  unsigned long numberOfGraphs() { return writer.numberOfGraphs(); }
+  virtual void operator()(const BinCode& code);
+};
+
+} //namespace grctk
+
+#endif
@@ -0,0 +1,155 @@
+/*
+  The Pipeline class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Pipeline.hpp"
+#include "grctk/Universe.hpp"
+#include "grctk/algo/AlgBase.hpp"
+#include "zthread/Thread.h"
+#include "zthread/Runnable.h"
+#include "zthread/Guard.h"
+#include <stdexcept>
+
+namespace grctk
+{
+
+void
+PipelineControl::abort(const std::string& reason)
+{
+  ZThread::Guard<ZThread::FastMutex> guard(messageLock);
+  if (!stopped.load())
+    message = reason;
+  stopped.store(true);
+}
+
+std::string
+PipelineControl::reason()
+{
+  ZThread::Guard<ZThread::FastMutex> guard(messageLock);
+  return message;
+}
+
+bool
+PipelineControl::waitForCredit(unsigned long seq)
+{
+  size_t attempt = 0;
+  while (window > 0 &&
+         seq >= released.load(std::memory_order_acquire) + window)
+  {
+    if (aborted())
+      return false;
+    backoff(attempt);
+  }
+  return true;
+}
+
+void
+PipelineControl::backoff(size_t& attempt)
+{
+  attempt++;
+  if (attempt < 64)
+    return;
+  if (attempt < 1024)
+    ZThread::Thread::yield();
+  else
+    ZThread::Thread::sleep(1);
+}
+
+class PipelineWorker : public ZThread::Runnable
+{
+  PipelineStage& stage;
+  PipelineControl& control;
+public:
+  PipelineWorker(PipelineStage& s, PipelineControl& c):
+    stage(s),control(c) {}
+  virtual void run()
+    {
+      try
+      {
+        Universe universe;
+        UniverseScope scope(universe);
+        stage.work();
+      }
+      catch(std::exception& e)
+      {
+        control.abort(e.what());
+      }
+      catch(AbortAlgException& e)
+      {
+        control.abort(e.what());
+      }
+      catch(...)
+      {
+        control.abort("Unknown exception");
+      }
+      stage.workerFinished();
+    }
+};
+
+Pipeline::Pipeline(size_t queueCapacity):
+  control(),
+  stages(),
+  channels(),
+  hasSink(false),
+  defaultCapacity(queueCapacity)
+{
+}
+
+Pipeline::~Pipeline()
+{
+  for(size_t i = 0; i < stages.size(); ++i)
+    delete stages[i];
+  for(size_t i = 0; i < channels.size(); ++i)
+    delete channels[i];
+}
+
+size_t
+Pipeline::inFlightLimit() const
+{
+  size_t limit = 0;
+  for(size_t i = 0; i < channels.size(); ++i)
+    limit += channels[i]->capacity();
+  for(size_t s = 0; s < stages.size(); ++s)
+    limit += stages[s]->workerCount();
+  return limit;
+}
+
+void
+Pipeline::run()
+{
+  REQUIRE(hasSink);
+
+  std::vector<ZThread::Thread*> threads;
+  for(size_t s = 0; s < stages.size(); ++s)
+    for(size_t w = 0; w < stages[s]->workerCount(); ++w)
+      threads.push_back(new ZThread::Thread(
+                          ZThread::Task(new PipelineWorker(*stages[s],control))));
+
+  for(size_t t = 0; t < threads.size(); ++t)
+  {
+    threads[t]->wait();
+    delete threads[t];
+  }
+
+  if (control.aborted())
+    throw std::runtime_error("Pipeline: " + control.reason());
+}
+
+} //namespace grctk
@@ -0,0 +1,382 @@
+/*
+  The Pipeline class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_Pipeline_hpp
+#define grctk_Pipeline_hpp
+
+#include <yaatk/yaatk.hpp>
+#include <yaatk/BoundedQueue.hpp>
+#include "zthread/FastMutex.h"
+#include <atomic>
+#include <vector>
+#include <string>
+
+namespace grctk
+{
+
+/*
+  In-process streaming pipeline: a source, any number of map and filter
+  stages and a sink, connected by bounded lock-free queues. Every stage
+  runs in its own worker threads, so reading, decoding and computation
+  overlap.
+
+    Pipeline p;
+    PipelineChannel<BinCode>& codes = p.source(reader);
+    PipelineChannel<BinCode>& failed = p.filter(codes, Check(), 4);
+    p.sink(failed, writer);
+    p.run();
+
+  Items are numbered by the source. Map and filter workers may finish
+  them out of order, a dropped item travels on as an empty slot, and an
+  ordered sink restores the source order. The source then waits while it
+  is reorderWindow() items ahead of the sink, so the items parked by the
+  sink never outnumber the queue slots and workers.
+
+  Each worker thread runs with a Universe of its own (see UniverseScope),
+  so items must not contain Objects: graphs are passed as BinCode.
+  Map and filter workers use their own copies of the given functor,
+  made in the worker thread; members tied to a Universe (attributes,
+  graphs, algorithms holding attributes) should be created inside
+  operator() rather than copied.
+
+  The first exception thrown by a stage stops the whole pipeline and is
+  rethrown from run() as std::runtime_error.
+*/
+
+template <typename Out>
+class PipelineSource
+{
+public:
+  // false when exhausted
+  virtual bool operator()(Out& item) = 0;
+  virtual ~PipelineSource() {}
+};
+
+template <typename In>
+class PipelineSink
+{
+public:
+  virtual void operator()(const In& item) = 0;
+  virtual ~PipelineSink() {}
+};
+
+template <typename T>
+struct PipelineItem
+{
+  unsigned long seq;
+  bool valid;
+  T value;
+  PipelineItem():seq(0),valid(false),value() {}
+};
+
+class PipelineControl
+{
+  std::atomic<bool> stopped;
+  std::string message;
+  ZThread::FastMutex messageLock;
+  std::atomic<unsigned long> released;
+  size_t window;
+public:
+  PipelineControl():stopped(false),message(),messageLock(),released(0),window(0) {}
+  bool aborted() const { return stopped.load(std::memory_order_relaxed); }
+  void abort(const std::string& reason);
+  std::string reason();
+  // 0, the default, lets the source run ahead of the sink freely
+  void setReorderWindow(size_t size) { window = size; }
+  size_t reorderWindow() const { return window; }
+  // waits until item seq is within the window; false if aborted
+  bool waitForCredit(unsigned long seq);
+  // the sink has written all the items before next
+  void consumed(unsigned long next)
+    {
+      released.store(next, std::memory_order_release);
+    }
+  // spins, then yields, then sleeps: the queues have nothing to block on
+  static void backoff(size_t& attempt);
+};
+
+class PipelineChannelBase
+{
+public:
+  virtual size_t capacity() const = 0;
+  virtual ~PipelineChannelBase() {}
+};
+
+template <typename T>
+class PipelineChannel : public PipelineChannelBase
+{
+  yaatk::BoundedQueue<PipelineItem<T> > queue;
+  std::atomic<size_t> activeProducers;
+  PipelineControl& control;
+public:
+  PipelineChannel(size_t capacity, size_t producers, PipelineControl& ctl):
+    queue(capacity),activeProducers(producers),control(ctl) {}
+  virtual size_t capacity() const { return queue.capacity(); }
+  // false if the pipeline was aborted
+  bool push(const PipelineItem<T>& item)
+    {
+      size_t attempt = 0;
+      while (!queue.tryPush(item))
+      {
+        if (control.aborted())
+          return false;
+        PipelineControl::backoff(attempt);
+      }
+      return true;
+    }
+  // false when all producers are done and the queue is drained
+  bool pop(PipelineItem<T>& item)
+    {
+      size_t attempt = 0;
+      while (!queue.tryPop(item))
+      {
+        if (control.aborted())
+          return false;
+        if (activeProducers.load(std::memory_order_acquire) == 0)
+          return queue.tryPop(item);
+        PipelineControl::backoff(attempt);
+      }
+      return true;
+    }
+  void producerFinished()
+    {
+      activeProducers.fetch_sub(1, std::memory_order_release);
+    }
+};
+
+class PipelineStage
+{
+public:
+  virtual size_t workerCount() const = 0;
+  // runs in a worker thread
+  virtual void work() = 0;
+  virtual void workerFinished() = 0;
+  virtual ~PipelineStage() {}
+};
+
+template <typename Out>
+class PipelineSourceStage : public PipelineStage
+{
+  PipelineSource<Out>& source;
+  PipelineChannel<Out>& output;
+  PipelineControl& control;
+public:
+  PipelineSourceStage(PipelineSource<Out>& src, PipelineChannel<Out>& out,
+                      PipelineControl& ctl):
+    source(src),output(out),control(ctl) {}
+  virtual size_t workerCount() const { return 1; }
+  virtual void work()
+    {
+      PipelineItem<Out> item;
+      item.valid = true;
+      while (source(item.value))
+      {
+        if (!control.waitForCredit(item.seq) || !output.push(item))
+          return;
+        item.seq++;
+      }
+    }
+  virtual void workerFinished() { output.producerFinished(); }
+};
+
+template <typename In, typename Out, typename Map>
+class PipelineMapStage : public PipelineStage
+{
+  PipelineChannel<In>& input;
+  PipelineChannel<Out>& output;
+  const Map prototype;
+  size_t workers;
+public:
+  PipelineMapStage(PipelineChannel<In>& in, PipelineChannel<Out>& out,
+                   const Map& map, size_t workerCount):
+    input(in),output(out),prototype(map),workers(workerCount) {}
+  virtual size_t workerCount() const { return workers; }
+  virtual void work()
+    {
+      Map map(prototype);
+      PipelineItem<In> item;
+      while (input.pop(item))
+      {
+        PipelineItem<Out> result;
+        result.seq = item.seq;
+        result.valid = item.valid && map(item.value,result.value);
+        if (!output.push(result))
+          return;
+      }
+    }
+  virtual void workerFinished() { output.producerFinished(); }
+};
+
+template <typename T, typename Filter>
+class PipelineFilterStage : public PipelineStage
+{
+  PipelineChannel<T>& input;
+  PipelineChannel<T>& output;
+  const Filter prototype;
+  size_t workers;
+public:
+  PipelineFilterStage(PipelineChannel<T>& in, PipelineChannel<T>& out,
+                      const Filter& filter, size_t workerCount):
+    input(in),output(out),prototype(filter),workers(workerCount) {}
+  virtual size_t workerCount() const { return workers; }
+  virtual void work()
+    {
+      Filter filter(prototype);
+      PipelineItem<T> item;
+      while (input.pop(item))
+      {
+        if (item.valid && !filter(item.value))
+        {
+          item.valid = false;
+          item.value = T();
+        }
+        if (!output.push(item))
+          return;
+      }
+    }
+  virtual void workerFinished() { output.producerFinished(); }
+};
+
+template <typename In>
+class PipelineSinkStage : public PipelineStage
+{
+  PipelineChannel<In>& input;
+  PipelineSink<In>& sink;
+  PipelineControl& control;
+  bool ordered;
+public:
+  PipelineSinkStage(PipelineChannel<In>& in, PipelineSink<In>& snk,
+                    PipelineControl& ctl, bool keepOrder):
+    input(in),sink(snk),control(ctl),ordered(keepOrder) {}
+  virtual size_t workerCount() const { return 1; }
+  virtual void work()
+    {
+      PipelineItem<In> item;
+      if (!ordered)
+      {
+        while (input.pop(item))
+          if (item.valid)
+            sink(item.value);
+        return;
+      }
+      // items that overtook the next expected one, at seq % window;
+      // the source keeps every item in flight within the window
+      const size_t window = control.reorderWindow();
+      REQUIRE(window > 0);
+      std::vector<PipelineItem<In> > parked(window);
+      std::vector<bool> isParked(window,false);
+      unsigned long next = 0;
+      while (input.pop(item))
+      {
+        REQUIRE(item.seq >= next && item.seq - next < window);
+        parked[item.seq % window] = item;
+        isParked[item.seq % window] = true;
+        size_t slot;
+        while (isParked[slot = next % window])
+        {
+          if (parked[slot].valid)
+            sink(parked[slot].value);
+          parked[slot] = PipelineItem<In>();
+          isParked[slot] = false;
+          next++;
+        }
+        control.consumed(next);
+      }
+    }
+  virtual void workerFinished() {}
+};
+
+class Pipeline
+{
+  PipelineControl control;
+  std::vector<PipelineStage*> stages;
+  std::vector<PipelineChannelBase*> channels;
+  bool hasSink;
+  size_t defaultCapacity;
+
+  template <typename T>
+  PipelineChannel<T>& newChannel(size_t producers, size_t capacity)
+    {
+      PipelineChannel<T>* channel = new PipelineChannel<T>(
+        capacity ? capacity : defaultCapacity, producers, control);
+      channels.push_back(channel);
+      return *channel;
+    }
+
+  // queue slots and workers: every item in flight sits in one of them
+  size_t inFlightLimit() const;
+
+  Pipeline(const Pipeline&);
+  Pipeline& operator=(const Pipeline&);
+public:
+  Pipeline(size_t queueCapacity = 256);
+  virtual ~Pipeline();
+
+  template <typename Out>
+  PipelineChannel<Out>& source(PipelineSource<Out>& src, size_t capacity = 0)
+    {
+      PipelineChannel<Out>& out = newChannel<Out>(1,capacity);
+      stages.push_back(new PipelineSourceStage<Out>(src,out,control));
+      return out;
+    }
+
+  // Map must provide bool operator()(const In&, Out&), false drops the item;
+  // Out is given explicitly: p.map<Out>(in, m, workers)
+  template <typename Out, typename In, typename Map>
+  PipelineChannel<Out>& map(PipelineChannel<In>& in, const Map& m,
+                            size_t workers = 1, size_t capacity = 0)
+    {
+      REQUIRE(workers > 0);
+      PipelineChannel<Out>& out = newChannel<Out>(workers,capacity);
+      stages.push_back(new PipelineMapStage<In,Out,Map>(in,out,m,workers));
+      return out;
+    }
+
+  // Filter must provide bool operator()(const T&), false drops the item
+  template <typename T, typename Filter>
+  PipelineChannel<T>& filter(PipelineChannel<T>& in, const Filter& f,
+                             size_t workers = 1, size_t capacity = 0)
+    {
+      REQUIRE(workers > 0);
+      PipelineChannel<T>& out = newChannel<T>(workers,capacity);
+      stages.push_back(new PipelineFilterStage<T,Filter>(in,out,f,workers));
+      return out;
+    }
+
+  template <typename In>
+  void sink(PipelineChannel<In>& in, PipelineSink<In>& snk, bool ordered = true)
+    {
+      REQUIRE(!hasSink);
+      stages.push_back(new PipelineSinkStage<In>(in,snk,control,ordered));
+      hasSink = true;
+      if (ordered)
+        control.setReorderWindow(inFlightLimit());
+    }
+
+  size_t reorderWindow() const { return control.reorderWindow(); }
+
+  // starts all workers and waits for them to finish
+  void run();
+};
+
+} //namespace grctk
+
+#endif
@@ -33,6 +33,7 @@ namespace grctk
 class LexicographicalProduct : public Product
 {
 public:
+  static const unsigned terms = SAME_G1_EDGE_G2 | EDGE_G1_ANY_G2;
   AdjMatrix operator()(const AdjMatrix&, const AdjMatrix&);
   AdjMatrix operator()(const AdjMatrix&, const AdjMatrix&,
                        Attribute<yaatk::Vector3D>& a3D);
@@ -21,7 +21,10 @@
 */
 
 #include "Product.hpp"
-#include "grctk/algo/drawing/tools.hpp"
+#include <stdint.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace grctk
 {
@@ -29,43 +32,176 @@ namespace grctk
 AdjMatrix
 Product::graphTemplate(const AdjMatrix& g1, const AdjMatrix& g2) const
 {
-  AdjMatrix g;
+  checkAborted();
 
+  std::vector<Object> sources;
+  sources.reserve(g1.size()*g2.size());
   for(size_t i = 0; i < g1.size(); ++i)
     for(size_t j = 0; j < g2.size(); ++j)
+      sources.push_back(g1[i]);
+
+  return AdjMatrix(Universe::singleton().cloneVector(sources));
+}
+
+AdjMatrix
+Product::build(const AdjMatrix& g1, const AdjMatrix& g2, unsigned terms) const
+{
+  AdjMatrix g = graphTemplate(g1,g2);
+
+  const size_t n1 = g1.size();
+  const size_t n2 = g2.size();
+  const size_t words = (n2 + 63)/64;
+
+  std::vector<uint64_t> rows2(n2*words,0);
+  for(size_t p = 0; p < n2; ++p)
+    for(size_t q = 0; q < n2; ++q)
+      if (g2.s(p,q))
+        rows2[p*words + q/64] |= uint64_t(1) << (q%64);
+  std::vector<uint64_t> all(words,~uint64_t(0));
+  if (n2 % 64 != 0)
+    all.back() = (uint64_t(1) << (n2 % 64)) - 1;
+
+  std::vector<std::pair<size_t,size_t> > edges;
+  std::vector<uint64_t> block(words);
+  for(size_t i = 0; i < n1; ++i)
+    for(size_t p = 0; p < n2; ++p)
     {
       checkAborted();
-      g += g1[i].clone();
+      const uint64_t* row2 = &rows2[p*words];
+      // the upper triangle only: the blocks j >= i, and q > p in the
+      // diagonal one
+      for(size_t j = i; j < n1; ++j)
+      {
+        if (j == i)
+        {
+          if (!(terms & SAME_G1_EDGE_G2))
+            continue;
+          for(size_t w = 0; w < words; ++w)
+            block[w] = (w < p/64) ? 0 : row2[w];
+          block[p/64] &= ~((uint64_t(2) << (p%64)) - 1);
+        }
+        else
+        {
+          if (!g1.s(i,j))
+            continue;
+          for(size_t w = 0; w < words; ++w)
+          {
+            block[w] = 0;
+            if (terms & EDGE_G1_EDGE_G2)
+              block[w] |= row2[w];
+            if (terms & EDGE_G1_ANY_G2)
+              block[w] |= all[w];
+          }
+          if (terms & EDGE_G1_SAME_G2)
+            block[p/64] |= uint64_t(1) << (p%64);
+        }
+        for(size_t w = 0; w < words; ++w)
+          for(uint64_t bits = block[w]; bits != 0; bits &= bits - 1)
+            edges.push_back(
+              std::make_pair(i*n2 + p,j*n2 + w*64 + __builtin_ctzll(bits)));
+      }
     }
 
+  std::vector<Object> edgeObjects =
+    Universe::singleton().createVector(edges.size());
+  for(size_t k = 0; k < edges.size(); ++k)
+    g.edge(edges[k].first,edges[k].second,edgeObjects[k]);
+
   return g;
 }
 
+// the bounding box extents of the positions
+static
+yaatk::Vector3D
+extents(const std::vector<yaatk::Vector3D>& positions)
+{
+  if (positions.empty())
+    return yaatk::Vector3D(0.0,0.0,0.0);
+  yaatk::Vector3D maxPos = positions[0];
+  yaatk::Vector3D minPos = positions[0];
+  for(size_t i = 0; i < positions.size(); ++i)
+  {
+    const yaatk::Vector3D& p = positions[i];
+    maxPos.x = std::max(maxPos.x,p.x);
+    minPos.x = std::min(minPos.x,p.x);
+    maxPos.y = std::max(maxPos.y,p.y);
+    minPos.y = std::min(minPos.y,p.y);
+    maxPos.z = std::max(maxPos.z,p.z);
+    minPos.z = std::min(minPos.z,p.z);
+  }
+  return maxPos - minPos;
+}
+
 void
-Product::positionVertices(AdjMatrix& g,
-                          const AdjMatrix& g1, const AdjMatrix& g2,
-                          Attribute<yaatk::Vector3D>& a3D) const
+Product::productPositions(const std::vector<yaatk::Vector3D>& positions1,
+                          const std::vector<yaatk::Vector3D>& positions2,
+                          std::vector<yaatk::Vector3D>& positions)
 {
-  yaatk::Vector3D g1dims = dimensions(g1,a3D);
-  yaatk::Vector3D g2dims = dimensions(g2,a3D);
+  const size_t n1 = positions1.size();
+  const size_t n2 = positions2.size();
+  positions.resize(n1*n2);
+  if (n1 == 0 || n2 == 0)
+    return;
+
+  yaatk::Vector3D g1dims = extents(positions1);
+  yaatk::Vector3D g2dims = extents(positions2);
+  double cx = 0, cy = 0;
+  for(size_t j = 0; j < n2; ++j)
+  {
+    cx += positions2[j].x;
+    cy += positions2[j].y;
+  }
+  cx /= n2;
+  cy /= n2;
 
   double dim12ratio = (g1dims.x/g2dims.x < g1dims.y/g2dims.y)?
     (g1dims.x/g2dims.x):(g1dims.y/g2dims.y);
 
-  for(size_t i = 0; i < g1.size(); ++i)
-    for(size_t j = 0; j < g2.size(); ++j)
+  // the shift of copy j, then plain contiguous sums
+  std::vector<double> dx(n2), dy(n2);
+  for(size_t j = 0; j < n2; ++j)
+  {
+    if (g2dims.x/g2dims.y > 1.0)
     {
-      if (g2dims.x/g2dims.y > 1.0)
-      {
-        a3D[g[i*g2.size() + j]].x -= 1.5*dimensions(g1,a3D).x*j;
-        a3D[g[i*g2.size() + j]].y -= 1.5*(a3D[g2[j]].y - massCenter(g2,a3D).y)*dim12ratio;
-      }
-      else
-      {
-        a3D[g[i*g2.size() + j]].x += 1.5*(a3D[g2[j]].x - massCenter(g2,a3D).x)*dim12ratio;
-        a3D[g[i*g2.size() + j]].y -= 1.5*dimensions(g1,a3D).y*j;
-      }
+      dx[j] = -1.5*g1dims.x*j;
+      dy[j] = -1.5*(positions2[j].y - cy)*dim12ratio;
+    }
+    else
+    {
+      dx[j] = 1.5*(positions2[j].x - cx)*dim12ratio;
+      dy[j] = -1.5*g1dims.y*j;
+    }
+  }
+  for(size_t i = 0; i < n1; ++i)
+  {
+    const double x = positions1[i].x;
+    const double y = positions1[i].y;
+    const double z = positions1[i].z;
+    yaatk::Vector3D* row = &positions[i*n2];
+    for(size_t j = 0; j < n2; ++j)
+    {
+      row[j].x = x + dx[j];
+      row[j].y = y + dy[j];
+      row[j].z = z;
     }
+  }
+}
+
+void
+Product::positionVertices(AdjMatrix& g,
+                          const AdjMatrix& g1, const AdjMatrix& g2,
+                          Attribute<yaatk::Vector3D>& a3D) const
+{
+  std::vector<yaatk::Vector3D> positions1(g1.size()), positions2(g2.size());
+  for(size_t i = 0; i < g1.size(); ++i)
+    positions1[i] = a3D[g1[i]];
+  for(size_t j = 0; j < g2.size(); ++j)
+    positions2[j] = a3D[g2[j]];
+
+  std::vector<yaatk::Vector3D> positions;
+  productPositions(positions1,positions2,positions);
+  for(size_t k = 0; k < positions.size(); ++k)
+    a3D[g[k]] = positions[k];
 }
 
 } //namespace grctk
@@ -27,18 +27,42 @@
 #include "grctk/AdjMatrix.hpp"
 #include "grctk/Universe.hpp"
 #include <yaatk/Vector3D.hpp>
+#include <vector>
 
 namespace grctk
 {
 
 class Product : public AlgBase
 {
+public:
+  // the products are unions of these terms, vertex (i,p) of the product
+  // being adjacent to (j,q) if
+  enum Term
+  {
+    SAME_G1_EDGE_G2 = 1, // i == j and p ~ q
+    EDGE_G1_SAME_G2 = 2, // i ~ j and p == q
+    EDGE_G1_EDGE_G2 = 4, // i ~ j and p ~ q
+    EDGE_G1_ANY_G2 = 8   // i ~ j
+  };
 protected:
   AdjMatrix graphTemplate(const AdjMatrix&, const AdjMatrix&) const;
+  // the product of the given terms: every row is assembled from the
+  // bitset rows of g2 block by block, as in a Kronecker product, and
+  // the edges are created in one batch
+  AdjMatrix build(const AdjMatrix&, const AdjMatrix&, unsigned terms) const;
+  // a3D of the product vertices from productPositions()
   void positionVertices(AdjMatrix&,
                         const AdjMatrix&, const AdjMatrix&,
                         Attribute<yaatk::Vector3D>& a3D) const;
 public:
+  // positions[i*n2+j] of the product vertices from those of the
+  // factors: vertex i of g1, shifted by the position of j in g2 along
+  // one axis and by j widths of g1 along the other. The bounding boxes
+  // and the g2 centroid are found once, so this is O(n1*n2); it needs
+  // no product graph, so it suits ProductView as well
+  static void productPositions(const std::vector<yaatk::Vector3D>& positions1,
+                               const std::vector<yaatk::Vector3D>& positions2,
+                               std::vector<yaatk::Vector3D>& positions);
   Product(Log& setlog = nullLog):AlgBase(setlog) {}
 };
 
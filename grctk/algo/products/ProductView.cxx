@@ -0,0 +1,115 @@
+/*
+  The ProductView class.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ProductView.hpp"
+
+namespace grctk
+{
+
+static
+void
+factorAdjacency(const AdjMatrix& g,
+                std::vector<std::vector<size_t> >& adjacent,
+                std::vector<bool>& s)
+{
+  const size_t n = g.size();
+  adjacent.assign(n,std::vector<size_t>());
+  s.assign(n*n,false);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      if (j != i && g.s(i,j))
+      {
+        adjacent[i].push_back(j);
+        s[i*n + j] = true;
+      }
+}
+
+ProductView::ProductView(const AdjMatrix& g1, const AdjMatrix& g2,
+                         unsigned productTerms):
+  terms(productTerms),
+  n2(g2.size()),
+  adjacent1(),
+  adjacent2(),
+  s1(),
+  s2()
+{
+  factorAdjacency(g1,adjacent1,s1);
+  factorAdjacency(g2,adjacent2,s2);
+}
+
+bool
+ProductView::s(size_t vi1, size_t vi2) const
+{
+  const size_t n1 = adjacent1.size();
+  size_t i = vi1/n2, p = vi1%n2;
+  size_t j = vi2/n2, q = vi2%n2;
+  bool edge1 = s1[i*n1 + j];
+  bool edge2 = s2[p*n2 + q];
+  return ((terms & Product::SAME_G1_EDGE_G2) && i == j && edge2) ||
+    ((terms & Product::EDGE_G1_SAME_G2) && edge1 && p == q) ||
+    ((terms & Product::EDGE_G1_EDGE_G2) && edge1 && edge2) ||
+    ((terms & Product::EDGE_G1_ANY_G2) && edge1);
+}
+
+void
+ProductView::neighbours(size_t vi, std::vector<size_t>& result) const
+{
+  size_t i = vi/n2, p = vi%n2;
+  result.clear();
+  // the terms never overlap, but for the all-covering last one
+  if (terms & Product::SAME_G1_EDGE_G2)
+    for(size_t b = 0; b < adjacent2[p].size(); ++b)
+      result.push_back(i*n2 + adjacent2[p][b]);
+  for(size_t a = 0; a < adjacent1[i].size(); ++a)
+  {
+    size_t j = adjacent1[i][a];
+    if (terms & Product::EDGE_G1_ANY_G2)
+    {
+      for(size_t q = 0; q < n2; ++q)
+        result.push_back(j*n2 + q);
+      continue;
+    }
+    if (terms & Product::EDGE_G1_SAME_G2)
+      result.push_back(j*n2 + p);
+    if (terms & Product::EDGE_G1_EDGE_G2)
+      for(size_t b = 0; b < adjacent2[p].size(); ++b)
+        result.push_back(j*n2 + adjacent2[p][b]);
+  }
+}
+
+size_t
+ProductView::degree(size_t vi) const
+{
+  size_t d1 = adjacent1[vi/n2].size();
+  size_t d2 = adjacent2[vi%n2].size();
+  size_t result = 0;
+  if (terms & Product::SAME_G1_EDGE_G2)
+    result += d2;
+  if (terms & Product::EDGE_G1_ANY_G2)
+    return result + d1*n2;
+  if (terms & Product::EDGE_G1_SAME_G2)
+    result += d1;
+  if (terms & Product::EDGE_G1_EDGE_G2)
+    result += d1*d2;
+  return result;
+}
+
+} //namespace grctk
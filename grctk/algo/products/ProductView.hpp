@@ -0,0 +1,58 @@
+/*
+  The ProductView class (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_ProductView_hpp
+#define grctk_ProductView_hpp
+
+#include "grctk/algo/products/Product.hpp"
+#include "grctk/GraphView.hpp"
+#include "grctk/AdjMatrix.hpp"
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  The product of g1 and g2 (e.g. StrongProduct::terms, see
+  Product::Term) without building it: vertex (i,p) is i*n2+p as in the
+  built products, and the adjacency, the neighbours and the degrees
+  are found from the factors on request. The view keeps the adjacency
+  of the factors only, O(n1^2 + n2^2) to set up and to store (in bits),
+  instead of the (n1*n2)^2 cells of the built product.
+*/
+class ProductView : public GraphView
+{
+  unsigned terms;
+  size_t n2;
+  std::vector<std::vector<size_t> > adjacent1, adjacent2;
+  // s() of the factors, row by row
+  std::vector<bool> s1, s2;
+public:
+  ProductView(const AdjMatrix& g1, const AdjMatrix& g2, unsigned productTerms);
+  virtual size_t size() const { return adjacent1.size()*n2; }
+  virtual bool s(size_t vi1, size_t vi2) const;
+  virtual void neighbours(size_t vi, std::vector<size_t>& result) const;
+  virtual size_t degree(size_t vi) const;
+};
+
+} //namespace grctk
+
+#endif
@@ -25,42 +25,15 @@
 namespace grctk
 {
 
+const unsigned StrongProduct::terms;
+
 AdjMatrix
 StrongProduct::operator()(const AdjMatrix& g1, const AdjMatrix& g2)
 {
   logStream() << "\nStrongProduct started\n";
   flushLogStreams();
 
-  AdjMatrix g = graphTemplate(g1,g2);
-
-  size_t n1 = g1.size();
-  size_t n2 = g2.size();
-
-  for(size_t i = 0; i < n1; i++)
-    for(size_t j = 0; j < n2; j++)
-      for(size_t k = 0; k < n2; k++)
-        if (g2.edge(j,k) && !g.edge(i*n2+j,i*n2+k))
-        {
-          checkAborted();
-          g.edge(i*n2+j,i*n2+k,Universe::singleton().create());
-        }
-  for(size_t i = 0; i < n1; i++)
-    for(size_t j = 0; j < n1; j++)
-      if (g1.edge(i,j))
-        for(size_t p = 0; p < n2; p++)
-        {
-          if (!g.edge(i*n2+p,j*n2+p))
-          {
-            checkAborted();
-            g.edge(i*n2+p,j*n2+p,Universe::singleton().create());
-          }
-          for(size_t q = 0; q < n2; q++)
-            if (!g.edge(i*n2+p,j*n2+q) && g2.edge(p,q))
-            {
-              checkAborted();
-              g.edge(i*n2+p,j*n2+q,Universe::singleton().create());
-            }
-        }
+  AdjMatrix g = build(g1,g2,terms);
 
   logStream() << "StrongProduct finished.\n" ;
   flushLogStreams();
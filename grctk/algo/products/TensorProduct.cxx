@@ -26,27 +26,15 @@
 namespace grctk
 {
 
+const unsigned TensorProduct::terms;
+
 AdjMatrix
 TensorProduct::operator()(const AdjMatrix& g1, const AdjMatrix& g2)
 {
   logStream() << "\nTensorProduct started\n";
   flushLogStreams();
 
-  AdjMatrix g = graphTemplate(g1,g2);
-
-  size_t n1 = g1.size();
-  size_t n2 = g2.size();
-
-  for(size_t i = 0; i < n1; i++)
-    for(size_t j = 0; j < n1; j++)
-      if (g1.edge(i,j))
-        for(size_t p = 0; p < n2; p++)
-          for(size_t q = 0; q < n2; q++)
-            if (!g.edge(i*n2+p,j*n2+q) && g2.edge(p,q))
-            {
-              checkAborted();
-              g.edge(i*n2+p,j*n2+q,Universe::singleton().create());
-            }
+  AdjMatrix g = build(g1,g2,terms);
 
   logStream() << "TensorProduct finished.\n" ;
   flushLogStreams();
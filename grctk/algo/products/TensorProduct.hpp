@@ -35,6 +35,7 @@ namespace grctk
 class TensorProduct : public Product
 {
 public:
+  static const unsigned terms = EDGE_G1_EDGE_G2;
   AdjMatrix operator()(const AdjMatrix&, const AdjMatrix&);
   AdjMatrix operator()(const AdjMatrix&, const AdjMatrix&,
                        Attribute<yaatk::Vector3D>& a3D);
@@ -41,4 +41,26 @@ BasicProperties::operator()(const AdjMatrix& g)
   flushLogStreams();
 }
 
+void
+BasicProperties::operator()(const GraphView& g)
+{
+  logStream() << "Number of vertices : " << g.size() << "\n";
+
+  size_t degreeSum = 0, minDegree = 0, maxDegree = 0;
+  for(size_t i = 0; i < g.size(); ++i)
+  {
+    checkAborted();
+    size_t d = g.degree(i);
+    degreeSum += d;
+    if (i == 0 || d < minDegree)
+      minDegree = d;
+    if (d > maxDegree)
+      maxDegree = d;
+  }
+  logStream() << "Number of edges : " << degreeSum/2 << "\n";
+  logStream() << "Degrees : " << minDegree << " - " << maxDegree << "\n";
+
+  flushLogStreams();
+}
+
 } //namespace grctk
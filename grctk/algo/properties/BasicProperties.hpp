@@ -25,6 +25,7 @@
 
 #include "grctk/algo/AlgBase.hpp"
 #include "grctk/AdjMatrix.hpp"
+#include "grctk/GraphView.hpp"
 #include "grctk/Universe.hpp"
 #include <yaatk/Vector3D.hpp>
 
@@ -35,6 +36,8 @@ class BasicProperties : public AlgBase
 {
 public:
   void operator()(const AdjMatrix&);
+  // the same from the degrees, plus their range
+  void operator()(const GraphView&);
   BasicProperties(Log& setlog = nullLog):AlgBase(setlog) {}
 };
 
@@ -0,0 +1,88 @@
+/*
+  The Distances algorithm.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Distances.hpp"
+#include <stdexcept>
+
+namespace grctk
+{
+
+const size_t Distances::noPath;
+
+void
+Distances::operator()(const GraphView& g, size_t source,
+                      std::vector<size_t>& distance)
+{
+  if (source >= g.size())
+    throw std::logic_error("Starting vertex does not exist in the graph");
+
+  distance.assign(g.size(),noPath);
+  std::vector<size_t> queue;
+  std::vector<size_t> adjacent;
+  queue.reserve(g.size());
+  queue.push_back(source);
+  distance[source] = 0;
+  for(size_t head = 0; head < queue.size(); ++head)
+  {
+    checkAborted();
+    size_t v = queue[head];
+    g.neighbours(v,adjacent);
+    for(size_t k = 0; k < adjacent.size(); ++k)
+      if (distance[adjacent[k]] == noPath)
+      {
+        distance[adjacent[k]] = distance[v] + 1;
+        queue.push_back(adjacent[k]);
+      }
+  }
+}
+
+size_t
+Distances::eccentricity(const GraphView& g, size_t source)
+{
+  std::vector<size_t> distance;
+  operator()(g,source,distance);
+  size_t result = 0;
+  for(size_t v = 0; v < distance.size(); ++v)
+  {
+    if (distance[v] == noPath)
+      return noPath;
+    if (distance[v] > result)
+      result = distance[v];
+  }
+  return result;
+}
+
+size_t
+Distances::diameter(const GraphView& g)
+{
+  size_t result = 0;
+  for(size_t v = 0; v < g.size(); ++v)
+  {
+    size_t e = eccentricity(g,v);
+    if (e == noPath)
+      return noPath;
+    if (e > result)
+      result = e;
+  }
+  return result;
+}
+
+} //namespace grctk
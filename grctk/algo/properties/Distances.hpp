@@ -0,0 +1,53 @@
+/*
+  The Distances algorithm (header file).
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef grctk_Distances_hpp
+#define grctk_Distances_hpp
+
+#include "grctk/algo/AlgBase.hpp"
+#include "grctk/GraphView.hpp"
+#include <vector>
+
+namespace grctk
+{
+
+/*
+  Graph distances by breadth-first search over GraphView::neighbours(),
+  so they work on views of graphs that are never built.
+*/
+class Distances : public AlgBase
+{
+public:
+  static const size_t noPath = size_t(-1);
+  // distance[v] from source to every vertex, noPath if unreachable
+  void operator()(const GraphView& g, size_t source,
+                  std::vector<size_t>& distance);
+  // the largest distance from source, noPath if the graph is
+  // disconnected
+  size_t eccentricity(const GraphView& g, size_t source);
+  // n searches; noPath for a disconnected graph, 0 for an empty one
+  size_t diameter(const GraphView& g);
+  Distances(Log& setlog = nullLog):AlgBase(setlog) {}
+};
+
+} //namespace grctk
+
+#endif
@@ -0,0 +1,210 @@
+/*
+  Benchmark and accuracy report of the approximate pair potentials.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grctk/algo/drawing/pairpot/Potentials.hpp"
+#include "grctk/algo/drawing/pairpot/PairKernel.hpp"
+#include <yaatk/FastExp.hpp>
+#include <yaatk/procmon.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <exception>
+
+using namespace std;
+using namespace grctk;
+
+// deterministic generator, so every variant sees the same operands
+class XorShift
+{
+  unsigned long long s;
+public:
+  XorShift(unsigned long long seed):s(seed ? seed : 1) {}
+  double operator()()
+    {
+      s ^= s << 13;
+      s ^= s >> 7;
+      s ^= s << 17;
+      return double(s >> 11)/double(1ULL << 53);
+    }
+};
+
+const double maxErrors[] = {0, 1e-12, 1e-9, 1e-6, 1e-4};
+const size_t maxErrorCount = sizeof(maxErrors)/sizeof(maxErrors[0]);
+
+/*
+  The arguments met by phi0 and phi1 span about [-60, 1] for the
+  default tune parameters and distances up to 10.
+*/
+void
+reportExp(size_t calls)
+{
+  cout << "exp(x), x in [-60, 1], " << calls << " calls" << endl;
+  cout << setw(12) << "bound" << setw(8) << "degree"
+       << setw(14) << "max error"
+       << setw(12) << "time, s" << setw(10) << "speedup" << endl;
+
+  vector<double> x(4096);
+  XorShift rnd(2018);
+  for(size_t i = 0; i < x.size(); ++i)
+    x[i] = -60.0 + 61.0*rnd();
+
+  double exactTime;
+  volatile double sink = 0;
+  {
+    procmon::ProcmonTimer timer;
+    double acc = 0;
+    for(size_t c = 0; c < calls; ++c)
+      acc += std::exp(x[c % x.size()]);
+    sink = acc;
+    exactTime = timer.getTimeInSeconds();
+  }
+  cout << setw(12) << "std::exp" << setw(8) << "-" << setw(14) << 0
+       << setw(12) << exactTime << setw(10) << 1.0 << endl;
+
+  for(size_t b = 0; b < maxErrorCount; ++b)
+  {
+    yaatk::FastExp fe(maxErrors[b]);
+    double maxError = 0;
+    for(double t = -60.0; t <= 1.0; t += 1e-5)
+    {
+      double e = std::exp(t);
+      maxError = max(maxError,fabs(fe(t) - e)/e);
+    }
+    procmon::ProcmonTimer timer;
+    double acc = 0;
+    for(size_t c = 0; c < calls; ++c)
+      acc += fe(x[c % x.size()]);
+    sink = acc;
+    double time = timer.getTimeInSeconds();
+    cout << setw(12) << maxErrors[b] << setw(8) << fe.degree()
+         << setw(14) << maxError
+         << setw(12) << time << setw(10) << exactTime/time << endl;
+  }
+  (void)sink;
+}
+
+/*
+  Every vertex of a random sparse graph in a cube of side 4, with the
+  energies compared to PPhi with the exact exp and no cutoff.
+*/
+void
+reportKernel(size_t n, size_t dim, size_t rounds)
+{
+  const double alpha0 = 6.0, alpha1 = 2.0, k = 0.03, r0 = 0.12;
+  XorShift rnd(777);
+  vector<vector<size_t> > adjacent(n);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t a = 0; a < 2; ++a)
+    {
+      size_t j = size_t(rnd()*n) % n;
+      if (j != i &&
+          find(adjacent[i].begin(),adjacent[i].end(),j) == adjacent[i].end())
+      {
+        adjacent[i].push_back(j);
+        adjacent[j].push_back(i);
+      }
+    }
+  vector<yaatk::VectorXD> positions(n,yaatk::VectorXD(dim));
+  for(size_t i = 0; i < n; ++i)
+    for(size_t d = 0; d < dim; ++d)
+      positions[i][d] = 4.0*rnd();
+
+  PPhi phi(alpha0,alpha1,k,r0);
+  vector<double> exact(n,0.0);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      if (j != i)
+      {
+        int adj = count(adjacent[i].begin(),adjacent[i].end(),j);
+        exact[i] += phi(positions[i],positions[j],adj);
+      }
+
+  cout << endl << "vertex energies, " << n << " vertices, dim " << dim
+       << ", " << rounds << " rounds" << endl;
+  cout << setw(8) << "isa" << setw(12) << "bound" << setw(10) << "cutoff"
+       << setw(14) << "max error" << setw(12) << "time, s"
+       << setw(10) << "speedup" << endl;
+
+  const double cutoffs[] = {0, phi.phi0Cutoff(1e-9), phi.phi0Cutoff(1e-6)};
+  // the speedup is relative to the exact scalar pass
+  double baseTime = 0;
+  for(int isa = PairKernel::ISA_SCALAR; isa <= PairKernel::detectIsa(); ++isa)
+  {
+    for(size_t c = 0; c < 3; ++c)
+      for(size_t b = 0; b < maxErrorCount; ++b)
+      {
+        if (c > 0 && maxErrors[b] != 0)
+          continue;
+        PairKernel kernel;
+        kernel.setup(alpha0,alpha1,k,r0,adjacent,dim,PairKernel::Isa(isa));
+        kernel.setApproximation(maxErrors[b],cutoffs[c]);
+        for(size_t i = 0; i < n; ++i)
+          kernel.setPosition(i,positions[i]);
+        double maxError = 0;
+        procmon::ProcmonTimer timer;
+        for(size_t r = 0; r < rounds; ++r)
+          for(size_t i = 0; i < n; ++i)
+          {
+            double e = kernel.evaluate(i,NULL);
+            maxError = max(maxError,fabs(e - exact[i])/(1 + fabs(exact[i])));
+          }
+        double time = timer.getTimeInSeconds();
+        if (baseTime == 0)
+          baseTime = time;
+        cout << setw(8) << PairKernel::isaName(PairKernel::Isa(isa))
+             << setw(12) << maxErrors[b] << setw(10) << cutoffs[c]
+             << setw(14) << maxError << setw(12) << time
+             << setw(10) << baseTime/time << endl;
+      }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  try
+  {
+    size_t scale = 1;
+    if (argc > 1)
+      scale = atoi(argv[1]);
+    if (scale == 0)
+      scale = 1;
+
+    reportExp(20000000*scale);
+    reportKernel(2000,2,10*scale);
+    reportKernel(2000,3,10*scale);
+  }
+  catch(exception& e)
+  {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...)
+  {
+    cerr << "Unknown exception" << endl;
+    return 1;
+  }
+
+  return 0;
+}
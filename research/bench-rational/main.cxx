@@ -0,0 +1,181 @@
+/*
+  Benchmark of the rational number implementations.
+
+  Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+  This file is part of GRCE, the Graph Research and Computing Environment.
+
+  GRCE is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GRCE is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GRCE.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <yaatk/Rational.hpp>
+#include <yaatk/procmon.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <exception>
+
+using namespace std;
+using namespace yaatk;
+
+// deterministic generator, so both types see the same operands
+class XorShift
+{
+  unsigned long long s;
+public:
+  XorShift(unsigned long long seed):s(seed ? seed : 1) {}
+  unsigned long operator()(unsigned long n)
+    {
+      s ^= s << 13;
+      s ^= s >> 7;
+      s ^= s << 17;
+      return (unsigned long)(s % n);
+    }
+};
+
+struct BenchResult
+{
+  double seconds;
+  string digest;
+};
+
+/*
+  Mimics FindOrbitsEdgeTensions::f(): the shortest paths from a source
+  split into branches and every edge accumulates 1/divider, where the
+  divider is the product of the branching factors along the path.
+*/
+template <class R>
+BenchResult
+benchTensionSums(size_t edges, size_t paths)
+{
+  procmon::ProcmonTimer timer;
+  XorShift rnd(12345);
+  vector<R> acc(edges, R(0));
+  for(size_t p = 0; p < paths; ++p)
+  {
+    R divider(1);
+    size_t depth = 1 + rnd(6);
+    for(size_t k = 0; k < depth; ++k)
+    {
+      divider = divider*R(1 + rnd(4));
+      size_t e = rnd(edges);
+      acc[e] = acc[e] + R(1)/divider;
+    }
+  }
+  BenchResult r;
+  r.seconds = timer.getTimeInSeconds();
+  ostringstream os;
+  for(size_t e = 0; e < edges; ++e)
+    os << acc[e];
+  r.digest = os.str();
+  return r;
+}
+
+template <class R>
+BenchResult
+benchSortMultisets(size_t count)
+{
+  procmon::ProcmonTimer timer;
+  XorShift rnd(54321);
+  vector<R> values;
+  values.reserve(count);
+  for(size_t i = 0; i < count; ++i)
+    values.push_back(R(1 + rnd(1000))/R(1 + rnd(1000)) + R(rnd(3)));
+  sort(values.begin(), values.end());
+  BenchResult r;
+  r.seconds = timer.getTimeInSeconds();
+  ostringstream os;
+  for(size_t i = 0; i < values.size(); i += 97)
+    os << values[i];
+  r.digest = os.str();
+  return r;
+}
+
+template <class R>
+BenchResult
+benchOverflowingProducts(size_t rounds)
+{
+  procmon::ProcmonTimer timer;
+  XorShift rnd(777);
+  R total(0);
+  for(size_t i = 0; i < rounds; ++i)
+  {
+    R p(1);
+    for(size_t k = 0; k < 40; ++k)
+      p = p*R(2 + rnd(1000), 1 + rnd(1000));
+    total = total + p/R(1 + rnd(1000));
+  }
+  BenchResult r;
+  r.seconds = timer.getTimeInSeconds();
+  ostringstream os;
+  os << total;
+  r.digest = os.str();
+  return r;
+}
+
+void
+report(const string& name, const BenchResult& gmp, const BenchResult& hybrid)
+{
+  cout << setw(22) << left << name << right
+       << setw(12) << gmp.seconds
+       << setw(12) << hybrid.seconds
+       << setw(10) << ((hybrid.seconds > 0) ? gmp.seconds/hybrid.seconds : 0.0)
+       << "   " << ((gmp.digest == hybrid.digest) ? "yes" : "NO")
+       << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  try
+  {
+    size_t scale = 1;
+    if (argc > 1)
+      scale = atoi(argv[1]);
+    if (scale == 0)
+      scale = 1;
+
+    cout << setw(22) << left << "workload" << right
+         << setw(12) << "GMP, s"
+         << setw(12) << "hybrid, s"
+         << setw(10) << "speedup"
+         << "   same results" << endl;
+
+    report("tension sums",
+           benchTensionSums<GMPRational>(1000, 400000*scale),
+           benchTensionSums<HybridRational>(1000, 400000*scale));
+    report("sort",
+           benchSortMultisets<GMPRational>(200000*scale),
+           benchSortMultisets<HybridRational>(200000*scale));
+    report("overflowing products",
+           benchOverflowingProducts<GMPRational>(2000*scale),
+           benchOverflowingProducts<HybridRational>(2000*scale));
+  }
+  catch(exception& e)
+  {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  catch(...)
+  {
+    cerr << "Unknown exception" << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -23,80 +23,390 @@
 #include "grctk/AdjMatrix.hpp"
 #include "grctk/algo/formats/BinCodeFile.hpp"
 #include "grctk/algo/orbits/CmpSubgraphIsoAndEdgeTensions.hpp"
+#include <yaatk/yaatk.hpp>
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <cstdlib>
+#include <cstdio>
+#include <ctime>
 #include <vector>
 #include <string>
 #include <exception>
+#include <stdexcept>
 
 using namespace std;
 using namespace yaatk;
 using namespace grctk;
 
+/*
+  A graph on which the algorithms disagree, identified by its index in
+  the input file, with the orbit counts found by both algorithms.
+*/
+struct FailedGraph
+{
+  unsigned long index;
+  size_t o1, o2;
+  FailedGraph(unsigned long i = 0, size_t so1 = 0, size_t so2 = 0):
+    index(i),o1(so1),o2(so2) {}
+};
+
+/*
+  Progress of one shard of one input file. It is all that is needed to
+  produce the outputs, so it is saved to the checkpoint file
+  periodically and the work resumes from it after a restart.
+*/
+struct ShardState
+{
+  string filename;
+  unsigned long shard, shards;
+  unsigned long begin, end;
+  unsigned long next;
+  bool done;
+  string checkFilename;
+  vector<FailedGraph> failed;
+
+  ShardState():
+    filename(),
+    shard(0),shards(1),
+    begin(0),end(0),next(0),
+    done(false),
+    checkFilename(),
+    failed() {}
+
+  void save(const string& checkpointFilename) const;
+  bool load(const string& checkpointFilename);
+};
+
+const string checkpointSignature = "cmp-orbits-finding-algos-checkpoint";
+
+void
+ShardState::save(const string& checkpointFilename) const
+{
+  string tmpFilename = checkpointFilename + ".tmp";
+  {
+    ofstream fo(tmpFilename.c_str());
+    fo << checkpointSignature << "\n"
+       << filename << "\n"
+       << shard << " " << shards << "\n"
+       << begin << " " << end << " " << next << " " << (done?1:0) << "\n"
+       << (checkFilename.empty() ? "-" : checkFilename) << "\n"
+       << failed.size() << "\n";
+    for(size_t i = 0; i < failed.size(); i++)
+      fo << failed[i].index << " "
+         << failed[i].o1 << " " << failed[i].o2 << "\n";
+    fo.close();
+    if (!fo)
+      throw runtime_error("Cannot write checkpoint " + tmpFilename);
+  }
+  // replace the previous checkpoint only when the new one is complete
+  if (std::rename(tmpFilename.c_str(), checkpointFilename.c_str()) != 0)
+  {
+    std::remove(checkpointFilename.c_str());
+    if (std::rename(tmpFilename.c_str(), checkpointFilename.c_str()) != 0)
+      throw runtime_error("Cannot update checkpoint " + checkpointFilename);
+  }
+}
+
+bool
+ShardState::load(const string& checkpointFilename)
+{
+  ifstream fi(checkpointFilename.c_str());
+  if (!fi)
+    return false;
+
+  string signature;
+  getline(fi,signature);
+  getline(fi,filename);
+  int doneFlag = 0;
+  size_t failedCount = 0;
+  fi >> shard >> shards >> begin >> end >> next >> doneFlag >> checkFilename
+     >> failedCount;
+  if (!fi || signature != checkpointSignature)
+    throw runtime_error("Malformed checkpoint " + checkpointFilename);
+  done = (doneFlag != 0);
+  if (checkFilename == "-")
+    checkFilename = "";
+
+  failed.resize(failedCount);
+  for(size_t i = 0; i < failedCount; i++)
+    fi >> failed[i].index >> failed[i].o1 >> failed[i].o2;
+  if (!fi)
+    throw runtime_error("Truncated checkpoint " + checkpointFilename);
+
+  return true;
+}
+
+string
+shardSuffix(unsigned long shard, unsigned long shards)
+{
+  if (shards == 1)
+    return "";
+  ostringstream os;
+  os << "-shard-" << shard << "-of-" << shards;
+  return os.str();
+}
+
+string
+checkpointFilename(const string& filename,
+                   unsigned long shard, unsigned long shards)
+{
+  return filename + "-checkpoint" + shardSuffix(shard,shards);
+}
+
+/*
+  Writes the -diff-pc report for the failed graphs, in the order they
+  appear in the input file. Averages are accumulated in the same order,
+  so a merged report is identical to the one of a serial run.
+*/
+void
+writeDiffReport(const string& reportFilename,
+                const vector<FailedGraph>& failed)
+{
+  ofstream fo(reportFilename.c_str());
+
+  double a_pc = 0.0, a_vpc = 0.0;
+  for(size_t i = 0; i < failed.size(); i++)
+  {
+    size_t o1 = failed[i].o1;
+    size_t o2 = failed[i].o2;
+    double pc = double(o2)/double(o1);
+    double vpc = double(o2-1)/double(o1-1);
+
+    fo << setw(10) << o1 << " " << setw(10) << o2 << " "
+       << setw(10) << pc << " " << setw(10) << vpc << endl;
+    a_pc += pc;
+    a_vpc += vpc;
+  }
+
+  if (failed.size() > 0)
+  {
+    a_pc /= failed.size();
+    a_vpc /= failed.size();
+    fo << "----\n" << setw(10) << a_pc << " " << setw(10) << a_vpc << endl;
+  }
+
+  fo.close();
+}
+
+void
+processShard(const string& filename,
+             unsigned long shard, unsigned long shards,
+             time_t checkpointInterval)
+{
+  CmpSubgraphIsoAndEdgeTensions cmpAlgorithms;
+  Attribute<int> aOrbitSubgraphIso;
+  Attribute<Rational> aOrbitEdgeTensions;
+
+  cerr << "Processing file : " << filename;
+  if (shards > 1)
+    cerr << " (shard " << shard << " of " << shards << ")";
+  cerr << endl;
+
+  BinCodeFileReader bicfile(filename.c_str());
+  cerr << "Checksum is "
+       << (bicfile.checksumIsCorrect()?"":"NOT ")
+       << "correct" << endl;
+  cerr << "Total number of graphs : "
+       << bicfile.numberOfGraphs() << endl;
+
+  const string checkpoint = checkpointFilename(filename,shard,shards);
+
+  ShardState state;
+  if (state.load(checkpoint))
+  {
+    REQUIRE(state.filename == filename);
+    REQUIRE(state.shard == shard && state.shards == shards);
+    REQUIRE(state.end <= bicfile.numberOfGraphs());
+    if (state.done)
+    {
+      cerr << "Already processed, see " << checkpoint << endl;
+      return;
+    }
+    cerr << "Resuming from graph " << state.next
+         << " (" << state.failed.size() << " differing so far)" << endl;
+  }
+  else
+  {
+    unsigned long ng = bicfile.numberOfGraphs();
+    state.filename = filename;
+    state.shard = shard;
+    state.shards = shards;
+    state.begin = ng*shard/shards;
+    state.end = ng*(shard+1)/shards;
+    state.next = state.begin;
+  }
+
+  cerr << "Graphs to process : [" << state.begin << ", "
+       << state.end << ")" << endl;
+
+  time_t lastSave = time(NULL);
+  for(unsigned long gindex = state.next; gindex < state.end; gindex++)
+  {
+    AdjMatrix g = bicfile.getGraph(gindex);
+
+    if (!cmpAlgorithms(g,aOrbitSubgraphIso,aOrbitEdgeTensions))
+    {
+      size_t o1 = CmpSubgraphIsoAndEdgeTensions::getOrbitsCount(g,aOrbitSubgraphIso);
+      size_t o2 = CmpSubgraphIsoAndEdgeTensions::getOrbitsCount(g,aOrbitEdgeTensions);
+      state.failed.push_back(FailedGraph(gindex,o1,o2));
+    }
+
+    state.next = gindex + 1;
+    if (time(NULL) - lastSave >= checkpointInterval)
+    {
+      state.save(checkpoint);
+      lastSave = time(NULL);
+    }
+  }
+
+  cerr << "Number of graphs on which the algorithms results differ: "
+       << state.failed.size() << endl;
+
+  const string suffix = shardSuffix(shard,shards);
+
+  writeDiffReport(filename + "-diff-pc" + suffix, state.failed);
+
+  if (state.failed.size() > 0)
+  {
+    AdjMatrix first = bicfile.getGraph(state.failed[0].index);
+    state.checkFilename =
+      BinCodeFileWriter::proposedBasename(first) + suffix + "-check.R";
+
+    BinCodeFileWriter checkList(state.checkFilename);
+    for(size_t fgi = 0; fgi < state.failed.size(); fgi++)
+      checkList.addGraph(bicfile.getGraph(state.failed[fgi].index));
+  }
+
+  state.done = true;
+  state.save(checkpoint);
+}
+
+/*
+  Combines the finished shards of a file into the outputs a serial run
+  would have produced.
+*/
+void
+mergeShards(const string& filename, unsigned long shards)
+{
+  REQUIRE(shards >= 2);
+  cerr << "Merging " << shards << " shards of file : " << filename << endl;
+
+  vector<FailedGraph> failed;
+  vector<string> checkFilenames;
+  unsigned long expectedBegin = 0;
+
+  for(unsigned long shard = 0; shard < shards; shard++)
+  {
+    const string checkpoint = checkpointFilename(filename,shard,shards);
+    ShardState state;
+    if (!state.load(checkpoint))
+      throw runtime_error("Missing checkpoint " + checkpoint);
+    if (!state.done)
+      throw runtime_error("Shard is not finished: " + checkpoint);
+    if (state.begin != expectedBegin)
+      throw runtime_error("Shards do not cover the file: " + checkpoint);
+    expectedBegin = state.end;
+
+    failed.insert(failed.end(), state.failed.begin(), state.failed.end());
+    if (!state.checkFilename.empty())
+      checkFilenames.push_back(state.checkFilename);
+  }
+
+  {
+    BinCodeFileReader bicfile(filename.c_str());
+    if (expectedBegin != bicfile.numberOfGraphs())
+      throw runtime_error("Shards do not cover the file: " + filename);
+  }
+
+  cerr << "Number of graphs on which the algorithms results differ: "
+       << failed.size() << endl;
+
+  writeDiffReport(filename + "-diff-pc", failed);
+
+  if (failed.size() > 0)
+  {
+    BinCodeFileReader firstShardCheck(checkFilenames[0]);
+    BinCodeFileWriter checkList(
+      BinCodeFileWriter::proposedBasename(firstShardCheck.getGraph(0))
+      + "-check.R");
+
+    for(size_t ci = 0; ci < checkFilenames.size(); ci++)
+    {
+      BinCodeFileReader shardCheck(checkFilenames[ci]);
+      for(unsigned long gi = 0; gi < shardCheck.numberOfGraphs(); gi++)
+        checkList.addGraph(shardCheck.getGraph(gi));
+    }
+
+    REQUIRE(checkList.numberOfGraphs() == failed.size());
+  }
+}
+
+void
+parseShard(const string& spec, unsigned long& shard, unsigned long& shards)
+{
+  char slash = '\0';
+  istringstream is(spec);
+  is >> shard >> slash >> shards;
+  if (!is || slash != '/' || shards == 0 || shard >= shards)
+    throw runtime_error("Wrong shard specification (expected k/N, 0 <= k < N): "
+                        + spec);
+}
+
+void
+printUsage()
+{
+  cerr << "Usage: cmp-orbits-finding-algos [options] file...\n"
+       << "  --shard k/N         process only the k-th of N index ranges"
+       << " (0 <= k < N)\n"
+       << "  --checkpoint s      save progress every s seconds"
+       << " (default 60)\n"
+       << "  --merge N           merge the outputs of N finished shards"
+       << " (N >= 2)\n"
+       << "A run resumes from the checkpoint file (<file>-checkpoint[-shard-k-of-N])"
+       << " if it exists.\n";
+}
+
 int main(int argc, char *argv[])
 {
   try
   {
-    CmpSubgraphIsoAndEdgeTensions cmpAlgorithms;
-    Attribute<int> aOrbitSubgraphIso;
-    Attribute<Rational> aOrbitEdgeTensions;
+    unsigned long shard = 0, shards = 1, mergeCount = 0;
+    time_t checkpointInterval = 60;
+    vector<string> filenames;
 
     for(int i = 1; i < argc; i++)
     {
-      std::string filename = argv[i];
-      cerr << "Processing file : " << filename << endl;
-
-      ofstream fo((filename + "-diff-pc").c_str());
-
-      vector<AdjMatrix> failedGraphs;
-      double a_pc = 0.0, a_vpc = 0.0;
-
-      BinCodeFileReader bicfile(filename.c_str());
-      cerr << "Checksum is "
-           << (bicfile.checksumIsCorrect()?"":"NOT ")
-           << "correct" << endl;
-      cerr << "Total number of graphs : "
-           << bicfile.numberOfGraphs() << endl;
-      for(unsigned long gindex = 0;
-          gindex < bicfile.numberOfGraphs(); gindex++)
+      string arg = argv[i];
+      if (isOption(arg,"shard") && i+1 < argc)
+        parseShard(argv[++i],shard,shards);
+      else if (isOption(arg,"checkpoint") && i+1 < argc)
+        checkpointInterval = atoi(argv[++i]);
+      else if (isOption(arg,"merge") && i+1 < argc)
       {
-        AdjMatrix g = bicfile.getGraph(gindex);
-
-        if (!cmpAlgorithms(g,aOrbitSubgraphIso,aOrbitEdgeTensions))
-        {
-          failedGraphs.push_back(g);
-
-          size_t o1 = CmpSubgraphIsoAndEdgeTensions::getOrbitsCount(g,aOrbitSubgraphIso);
-          size_t o2 = CmpSubgraphIsoAndEdgeTensions::getOrbitsCount(g,aOrbitEdgeTensions);
-          double pc = double(o2)/double(o1);
-          double vpc = double(o2-1)/double(o1-1);
-
-          fo << setw(10) << o1 << " " << setw(10) << o2 << " "
-             << setw(10) << pc << " " << setw(10) << vpc << endl;
-          a_pc += pc;
-          a_vpc += vpc;
-        }
+        mergeCount = atoi(argv[++i]);
+        // an unsharded run writes its outputs itself, and merging it
+        // would rewrite its check list while reading it
+        if (mergeCount < 2)
+          throw runtime_error("--merge needs at least 2 shards");
       }
-
-      cerr << "Number of graphs on which the algorithms results differ: "
-           << failedGraphs.size() << endl;
-
-      if (failedGraphs.size() > 0)
+      else if (isOption(arg,"help",'h'))
       {
-        a_pc /= failedGraphs.size();
-        a_vpc /= failedGraphs.size();
-        fo << "----\n" << setw(10) << a_pc << " " << setw(10) << a_vpc << endl;
-
-        BinCodeFileWriter checkList(
-          BinCodeFileWriter::proposedBasename(failedGraphs[0]) + "-check.R");
-
-        for(size_t fgi = 0; fgi < failedGraphs.size(); fgi++)
-          checkList.addGraph(failedGraphs[fgi]);
+        printUsage();
+        return 0;
       }
+      else
+        filenames.push_back(arg);
+    }
 
-      fo.close();
+    for(size_t i = 0; i < filenames.size(); i++)
+    {
+      if (mergeCount > 0)
+        mergeShards(filenames[i],mergeCount);
+      else
+        processShard(filenames[i],shard,shards,checkpointInterval);
     }
   }
   catch(exception& e)
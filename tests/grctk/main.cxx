@@ -23,9 +23,42 @@
 #include <sstream>
 
 #include <yaatk/SquareMatrix.hpp>
+#include <yaatk/Rational.hpp>
+#include <yaatk/FastExp.hpp>
 #include <grctk/AdjMatrix.hpp>
+#include <grctk/algo/attrconv/ValueRanking.hpp>
+#include <grctk/algo/orbits/FindOrbitsVPerms.hpp>
+#include <grctk/algo/attrconv/Map2Int.hpp>
+#include <grctk/algo/formats/BinCode.hpp>
+#include <grctk/algo/pipeline/Pipeline.hpp>
+#include <grctk/algo/pipeline/BinCodeStages.hpp>
 #include <grctk/algo/formats/Environment.hpp>
+#include <grctk/algo/drawing/pairpot/PairKernel.hpp>
+#include <grctk/algo/drawing/pairpot/Potentials.hpp>
+#include <grctk/algo/drawing/pairpot/PairPot.hpp>
+#include <grctk/algo/drawing/pairpot/Multilevel.hpp>
+#include <grctk/algo/drawing/spectral/SpectralPositions.hpp>
+#include <grctk/algo/drawing/intersections/OptiIntersect.hpp>
+#include <grctk/algo/drawing/metrics/LayoutMetrics.hpp>
+#include <grctk/algo/drawing/stress/StressMajorization.hpp>
+#include <grctk/algo/drawing/pairpot/IncrementalLayout.hpp>
+#include <grctk/algo/products/CartesianProduct.hpp>
+#include <grctk/algo/products/TensorProduct.hpp>
+#include <grctk/algo/products/StrongProduct.hpp>
+#include <grctk/algo/products/LexicographicalProduct.hpp>
+#include <grctk/algo/products/ProductView.hpp>
+#include <grctk/algo/connectivity/ConComp.hpp>
+#include <grctk/algo/properties/Distances.hpp>
+#include <grctk/algo/drawing/tools.hpp>
+#include <grctk/algo/generation/GenRandom.hpp>
+#include <grctk/algo/generation/GenDegreeSequence.hpp>
+#include <grctk/algo/formats/BinCodeFile.hpp>
+#include <zthread/Thread.h>
+#include <zthread/Runnable.h>
 #include <map>
+#include <atomic>
+#include <cstdio>
+#include <algorithm>
 
 using namespace grctk;
 
@@ -196,11 +229,1716 @@ test_AdjMatrix()
   return true;
 }
 
+bool
+test_hybrid_rational()
+{
+  typedef yaatk::HybridRational R;
+  typedef yaatk::GMPRational G;
+
+  {
+    R a(2,4);
+    REQUIRE(a == R(1,2));
+    REQUIRE(R(-3,-6) == R(1,2));
+    REQUIRE(R(3,-6) == R(-1,2));
+    REQUIRE(R(1,3) + R(1,6) == R(1,2));
+    REQUIRE(R(1,3) - R(1,3) == R(0));
+    REQUIRE(R(2,3) * R(3,4) == R(1,2));
+    REQUIRE(R(1,2) / R(-1,4) == R(-2));
+    REQUIRE(R(1,3) < R(1,2));
+    REQUIRE(!(R(1,2) < R(1,2)));
+    REQUIRE(a.isSmall());
+  }
+
+  {
+    R big(1);
+    G ref(1);
+    for(int i = 0; i < 30; ++i)
+    {
+      big = big*R(1000003,7);
+      ref = ref*G(1000003,7);
+    }
+    REQUIRE(!big.isSmall());
+    std::ostringstream osBig, osRef;
+    osBig << big;
+    osRef << ref;
+    REQUIRE(osBig.str() == osRef.str());
+
+    for(int i = 0; i < 30; ++i)
+      big = big/R(1000003,7);
+    REQUIRE(big.isSmall());
+    REQUIRE(big == R(1));
+  }
+
+  {
+    R max(yaatk::LongInteger("9223372036854775807"));
+    REQUIRE(max.isSmall());
+    R sum = max + R(1);
+    REQUIRE(!sum.isSmall());
+    REQUIRE(sum.numerator() == yaatk::LongInteger("9223372036854775808"));
+    REQUIRE(max < sum);
+    REQUIRE(sum - R(1) == max);
+    REQUIRE((sum - R(1)).isSmall());
+  }
+
+  {
+    std::stringstream ss;
+    ss << R(-5,15);
+    R r;
+    ss >> r;
+    REQUIRE(r == R(-1,3));
+  }
+
+  return true;
+}
+
+bool
+test_value_ranking()
+{
+  {
+    int v[] = {7, -1, 7, 3, -1, 7, 100};
+    std::vector<int> values(v, v + sizeof(v)/sizeof(v[0]));
+    std::vector<size_t> ranks;
+    REQUIRE(grctk::rankValues(values,ranks) == 4);
+    size_t expected[] = {2, 0, 2, 1, 0, 2, 3};
+    for(size_t i = 0; i < values.size(); ++i)
+      REQUIRE(ranks[i] == expected[i]);
+  }
+
+  {
+    typedef yaatk::Rational R;
+    std::vector<std::vector<R> > values(4);
+    values[0].push_back(R(1,2)); values[0].push_back(R(1,3));
+    values[1].push_back(R(1,3)); values[1].push_back(R(2,4));
+    values[2].push_back(R(1,3));
+    values[3].push_back(R(1,2)); values[3].push_back(R(1,2));
+    for(size_t i = 0; i < values.size(); ++i)
+      std::sort(values[i].begin(), values[i].end());
+    std::vector<size_t> ranks;
+    REQUIRE(grctk::rankValues(values,ranks) == 3);
+    REQUIRE(ranks[0] == 1 && ranks[1] == 1);
+    REQUIRE(ranks[2] == 0);
+    REQUIRE(ranks[3] == 2);
+  }
+
+  {
+    std::vector<int> values;
+    std::vector<size_t> ranks(5);
+    REQUIRE(grctk::rankValues(values,ranks) == 0);
+    REQUIRE(ranks.empty());
+  }
+
+  return true;
+}
+
+bool
+test_edge_orbits()
+{
+  {
+    // a path 0-1-2-3 with a pendant vertex 4 attached to 1 and 5 to 2
+    grctk::AdjMatrix g;
+    for(size_t i = 0; i < 6; ++i)
+      g += grctk::Universe::singleton().create();
+    size_t e[][2] = {{0,1},{1,2},{2,3},{1,4},{2,5}};
+    for(size_t k = 0; k < sizeof(e)/sizeof(e[0]); ++k)
+      g.edge(e[k][0],e[k][1],grctk::Universe::singleton().create());
+
+    grctk::Attribute<int> aOrbit, aEdgeOrbit;
+    grctk::FindOrbitsVPerms alg;
+    alg(g,aOrbit,aEdgeOrbit);
+
+    REQUIRE(aOrbit[g[0]] == 1 && aOrbit[g[3]] == 1);
+    REQUIRE(aOrbit[g[4]] == 1 && aOrbit[g[5]] == 1);
+    REQUIRE(aOrbit[g[1]] == 2 && aOrbit[g[2]] == 2);
+
+    REQUIRE(aEdgeOrbit[g(0,1)] == 1);
+    REQUIRE(aEdgeOrbit[g(1,4)] == 1);
+    REQUIRE(aEdgeOrbit[g(2,3)] == 1);
+    REQUIRE(aEdgeOrbit[g(2,5)] == 1);
+    REQUIRE(aEdgeOrbit[g(1,2)] == 2);
+
+    grctk::Attribute<int> aOrbitOnly;
+    alg(g,aOrbitOnly);
+    for(size_t i = 0; i < g.size(); ++i)
+      REQUIRE(aOrbitOnly[g[i]] == aOrbit[g[i]]);
+  }
+
+  return true;
+}
+
+grctk::BinCode
+pipelineTestCode(size_t k)
+{
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 6; ++i)
+    g += grctk::Universe::singleton().create();
+  size_t bit = 0;
+  for(size_t i = 0; i < 6; ++i)
+    for(size_t j = i+1; j < 6; ++j, ++bit)
+      if ((k*2654435761UL >> bit) & 1)
+        g.edge(i,j,grctk::Universe::singleton().create());
+  grctk::BinCode code(6);
+  code.encode(g);
+  return code;
+}
+
+size_t
+pipelineTestOrbits(const grctk::BinCode& code)
+{
+  grctk::AdjMatrix g = code.decode();
+  grctk::Attribute<int> aOrbit, aIndex;
+  grctk::FindOrbitsVPerms findOrbits;
+  findOrbits(g,aOrbit);
+  grctk::Map2Int<int> m2i;
+  m2i(g,aOrbit,aIndex);
+  int count = 0;
+  for(size_t i = 0; i < g.size(); ++i)
+    count = std::max(count,aIndex[g[i]]);
+  return count;
+}
+
+struct PipelineTestResult
+{
+  size_t index;
+  size_t orbits;
+  PipelineTestResult():index(0),orbits(0) {}
+};
+
+class PipelineTestSource : public grctk::PipelineSource<std::pair<size_t,grctk::BinCode> >
+{
+  const std::vector<grctk::BinCode>& codes;
+  size_t next;
+public:
+  PipelineTestSource(const std::vector<grctk::BinCode>& c):codes(c),next(0) {}
+  bool operator()(std::pair<size_t,grctk::BinCode>& item)
+    {
+      if (next == codes.size())
+        return false;
+      item = std::make_pair(next,codes[next]);
+      next++;
+      return true;
+    }
+};
+
+struct PipelineTestMap
+{
+  size_t failAt;
+  PipelineTestMap(size_t fail = size_t(-1)):failAt(fail) {}
+  bool operator()(const std::pair<size_t,grctk::BinCode>& in,
+                  PipelineTestResult& out)
+    {
+      if (in.first == failAt)
+        throw std::runtime_error("map failed");
+      out.index = in.first;
+      out.orbits = pipelineTestOrbits(in.second);
+      return true;
+    }
+};
+
+struct PipelineTestFilter
+{
+  bool operator()(const PipelineTestResult& r) { return r.orbits > 1; }
+};
+
+class PipelineTestSink : public grctk::PipelineSink<PipelineTestResult>
+{
+public:
+  std::vector<PipelineTestResult> results;
+  std::atomic<size_t> written;
+  PipelineTestSink():results(),written(0) {}
+  void operator()(const PipelineTestResult& r) { results.push_back(r); written++; }
+};
+
+// records how far it gets ahead of the sink
+class PipelineTestCountingSource : public PipelineTestSource
+{
+  const std::atomic<size_t>& written;
+  size_t produced;
+public:
+  size_t maxAhead;
+  PipelineTestCountingSource(const std::vector<grctk::BinCode>& c,
+                             const std::atomic<size_t>& w):
+    PipelineTestSource(c),written(w),produced(0),maxAhead(0) {}
+  bool operator()(std::pair<size_t,grctk::BinCode>& item)
+    {
+      if (!PipelineTestSource::operator()(item))
+        return false;
+      maxAhead = std::max(maxAhead,produced++ - written.load());
+      return true;
+    }
+};
+
+// holds back the first item, so that the others pile up at the sink
+struct PipelineTestSlowMap
+{
+  bool operator()(const std::pair<size_t,grctk::BinCode>& in,
+                  PipelineTestResult& out)
+    {
+      if (in.first == 0)
+        ZThread::Thread::sleep(100);
+      out.index = in.first;
+      return true;
+    }
+};
+
+struct PipelineTestCodeFilter
+{
+  bool operator()(const grctk::BinCode& code)
+    {
+      return pipelineTestOrbits(code) > 1;
+    }
+};
+
+bool
+test_pipeline()
+{
+  std::vector<grctk::BinCode> codes;
+  std::vector<size_t> expected;
+  for(size_t k = 0; k < 300; ++k)
+  {
+    codes.push_back(pipelineTestCode(k));
+    expected.push_back(pipelineTestOrbits(codes.back()));
+  }
+
+  {
+    PipelineTestSource source(codes);
+    PipelineTestSink sink;
+    grctk::Pipeline p(16);
+    grctk::PipelineChannel<PipelineTestResult>& results =
+      p.map<PipelineTestResult>(p.source(source), PipelineTestMap(), 4);
+    p.sink(p.filter(results, PipelineTestFilter(), 2), sink);
+    p.run();
+
+    size_t next = 0;
+    for(size_t k = 0; k < codes.size(); ++k)
+      if (expected[k] > 1)
+      {
+        REQUIRE(next < sink.results.size());
+        REQUIRE(sink.results[next].index == k);
+        REQUIRE(sink.results[next].orbits == expected[k]);
+        next++;
+      }
+    REQUIRE(next == sink.results.size());
+  }
+
+  {
+    PipelineTestSource source(codes);
+    PipelineTestSink sink;
+    grctk::Pipeline p(4);
+    p.sink(p.map<PipelineTestResult>(p.source(source), PipelineTestMap(100), 3),
+           sink);
+    try
+    {
+      p.run();
+      return false;
+    }
+    catch (std::runtime_error& e)
+    {
+      REQUIRE(std::string(e.what()) == "Pipeline: map failed");
+    }
+  }
+
+  {
+    PipelineTestSink sink;
+    PipelineTestCountingSource source(codes,sink.written);
+    grctk::Pipeline p(2);
+    p.sink(p.map<PipelineTestResult>(p.source(source), PipelineTestSlowMap(), 3),
+           sink);
+    REQUIRE(p.reorderWindow() < codes.size());
+    p.run();
+    REQUIRE(source.maxAhead <= p.reorderWindow());
+    REQUIRE(sink.results.size() == codes.size());
+    for(size_t k = 0; k < codes.size(); ++k)
+      REQUIRE(sink.results[k].index == k);
+  }
+
+  const char* names[] = {"test_pipeline_in.tmp", "test_pipeline_out.tmp"};
+  {
+    grctk::BinCodeFileWriter writer(names[0]);
+    for(size_t k = 0; k < codes.size(); ++k)
+      writer.addCode(codes[k]);
+  }
+  {
+    grctk::BinCodeFileSource source(names[0],10,200);
+    grctk::BinCodeFileSink sink(names[1]);
+    grctk::Pipeline p(8);
+    p.sink(p.filter(p.source(source), PipelineTestCodeFilter(), 3), sink);
+    p.run();
+    REQUIRE(source.numberOfGraphs() == codes.size());
+  }
+  {
+    grctk::BinCodeFileReader reader(names[1]);
+    unsigned long next = 0;
+    for(size_t k = 10; k < 200; ++k)
+      if (expected[k] > 1)
+      {
+        REQUIRE(next < reader.numberOfGraphs());
+        std::ostringstream got, want;
+        reader.getCode(next++).write(got);
+        codes[k].write(want);
+        REQUIRE(got.str() == want.str());
+      }
+    REQUIRE(next == reader.numberOfGraphs());
+  }
+  std::remove(names[0]);
+  std::remove(names[1]);
+
+  return true;
+}
+
+bool
+test_pair_kernel()
+{
+  const size_t n = 37;
+  const size_t dim = 3;
+  std::vector<std::vector<size_t> > adjacent(n);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      if (j != i && (i*j + i + j) % 5 == 0)
+        adjacent[i].push_back(j);
+  std::vector<yaatk::VectorXD> positions(n,yaatk::VectorXD(dim));
+  unsigned long long s = 12345;
+  for(size_t i = 0; i < n; ++i)
+    for(size_t d = 0; d < dim; ++d)
+    {
+      s = s*6364136223846793005ULL + 1442695040888963407ULL;
+      positions[i][d] = double(s >> 11)/double(1ULL << 53)*2.0 - 1.0;
+    }
+
+  grctk::PPhi phi(6.0,2.0,0.03,0.12);
+  for(int isa = grctk::PairKernel::ISA_SCALAR;
+      isa <= grctk::PairKernel::detectIsa(); ++isa)
+  {
+    grctk::PairKernel kernel;
+    kernel.setup(6.0,2.0,0.03,0.12,adjacent,dim,
+                 grctk::PairKernel::Isa(isa));
+    REQUIRE(kernel.selectedIsa() == isa);
+    for(size_t i = 0; i < n; ++i)
+      kernel.setPosition(i,positions[i]);
+    for(size_t i = 0; i < n; ++i)
+    {
+      double energy = 0;
+      yaatk::VectorXD grad(dim);
+      for(size_t j = 0; j < n; ++j)
+        if (j != i)
+        {
+          int adj = std::count(adjacent[i].begin(),adjacent[i].end(),j);
+          energy += phi(positions[j],positions[i],adj);
+          grad += phi.grad(positions[i],positions[j],adj);
+        }
+      double kernelGrad[dim];
+      REQUIRE(std::fabs(kernel.evaluate(i,kernelGrad) - energy) <
+              1e-12*(1 + std::fabs(energy)));
+      REQUIRE(std::fabs(kernel.evaluate(i,NULL) - energy) <
+              1e-12*(1 + std::fabs(energy)));
+      for(size_t d = 0; d < dim; ++d)
+        REQUIRE(std::fabs(kernelGrad[d] - grad[d]) <
+                1e-12*(1 + std::fabs(grad[d])));
+    }
+  }
+
+  return true;
+}
+
+// far more starts than can finish before it is interrupted
+class PairPotAbortedRun : public ZThread::Runnable
+{
+  bool& aborted;
+public:
+  PairPotAbortedRun(bool& flag):aborted(flag) {}
+  void run()
+    {
+      grctk::Universe universe;
+      grctk::UniverseScope scope(universe);
+      grctk::AdjMatrix g;
+      for(size_t i = 0; i < 7; ++i)
+        g += grctk::Universe::singleton().create();
+      for(size_t i = 0; i < 7; ++i)
+        g.edge(i,(i+1)%7,grctk::Universe::singleton().create());
+
+      grctk::Attribute<yaatk::Vector3D> a3D;
+      grctk::PairPotBase::TuneParams tune;
+      grctk::PairPotBase::InputParams inputBase(a3D,1.0,0.001);
+      grctk::GraphMultiRep multiRep(g,2);
+      try
+      {
+        grctk::PairPot alg(tune);
+        alg(inputBase,grctk::PairPot::InputParams(100000,false,42,2),multiRep);
+      }
+      catch(grctk::AbortAlgException&)
+      {
+        aborted = true;
+      }
+    }
+};
+
+bool
+test_pair_pot_multistart()
+{
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 7; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 7; ++i)
+    g.edge(i,(i+1)%7,grctk::Universe::singleton().create());
+  g.edge(0,3,grctk::Universe::singleton().create());
+
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::PairPotBase::TuneParams tune;
+  grctk::PairPotBase::InputParams inputBase(a3D,1.0,0.001);
+  grctk::GraphMultiRep serial(g,2);
+  grctk::GraphMultiRep parallel(g,2);
+  {
+    grctk::PairPot alg(tune);
+    alg(inputBase,grctk::PairPot::InputParams(5,false,42,1),serial);
+  }
+  {
+    grctk::PairPot alg(tune);
+    alg(inputBase,grctk::PairPot::InputParams(5,false,42,3),parallel);
+  }
+
+  REQUIRE(serial.size() == 5 && parallel.size() == 5);
+  for(size_t r = 0; r < 5; ++r)
+  {
+    REQUIRE(serial.energies[r] == parallel.energies[r]);
+    std::vector<yaatk::VectorXD> s = serial.getRep(r);
+    std::vector<yaatk::VectorXD> p = parallel.getRep(r);
+    for(size_t i = 0; i < g.size(); ++i)
+      for(size_t d = 0; d < 2; ++d)
+        REQUIRE(s[i][d] == p[i][d]);
+  }
+  REQUIRE(serial.getRep(0)[0][0] != serial.getRep(1)[0][0]);
+
+  // an interrupt of the calling thread stops all the starts
+  bool aborted = false;
+  {
+    ZThread::Thread run(ZThread::Task(new PairPotAbortedRun(aborted)));
+    ZThread::Thread::sleep(50);
+    run.interrupt();
+    run.wait();
+  }
+  REQUIRE(aborted);
+
+  return true;
+}
+
+class PairPotBaseProbe : public grctk::PairPotBase
+{
+public:
+  PairPotBaseProbe(TuneParams& tune_params): PairPotBase(tune_params) {}
+  void prepare(const InputParams& input, grctk::GraphRep& rep)
+    {
+      prepareKernel(input,rep);
+      prepareApproximation(input,rep);
+    }
+  double approximatePhi(size_t i, grctk::GraphRep& rep)
+    {
+      return PhiApprox(i,rep);
+    }
+  void approximateFi(size_t i, grctk::GraphRep& rep, yaatk::VectorXD& grad)
+    {
+      FiApprox(i,rep,grad);
+    }
+};
+
+bool
+test_pair_pot_approximation()
+{
+  const size_t n = 64;
+  std::vector<yaatk::VectorXD> positions(n,yaatk::VectorXD(3));
+  for(size_t i = 0; i < n; ++i)
+  {
+    positions[i][0] = (i%4)*1.1 + i*0.013;
+    positions[i][1] = ((i/4)%4)*1.1 - i*0.007;
+    positions[i][2] = (i/16)*1.1 + (i%3)*0.05;
+  }
+
+  grctk::PairPotBase::TuneParams tune;
+  grctk::PPhi phi(tune.alpha0,tune.alpha1,tune.k,tune.r0);
+  const double errorBound = 1.0e-3;
+  const double cutoff = phi.phi0Cutoff(errorBound);
+
+  // the grid candidates within the cutoff are exactly the points there,
+  // also after some of them have moved to other cells
+  grctk::NeighbourGrid grid;
+  std::vector<const yaatk::VectorXD*> pointers(n);
+  for(size_t i = 0; i < n; ++i)
+    pointers[i] = &positions[i];
+  grid.build(pointers,cutoff);
+  for(size_t pass = 0; pass < 2; ++pass)
+  {
+    if (pass == 1)
+      for(size_t i = 0; i < n; i += 3)
+      {
+        positions[i][0] += 2.5;
+        positions[i][2] -= 0.9*(i%5);
+        grid.move(i,positions[i]);
+      }
+    for(size_t i = 0; i < n; ++i)
+    {
+      std::vector<size_t> candidates;
+      grid.candidates(positions[i],candidates);
+      std::set<size_t> found, expected;
+      for(size_t k = 0; k < candidates.size(); ++k)
+        if (yaatk::module(yaatk::VectorXD(positions[candidates[k]]-positions[i]))
+            < cutoff)
+          found.insert(candidates[k]);
+      for(size_t j = 0; j < n; ++j)
+        if (yaatk::module(yaatk::VectorXD(positions[j]-positions[i])) < cutoff)
+          expected.insert(j);
+      REQUIRE(found == expected);
+    }
+  }
+
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < n; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < n; ++i)
+    g.edge(i,(i+1)%n,grctk::Universe::singleton().create());
+  for(size_t i = 0; i < n; i += 7)
+    g.edge(i,(i+n/2)%n,grctk::Universe::singleton().create());
+
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::GraphRep rep(g,3);
+  for(size_t i = 0; i < n; ++i)
+    rep.aXD[g[i]] = positions[i];
+  grctk::PairPotBase::InputParams input(a3D,1.0,0.001,true,
+                                        true,errorBound,7);
+  PairPotBaseProbe probe(tune);
+  probe.prepare(input,rep);
+
+  // every ignored pair is farther than the cutoff, where phi0 < k*eps
+  // and its derivative alpha0 times that
+  yaatk::VectorXD grad(3);
+  for(size_t i = 0; i < n; ++i)
+  {
+    double energy = 0;
+    yaatk::VectorXD force(0.0,3);
+    size_t ignored = 0;
+    for(size_t j = 0; j < n; ++j)
+    {
+      if (j == i)
+        continue;
+      yaatk::VectorXD r(positions[i]-positions[j]);
+      double R = yaatk::module(r);
+      energy += phi.value(R,g.s(i,j));
+      force += r*(phi.derivative(R,g.s(i,j))/R);
+      if (!g.s(i,j) && R >= cutoff)
+        ++ignored;
+    }
+    REQUIRE(ignored > 0);
+    double approximate = probe.approximatePhi(i,rep);
+    REQUIRE(std::fabs(approximate - energy) <= ignored*tune.k*errorBound);
+    REQUIRE(approximate <= energy);
+    probe.approximateFi(i,rep,grad);
+    REQUIRE(yaatk::module(yaatk::VectorXD(grad - force))
+            <= ignored*tune.alpha0*tune.k*errorBound);
+  }
+
+  return true;
+}
+
+bool
+test_pair_pot_energy_trace()
+{
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 10; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 10; ++i)
+    g.edge(i,(i+1)%10,grctk::Universe::singleton().create());
+  g.edge(0,5,grctk::Universe::singleton().create());
+  g.edge(2,7,grctk::Universe::singleton().create());
+
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::PairPotBase::TuneParams tune;
+  for(int approximate = 0; approximate < 2; ++approximate)
+  {
+    grctk::PairPotBase::InputParams input(a3D,1.0,0.001,false,
+                                          approximate,1.0e-6,7);
+    grctk::GraphRep rep(g,3);
+    grctk::PairPotBase alg(tune);
+    alg(input,rep);
+
+    grctk::PPhi phi(tune.alpha0,tune.alpha1,tune.k,tune.r0);
+    double energy = 0;
+    for(size_t i = 0; i < g.size(); ++i)
+      for(size_t j = 0; j < g.size(); ++j)
+        if (j != i)
+          energy += phi(rep.aXD[g[j]],rep.aXD[g[i]],g.s(i,j));
+    REQUIRE(std::fabs(rep.energy - energy) < 1e-6*std::fabs(energy));
+
+    REQUIRE(rep.energyTrace.size() > 2);
+    REQUIRE(rep.energyTrace.back() == rep.energy);
+    for(size_t s = 1; s < rep.energyTrace.size(); ++s)
+      REQUIRE(rep.energyTrace[s] <= rep.energyTrace[s-1] + 1e-12);
+    REQUIRE(rep.energyTrace.back() < rep.energyTrace.front());
+  }
+
+  return true;
+}
+
+bool
+test_pair_pot_lbfgs()
+{
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 12; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 12; ++i)
+  {
+    g.edge(i,(i+1)%12,grctk::Universe::singleton().create());
+    if (i % 3 == 0)
+      g.edge(i,(i+5)%12,grctk::Universe::singleton().create());
+  }
+
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::PairPotBase::TuneParams tune;
+  grctk::PairPotBase::InputParams input(a3D,1.0,1e-6,false,false,1.0e-6,3,
+                                        grctk::PairPotBase::LBFGS);
+  grctk::GraphRep rep(g,2);
+  grctk::PairPotBase alg(tune);
+  alg(input,rep);
+
+  grctk::PPhi phi(tune.alpha0,tune.alpha1,tune.k,tune.r0);
+  double energy = 0;
+  std::vector<yaatk::VectorXD> grad(g.size(),yaatk::VectorXD(2));
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t j = 0; j < g.size(); ++j)
+      if (j != i)
+      {
+        energy += phi(rep.aXD[g[j]],rep.aXD[g[i]],g.s(i,j));
+        grad[i] += phi.grad(rep.aXD[g[i]],rep.aXD[g[j]],g.s(i,j));
+      }
+  REQUIRE(std::fabs(rep.energy - energy) < 1e-9*std::fabs(energy));
+  for(size_t i = 0; i < g.size(); ++i)
+    REQUIRE(yaatk::module(grad[i]) < 1e-3);
+
+  REQUIRE(rep.energyTrace.size() > 2);
+  for(size_t s = 1; s < rep.energyTrace.size(); ++s)
+    REQUIRE(rep.energyTrace[s] < rep.energyTrace[s-1]);
+
+  return true;
+}
+
+bool
+test_fast_exp()
+{
+  const double bounds[] = {1e-12, 1e-9, 1e-6, 1e-4};
+  for(size_t b = 0; b < sizeof(bounds)/sizeof(bounds[0]); ++b)
+  {
+    yaatk::FastExp fe(bounds[b]);
+    REQUIRE(fe.degree() < yaatk::FastExp::MAX_DEGREE);
+    for(double x = -50.0; x <= 5.0; x += 0.001)
+      REQUIRE(std::fabs(fe(x) - std::exp(x)) <= bounds[b]*std::exp(x));
+  }
+  yaatk::FastExp exact;
+  for(double x = -50.0; x <= 5.0; x += 0.001)
+    REQUIRE(std::fabs(exact(x) - std::exp(x)) <= 1e-15*std::exp(x));
+
+  // the kernel with a cutoff and approximate exp against PPhi with both
+  const size_t n = 29;
+  const size_t dim = 2;
+  std::vector<std::vector<size_t> > adjacent(n);
+  for(size_t i = 0; i < n; ++i)
+  {
+    adjacent[i].push_back((i + 1) % n);
+    adjacent[(i + 1) % n].push_back(i);
+  }
+  std::vector<yaatk::VectorXD> positions(n,yaatk::VectorXD(dim));
+  for(size_t i = 0; i < n; ++i)
+  {
+    positions[i][0] = 0.3*i;
+    positions[i][1] = 0.1*(i % 3);
+  }
+  yaatk::FastExp fe(1e-9);
+  grctk::PPhi phi(6.0,2.0,0.03,0.12);
+  phi.setExp(&fe);
+  phi.setCutoff(1.0);
+  for(int isa = grctk::PairKernel::ISA_SCALAR;
+      isa <= grctk::PairKernel::detectIsa(); ++isa)
+  {
+    grctk::PairKernel kernel;
+    kernel.setup(6.0,2.0,0.03,0.12,adjacent,dim,grctk::PairKernel::Isa(isa));
+    kernel.setApproximation(1e-9,1.0);
+    for(size_t i = 0; i < n; ++i)
+      kernel.setPosition(i,positions[i]);
+    for(size_t i = 0; i < n; ++i)
+    {
+      double energy = 0;
+      for(size_t j = 0; j < n; ++j)
+        if (j != i)
+        {
+          int adj = std::count(adjacent[i].begin(),adjacent[i].end(),j);
+          energy += phi(positions[j],positions[i],adj);
+        }
+      REQUIRE(std::fabs(kernel.evaluate(i,NULL) - energy) <
+              1e-8*(1 + std::fabs(energy)));
+    }
+  }
+
+  return true;
+}
+
+bool
+test_multilevel()
+{
+  // a 10x6 grid
+  const size_t w = 10, h = 6;
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < w*h; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t y = 0; y < h; ++y)
+    for(size_t x = 0; x < w; ++x)
+    {
+      if (x + 1 < w)
+        g.edge(y*w + x,y*w + x + 1,grctk::Universe::singleton().create());
+      if (y + 1 < h)
+        g.edge(y*w + x,(y + 1)*w + x,grctk::Universe::singleton().create());
+    }
+
+  grctk::Multilevel::AdjacencyLists adjacent(g.size());
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t j = 0; j < g.size(); ++j)
+      if (g.s(i,j))
+        adjacent[i].push_back(j);
+  std::vector<size_t> order;
+  for(size_t i = 0; i < g.size(); ++i)
+    order.push_back((i*7) % g.size());
+  std::vector<size_t> parent;
+  size_t matched =
+    grctk::Multilevel::matchingCoarsening(adjacent,order,parent);
+  REQUIRE(matched < g.size() && 2*matched >= g.size());
+  std::vector<size_t> members(matched,0);
+  for(size_t i = 0; i < g.size(); ++i)
+  {
+    REQUIRE(parent[i] < matched);
+    ++members[parent[i]];
+  }
+  for(size_t c = 0; c < matched; ++c)
+    REQUIRE(members[c] == 1 || members[c] == 2);
+  size_t independent =
+    grctk::Multilevel::independentSetCoarsening(adjacent,order,parent);
+  REQUIRE(independent < matched);
+  for(size_t i = 0; i < g.size(); ++i)
+    REQUIRE(parent[i] < independent);
+  grctk::Multilevel::AdjacencyLists coarse =
+    grctk::Multilevel::coarseAdjacency(adjacent,parent,independent);
+  for(size_t c = 0; c < coarse.size(); ++c)
+    for(size_t a = 0; a < coarse[c].size(); ++a)
+    {
+      size_t d = coarse[c][a];
+      REQUIRE(d != c);
+      REQUIRE(std::count(coarse[d].begin(),coarse[d].end(),c) == 1);
+    }
+
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::PairPotBase::TuneParams tune;
+  grctk::PairPotBase::InputParams input(a3D,1.0,0.001,false,false,1e-6,7);
+  grctk::GraphRep first(g,2), second(g,2);
+  {
+    grctk::Multilevel alg(tune);
+    alg(input,grctk::Multilevel::InputParams(8),first);
+  }
+  {
+    grctk::Multilevel alg(tune);
+    alg(input,grctk::Multilevel::InputParams(8),second);
+  }
+  REQUIRE(first.energy == second.energy);
+  REQUIRE(first.energyTrace.back() == first.energy);
+  for(size_t i = 0; i < g.size(); ++i)
+  {
+    REQUIRE(first.aXD[g[i]].size() == 2);
+    REQUIRE(first.aXD[g[i]][0] == second.aXD[g[i]][0]);
+    REQUIRE(first.aXD[g[i]][1] == second.aXD[g[i]][1]);
+  }
+  // the layout unfolds: adjacent vertices stay close to each other
+  double adjacentMean = 0, allMean = 0;
+  size_t adjacentCount = 0, allCount = 0;
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t j = i + 1; j < g.size(); ++j)
+    {
+      double r =
+        yaatk::module(yaatk::VectorXD(first.aXD[g[i]] - first.aXD[g[j]]));
+      allMean += r;
+      ++allCount;
+      if (g.s(i,j))
+      {
+        adjacentMean += r;
+        ++adjacentCount;
+      }
+    }
+  REQUIRE(adjacentMean/adjacentCount < 0.5*allMean/allCount);
+
+  return true;
+}
+
+bool
+test_spectral_positions()
+{
+  // a cycle: the lowest non-trivial eigenvalue 2 - 2cos(2pi/n) is double
+  // and its eigenvectors put the vertices on a circle
+  const size_t n = 24;
+  grctk::SpectralPositions::AdjacencyLists cycle(n);
+  for(size_t i = 0; i < n; ++i)
+  {
+    cycle[i].push_back((i + 1) % n);
+    cycle[(i + 1) % n].push_back(i);
+  }
+  const double lambda = 2.0 - 2.0*std::cos(2.0*M_PI/n);
+  // the second run is restarted many times
+  for(size_t basisSize = 0; basisSize <= 6; basisSize += 6)
+  {
+    grctk::SpectralPositions spectral;
+    std::vector<yaatk::VectorXD> positions;
+    spectral(cycle,2,
+             grctk::SpectralPositions::InputParams(basisSize,1000,1e-9),
+             positions);
+    REQUIRE(spectral.eigenvalues.size() == 2);
+    REQUIRE(std::fabs(spectral.eigenvalues[0] - lambda) < 1e-8);
+    REQUIRE(std::fabs(spectral.eigenvalues[1] - lambda) < 1e-8);
+    for(size_t i = 0; i < n; ++i)
+      REQUIRE(std::fabs(yaatk::module(positions[i]) - std::sqrt(2.0/n)) <
+              1e-6);
+  }
+
+  // two components: a path of 5 vertices and an isolated edge, 4 + 1
+  // non-trivial eigenvectors
+  grctk::SpectralPositions::AdjacencyLists forest(7);
+  for(size_t i = 0; i + 1 < 5; ++i)
+  {
+    forest[i].push_back(i + 1);
+    forest[i + 1].push_back(i);
+  }
+  forest[5].push_back(6);
+  forest[6].push_back(5);
+  {
+    grctk::SpectralPositions spectral;
+    std::vector<yaatk::VectorXD> positions;
+    spectral(forest,7,grctk::SpectralPositions::InputParams(0,100,1e-9),
+             positions);
+    REQUIRE(spectral.eigenvalues.size() == 5);
+    REQUIRE(positions.size() == 7 && positions[0].size() == 7);
+    REQUIRE(std::fabs(spectral.eigenvalues[0] -
+                      (2.0 - 2.0*std::cos(M_PI/5))) < 1e-8);
+    REQUIRE(std::fabs(spectral.eigenvalues[2] - 2.0) < 1e-8);
+    REQUIRE(std::fabs(spectral.eigenvalues[4] -
+                      (2.0 - 2.0*std::cos(4*M_PI/5))) < 1e-8);
+    for(size_t i = 0; i < 7; ++i)
+      REQUIRE(positions[i][5] == 0 && positions[i][6] == 0);
+  }
+
+  // a grid of 40x40 is coarsened first; its two lowest modes coincide
+  grctk::SpectralPositions::AdjacencyLists grid(1600);
+  for(size_t y = 0; y < 40; ++y)
+    for(size_t x = 0; x < 40; ++x)
+    {
+      size_t v = y*40 + x;
+      if (x + 1 < 40)
+      {
+        grid[v].push_back(v + 1);
+        grid[v + 1].push_back(v);
+      }
+      if (y + 1 < 40)
+      {
+        grid[v].push_back(v + 40);
+        grid[v + 40].push_back(v);
+      }
+    }
+  {
+    grctk::SpectralPositions spectral;
+    std::vector<yaatk::VectorXD> positions;
+    spectral(grid,3,grctk::SpectralPositions::InputParams(0,1000,1e-7),
+             positions);
+    const double mode = 2.0 - 2.0*std::cos(M_PI/40);
+    REQUIRE(std::fabs(spectral.eigenvalues[0] - mode) < 1e-6);
+    REQUIRE(std::fabs(spectral.eigenvalues[1] - mode) < 1e-6);
+    REQUIRE(std::fabs(spectral.eigenvalues[2] - 2*mode) < 1e-6);
+  }
+
+  // a warm start of PairPotBase
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 30; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 30; ++i)
+    g.edge(i,(i + 1) % 30,grctk::Universe::singleton().create());
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::PairPotBase::TuneParams tune;
+  grctk::PairPotBase::InputParams input(
+    a3D,1.0,0.001,false,false,1e-6,3,grctk::PairPotBase::COORDINATE_DESCENT,
+    0,0,true);
+  grctk::GraphRep rep(g,2);
+  grctk::PairPotBase alg(tune);
+  alg(input,rep);
+  REQUIRE(rep.energyTrace.size() > 1);
+  REQUIRE(rep.energy < rep.energyTrace.front());
+
+  return true;
+}
+
+bool
+test_graph_multi_rep_storage()
+{
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 5; ++i)
+    g += grctk::Universe::singleton().create();
+  g.edge(0,1,grctk::Universe::singleton().create());
+
+  grctk::GraphMultiRep multiRep(g,3);
+  for(size_t r = 0; r < 300; ++r)
+  {
+    grctk::GraphRep rep(g,3);
+    for(size_t i = 0; i < g.size(); ++i)
+    {
+      rep.aXD[g[i]].resize(3);
+      for(size_t d = 0; d < 3; ++d)
+        rep.aXD[g[i]][d] = r*100.0 + i*10.0 + d;
+    }
+    rep.energy = -double(r);
+    multiRep.addRep(rep);
+    if (r == 100)
+      multiRep.mapToFile("test_graph_multi_rep_storage.tmp");
+  }
+  REQUIRE(multiRep.size() == 300);
+  REQUIRE(multiRep.findRepWithMinEnergy() == 299);
+
+  // copies share the storage until they grow
+  grctk::GraphMultiRep copy(multiRep);
+  grctk::GraphRep extra(g,3);
+  for(size_t i = 0; i < g.size(); ++i)
+    extra.aXD[g[i]] = yaatk::VectorXD(-1.0,3);
+  copy.addRep(extra);
+  REQUIRE(copy.size() == 301 && multiRep.size() == 300);
+  REQUIRE(copy.view(300)[4][2] == -1.0);
+
+  for(size_t r = 0; r < 300; r += 7)
+  {
+    grctk::GraphMultiRep::RepView view = multiRep.view(r);
+    std::vector<yaatk::VectorXD> rep = multiRep.getRep(r);
+    std::vector<yaatk::Vector3D> rep3D = multiRep.getRep3DProj(r);
+    REQUIRE(view.size() == 5 && view.dimensions() == 3);
+    for(size_t i = 0; i < g.size(); ++i)
+      for(size_t d = 0; d < 3; ++d)
+      {
+        REQUIRE(view[i][d] == r*100.0 + i*10.0 + d);
+        REQUIRE(rep[i][d] == view[i][d]);
+        REQUIRE(rep3D[i].X(d) == view[i][d]);
+        REQUIRE(copy.view(r)[i][d] == view[i][d]);
+      }
+  }
+
+  return true;
+}
+
+bool
+test_pair_pot_early_stop()
+{
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 7; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 7; ++i)
+    g.edge(i,(i+1)%7,grctk::Universe::singleton().create());
+  g.edge(0,3,grctk::Universe::singleton().create());
+
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::PairPotBase::TuneParams tune;
+  grctk::PairPotBase::InputParams inputBase(a3D,1.0,0.001);
+  grctk::GraphMultiRep serial(g,2);
+  grctk::GraphMultiRep parallel(g,2);
+  size_t skipped;
+  {
+    grctk::PairPot alg(tune);
+    alg(inputBase,grctk::PairPot::InputParams(20,false,42,1,false,2),serial);
+    skipped = alg.skippedStarts;
+  }
+  {
+    grctk::PairPot alg(tune);
+    alg(inputBase,grctk::PairPot::InputParams(20,false,42,3,false,2),parallel);
+    REQUIRE(alg.skippedStarts == skipped);
+  }
+
+  // a heptagon with a chord has few minima, two starts in a row
+  // without improvement come soon
+  REQUIRE(skipped > 0);
+  REQUIRE(serial.size() == 20 - skipped);
+  REQUIRE(serial.size() == parallel.size());
+  for(size_t r = 0; r < serial.size(); ++r)
+    REQUIRE(serial.energies[r] == parallel.energies[r]);
+
+  grctk::GraphMultiRep single(g,2);
+  {
+    grctk::PairPot alg(tune);
+    alg(inputBase,grctk::PairPot::InputParams(5,false,42,2,false,0,1),single);
+    REQUIRE(alg.skippedStarts == 4);
+  }
+  REQUIRE(single.size() == 1);
+  REQUIRE(single.energies[0] == serial.energies[0]);
+
+  return true;
+}
+
+// the pairs of edges without common ends that cross each other
+static
+size_t
+countCrossings(const grctk::AdjMatrix& g,
+               const grctk::Attribute<yaatk::Vector2D>& a2D)
+{
+  size_t crossings = 0;
+  for(size_t i1 = 0; i1 < g.size(); ++i1)
+    for(size_t j1 = i1+1; j1 < g.size(); ++j1)
+      for(size_t i2 = i1+1; i2 < g.size(); ++i2)
+        for(size_t j2 = i2+1; j2 < g.size(); ++j2)
+          if (g.s(i1,j1) && g.s(i2,j2) &&
+              i2 != j1 && j2 != j1 &&
+              yaatk::areIntersecting(a2D[g[i1]],a2D[g[j1]],
+                                     a2D[g[i2]],a2D[g[j2]]))
+            ++crossings;
+  return crossings;
+}
+
+bool
+test_opti_intersect()
+{
+  // a hexagon numbered so that every edge is a long chord of the circle
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 6; ++i)
+    g += grctk::Universe::singleton().create();
+  size_t cycle[6] = {0,3,1,4,2,5};
+  for(size_t i = 0; i < 6; ++i)
+    g.edge(cycle[i],cycle[(i+1)%6],grctk::Universe::singleton().create());
+  g.edge(0,1,grctk::Universe::singleton().create());
+
+  grctk::Attribute<yaatk::Vector2D> a2D;
+  grctk::OptiIntersect alg;
+  alg(g,6,a2D);
+
+  REQUIRE(countCrossings(g,a2D) == 0);
+
+  return true;
+}
+
+bool
+test_opti_intersect_search()
+{
+  // an outerplanar graph, a 16-cycle with nested chords, numbered at
+  // random
+  const size_t n = 16;
+  size_t cycle[n] = {5,12,0,9,14,3,7,1,11,15,6,2,10,4,13,8};
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < n; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < n; ++i)
+    g.edge(cycle[i],cycle[(i+1)%n],grctk::Universe::singleton().create());
+  g.edge(cycle[0],cycle[8],grctk::Universe::singleton().create());
+  g.edge(cycle[2],cycle[6],grctk::Universe::singleton().create());
+  g.edge(cycle[9],cycle[15],grctk::Universe::singleton().create());
+  g.edge(cycle[10],cycle[14],grctk::Universe::singleton().create());
+
+  grctk::Attribute<yaatk::Vector2D> serial;
+  grctk::Attribute<yaatk::Vector2D> parallel;
+  {
+    grctk::OptiIntersect alg;
+    alg(g,grctk::OptiIntersect::SearchParams(20000,0.0,3,1,7),serial);
+  }
+  {
+    grctk::OptiIntersect alg;
+    alg(g,grctk::OptiIntersect::SearchParams(20000,0.0,3,3,7),parallel);
+  }
+
+  for(size_t i = 0; i < n; ++i)
+    REQUIRE(serial[g[i]].x == parallel[g[i]].x &&
+            serial[g[i]].y == parallel[g[i]].y);
+  REQUIRE(countCrossings(g,serial) == 0);
+
+  return true;
+}
+
+bool
+test_layout_metrics()
+{
+  // the grid count against all the pairs of edges, random segments
+  std::vector<yaatk::Vector2D> points(60);
+  for(size_t i = 0; i < points.size(); ++i)
+    points[i] = yaatk::Vector2D(std::sin(i*12.9898)*43758.5453 -
+                                std::floor(std::sin(i*12.9898)*43758.5453),
+                                std::sin(i*78.233)*43758.5453 -
+                                std::floor(std::sin(i*78.233)*43758.5453));
+  std::vector<grctk::LayoutMetrics::Edge> edges;
+  for(size_t i = 0; i < points.size(); ++i)
+    for(size_t j = i+1; j < points.size(); j += 7)
+      edges.push_back(grctk::LayoutMetrics::Edge(i,j));
+  size_t crossings = 0;
+  for(size_t e1 = 0; e1 < edges.size(); ++e1)
+    for(size_t e2 = e1+1; e2 < edges.size(); ++e2)
+      if (edges[e1].first != edges[e2].first &&
+          edges[e1].first != edges[e2].second &&
+          edges[e1].second != edges[e2].first &&
+          edges[e1].second != edges[e2].second &&
+          yaatk::areIntersecting(points[edges[e1].first],points[edges[e1].second],
+                                 points[edges[e2].first],points[edges[e2].second]))
+        ++crossings;
+  REQUIRE(crossings > 0);
+  REQUIRE(grctk::LayoutMetrics::crossingsCount(edges,points) == crossings);
+
+  // a path: along a line, then folded
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < 6; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i + 1 < 6; ++i)
+    g.edge(i,i+1,grctk::Universe::singleton().create());
+  grctk::GraphMultiRep multiRep(g,2);
+  {
+    grctk::GraphRep folded(g,2);
+    double x[6] = {0,2,0,2,0,2};
+    for(size_t i = 0; i < 6; ++i)
+    {
+      yaatk::VectorXD position(2);
+      position[0] = x[i];
+      position[1] = (i % 2 == 0) ? i*0.3 : 1.2 - i*0.3;
+      folded.aXD[g[i]] = position;
+    }
+    multiRep.addRep(folded);
+    grctk::GraphRep straight(g,2);
+    for(size_t i = 0; i < 6; ++i)
+    {
+      yaatk::VectorXD position(0.0,2);
+      position[0] = 3.0*i;
+      straight.aXD[g[i]] = position;
+    }
+    multiRep.addRep(straight);
+  }
+
+  std::vector<grctk::LayoutMetrics::Metrics> serial;
+  std::vector<grctk::LayoutMetrics::Metrics> parallel;
+  std::vector<grctk::LayoutMetrics::Metrics> defaults;
+  {
+    grctk::LayoutMetrics alg;
+    alg(multiRep,grctk::LayoutMetrics::InputParams(0,1),serial);
+    alg(multiRep,grctk::LayoutMetrics::InputParams(2,3),parallel);
+    alg(multiRep,grctk::LayoutMetrics::InputParams(),defaults);
+  }
+  REQUIRE(serial.size() == 2 && parallel.size() == 2);
+  REQUIRE(serial[0].crossings > 0);
+  REQUIRE(serial[1].crossings == 0);
+  REQUIRE(std::fabs(serial[1].stress) < 1e-12);
+  REQUIRE(serial[0].stress > 0.01);
+  REQUIRE(std::fabs(serial[1].edgeLengthMean - 3.0) < 1e-12);
+  REQUIRE(std::fabs(serial[1].edgeLengthVariance) < 1e-12);
+  REQUIRE(grctk::LayoutMetrics::findBest(serial) == 1);
+  for(size_t r = 0; r < 2; ++r)
+  {
+    REQUIRE(serial[r].crossings == parallel[r].crossings);
+    REQUIRE(serial[r].edgeLengthVariance == parallel[r].edgeLengthVariance);
+  }
+  REQUIRE(std::fabs(parallel[1].stress) < 1e-12);
+  // fewer vertices than the default number of sources: exact
+  for(size_t r = 0; r < 2; ++r)
+    REQUIRE(defaults[r].stress == serial[r].stress);
+
+  return true;
+}
+
+bool
+test_stress_majorization()
+{
+  // a 10x10 grid: the graph distances are the Manhattan ones, which no
+  // layout has, so the stress stays above zero; the edges come out of
+  // about the same length, longer than the given one
+  const size_t w = 10, h = 10;
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < w*h; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t y = 0; y < h; ++y)
+    for(size_t x = 0; x < w; ++x)
+    {
+      if (x+1 < w)
+        g.edge(y*w+x,y*w+x+1,grctk::Universe::singleton().create());
+      if (y+1 < h)
+        g.edge(y*w+x,(y+1)*w+x,grctk::Universe::singleton().create());
+    }
+
+  for(size_t pivots = 0; pivots <= 16; pivots += 16)
+  {
+    grctk::GraphRep rep(g,2);
+    grctk::StressMajorization alg;
+    alg(grctk::StressMajorization::InputParams(500,1e-7,pivots,0.5),rep);
+    REQUIRE(alg.iterations > 0 && alg.iterations < 500);
+    REQUIRE(rep.energyTrace.size() == alg.iterations + 1);
+    // a majorization step never increases the full stress; a pivot
+    // does not see the vertices it stands for, so the sparse one may
+    if (pivots == 0)
+      for(size_t i = 1; i < rep.energyTrace.size(); ++i)
+        REQUIRE(rep.energyTrace[i] <= rep.energyTrace[i-1] + 1e-12);
+    REQUIRE(rep.energy == rep.energyTrace.back());
+    REQUIRE(rep.energy < 0.05*rep.energyTrace.front());
+    for(size_t i = 0; i < w*h; ++i)
+      for(size_t j = i+1; j < w*h; ++j)
+        if (g.s(i,j))
+        {
+          double l = yaatk::module(
+            yaatk::VectorXD(rep.aXD[g[i]] - rep.aXD[g[j]]));
+          REQUIRE(l > 0.5 && l < 0.75);
+        }
+  }
+
+  // a path on a line, from the spectral start: the stress goes to zero
+  grctk::AdjMatrix path;
+  for(size_t i = 0; i < 8; ++i)
+    path += grctk::Universe::singleton().create();
+  for(size_t i = 0; i + 1 < 8; ++i)
+    path.edge(i,i+1,grctk::Universe::singleton().create());
+  grctk::GraphRep rep(path,1);
+  grctk::StressMajorization alg;
+  alg(grctk::StressMajorization::InputParams(1000,1e-12,0,1.0,false,true),
+      rep);
+  REQUIRE(rep.energy < 1e-12);
+
+  return true;
+}
+
+bool
+test_incremental_layout()
+{
+  // a cycle laid out from scratch, then one vertex dragged away
+  const size_t n = 30;
+  grctk::AdjMatrix g;
+  for(size_t i = 0; i < n; ++i)
+    g += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < n; ++i)
+    g.edge(i,(i + 1) % n,grctk::Universe::singleton().create());
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  grctk::PairPotBase::TuneParams tune;
+  grctk::GraphRep initial(g,2);
+  grctk::PairPotBase base(tune);
+  base(grctk::PairPotBase::InputParams(
+         a3D,1.0,0.001,false,false,1e-6,3,
+         grctk::PairPotBase::COORDINATE_DESCENT,0,0,true),
+       initial);
+  for(size_t i = 0; i < n; ++i)
+    a3D[g[i]] = yaatk::Vector3D(initial.aXD[g[i]][0],initial.aXD[g[i]][1],0);
+  a3D[g[0]].x += 0.5;
+  a3D[g[0]].y += 0.5;
+
+  std::vector<size_t> region;
+  std::vector<std::vector<size_t> > adjacent;
+  grctk::IncrementalLayout::neighbourhood(
+    g,std::vector<size_t>(1,0),2,region,adjacent);
+  REQUIRE(region.size() == 5);
+  std::sort(region.begin(),region.end());
+  REQUIRE(region[0] == 0 && region[1] == 1 && region[2] == 2);
+  REQUIRE(region[3] == n-2 && region[4] == n-1);
+  for(size_t r = 0; r < adjacent.size(); ++r)
+    REQUIRE(adjacent[r].size() == 2);
+
+  grctk::GraphRep rep(g,2);
+  grctk::IncrementalLayout alg(tune);
+  alg(grctk::IncrementalLayout::InputParams(a3D,2),
+      std::vector<size_t>(1,0),rep);
+  REQUIRE(alg.region.size() == 5);
+  REQUIRE(rep.energyTrace.size() > 1);
+  for(size_t i = 1; i < rep.energyTrace.size(); ++i)
+    REQUIRE(rep.energyTrace[i] <= rep.energyTrace[i-1]);
+  REQUIRE(rep.energy == rep.energyTrace.back());
+  REQUIRE(rep.energy < rep.energyTrace.front());
+  // the frozen vertices stay, the dragged one comes back to its
+  // neighbours
+  for(size_t i = 3; i + 2 < n; ++i)
+  {
+    REQUIRE(rep.aXD[g[i]][0] == a3D[g[i]].x);
+    REQUIRE(rep.aXD[g[i]][1] == a3D[g[i]].y);
+  }
+  for(size_t k = 1; k < n; k += n-2)
+  {
+    double before = std::sqrt(yaatk::SQR(a3D[g[0]].x - a3D[g[k]].x) +
+                              yaatk::SQR(a3D[g[0]].y - a3D[g[k]].y));
+    double after = yaatk::module(
+      yaatk::VectorXD(rep.aXD[g[0]] - rep.aXD[g[k]]));
+    REQUIRE(after < 0.5*before);
+  }
+
+  return true;
+}
+
+bool
+test_graph_products()
+{
+  {
+    // the batch takes the freed ids first, as create() would
+    grctk::Universe u;
+    std::vector<grctk::Object> objects;
+    for(size_t i = 0; i < 5; ++i)
+    {
+      objects.push_back(u.create());
+      objects.back().addOwner();
+    }
+    objects[1].removeOwner();
+    objects[3].removeOwner();
+    std::vector<grctk::Object> batch = u.createVector(4);
+    REQUIRE(batch.size() == 4);
+    REQUIRE(batch[0].id() == 2 && batch[1].id() == 4);
+    REQUIRE(batch[2].id() == 6 && batch[3].id() == 7);
+    grctk::Object last = u.create();
+    REQUIRE(last.id() == 8);
+    for(size_t k = 0; k < batch.size(); ++k)
+    {
+      batch[k].addOwner();
+      batch[k].removeOwner();
+    }
+    for(size_t i = 0; i < 5; i += 2)
+      objects[i].removeOwner();
+    last.addOwner();
+    last.removeOwner();
+  }
+
+  // every product against its definition; g2 spans two bitset words
+  grctk::AdjMatrix g1, g2;
+  for(size_t i = 0; i < 5; ++i)
+    g1 += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 70; ++i)
+    g2 += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < g1.size(); ++i)
+    for(size_t j = i+1; j < g1.size(); ++j)
+      if ((i*7 + j*3) % 5 < 2)
+        g1.edge(i,j,grctk::Universe::singleton().create());
+  for(size_t i = 0; i < g2.size(); ++i)
+    for(size_t j = i+1; j < g2.size(); ++j)
+      if ((i*13 + j*11) % 17 < 3 || j == i+1)
+        g2.edge(i,j,grctk::Universe::singleton().create());
+
+  std::vector<grctk::AdjMatrix> products;
+  products.push_back(grctk::CartesianProduct()(g1,g2));
+  products.push_back(grctk::TensorProduct()(g1,g2));
+  products.push_back(grctk::StrongProduct()(g1,g2));
+  products.push_back(grctk::LexicographicalProduct()(g1,g2));
+  const size_t n2 = g2.size();
+  for(size_t k = 0; k < products.size(); ++k)
+  {
+    const grctk::AdjMatrix& g = products[k];
+    REQUIRE(g.size() == g1.size()*n2);
+    std::set<grctk::Object> edges;
+    for(size_t u = 0; u < g.size(); ++u)
+      for(size_t v = 0; v < g.size(); ++v)
+      {
+        size_t i = u/n2, p = u%n2, j = v/n2, q = v%n2;
+        bool cartesian = (i == j && g2.s(p,q)) || (p == q && g1.s(i,j));
+        bool tensor = g1.s(i,j) && g2.s(p,q);
+        bool expected = false;
+        if (k == 0)
+          expected = cartesian;
+        else if (k == 1)
+          expected = tensor;
+        else if (k == 2)
+          expected = cartesian || tensor;
+        else
+          expected = g1.s(i,j) || (i == j && g2.s(p,q));
+        REQUIRE(g.s(u,v) == expected);
+        if (u < v && g.s(u,v))
+          edges.insert(g.edge(u,v));
+      }
+    // distinct edge objects
+    size_t count = 0;
+    for(size_t u = 0; u < g.size(); ++u)
+      for(size_t v = u+1; v < g.size(); ++v)
+        count += g.s(u,v) ? 1 : 0;
+    REQUIRE(edges.size() == count);
+  }
+
+  return true;
+}
+
+bool
+test_product_views()
+{
+  // a path and a separate edge, times a 5-cycle
+  grctk::AdjMatrix g1, g2;
+  for(size_t i = 0; i < 6; ++i)
+    g1 += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 5; ++i)
+    g2 += grctk::Universe::singleton().create();
+  for(size_t i = 0; i + 1 < 4; ++i)
+    g1.edge(i,i+1,grctk::Universe::singleton().create());
+  g1.edge(4,5,grctk::Universe::singleton().create());
+  for(size_t i = 0; i < 5; ++i)
+    g2.edge(i,(i+1)%5,grctk::Universe::singleton().create());
+
+  std::vector<grctk::AdjMatrix> built;
+  std::vector<unsigned> terms;
+  built.push_back(grctk::CartesianProduct()(g1,g2));
+  terms.push_back(grctk::CartesianProduct::terms);
+  built.push_back(grctk::TensorProduct()(g1,g2));
+  terms.push_back(grctk::TensorProduct::terms);
+  built.push_back(grctk::StrongProduct()(g1,g2));
+  terms.push_back(grctk::StrongProduct::terms);
+  built.push_back(grctk::LexicographicalProduct()(g1,g2));
+  terms.push_back(grctk::LexicographicalProduct::terms);
+  for(size_t k = 0; k < built.size(); ++k)
+  {
+    grctk::ProductView view(g1,g2,terms[k]);
+    grctk::AdjMatrixView matrix(built[k]);
+    REQUIRE(view.size() == matrix.size());
+    std::vector<size_t> a, b;
+    for(size_t u = 0; u < view.size(); ++u)
+    {
+      for(size_t v = 0; v < view.size(); ++v)
+        REQUIRE(view.s(u,v) == matrix.s(u,v));
+      view.neighbours(u,a);
+      matrix.neighbours(u,b);
+      std::sort(a.begin(),a.end());
+      REQUIRE(a == b);
+      REQUIRE(view.degree(u) == b.size());
+    }
+
+    grctk::ConComp conComp;
+    std::vector<size_t> ca, cb;
+    REQUIRE(conComp(view,ca) == conComp(matrix,cb));
+    REQUIRE(ca == cb);
+    grctk::Distances distances;
+    for(size_t u = 0; u < view.size(); u += 7)
+    {
+      distances(view,u,a);
+      distances(matrix,u,b);
+      REQUIRE(a == b);
+    }
+  }
+  grctk::ConComp conComp;
+  std::vector<size_t> component;
+  REQUIRE(conComp(grctk::ProductView(g1,g2,grctk::CartesianProduct::terms),
+                  component) == 2);
+
+  // 40000 vertices, never built: the distances of the Cartesian
+  // product add up, those of the strong one take the maximum
+  grctk::AdjMatrix c;
+  for(size_t i = 0; i < 200; ++i)
+    c += grctk::Universe::singleton().create();
+  for(size_t i = 0; i < 200; ++i)
+    c.edge(i,(i+1)%200,grctk::Universe::singleton().create());
+  grctk::Distances distances;
+  REQUIRE(distances.eccentricity(
+            grctk::ProductView(c,c,grctk::CartesianProduct::terms),0) == 200);
+  REQUIRE(distances.eccentricity(
+            grctk::ProductView(c,c,grctk::StrongProduct::terms),0) == 100);
+
+  return true;
+}
+
+bool
+test_product_positions()
+{
+  grctk::Attribute<yaatk::Vector3D> a3D;
+  for(size_t wide = 0; wide < 2; ++wide)
+  {
+    grctk::AdjMatrix g1, g2;
+    for(size_t i = 0; i < 4; ++i)
+    {
+      g1 += grctk::Universe::singleton().create();
+      a3D[g1[i]] = yaatk::Vector3D(0.3*i,0.1*i*i,0.05*i);
+    }
+    for(size_t j = 0; j < 6; ++j)
+    {
+      g2 += grctk::Universe::singleton().create();
+      a3D[g2[j]] = wide ?
+        yaatk::Vector3D(1.0*j,0.2*(j%2),0) : yaatk::Vector3D(0.2*(j%3),0.7*j,0);
+    }
+    for(size_t i = 0; i + 1 < 4; ++i)
+      g1.edge(i,i+1,grctk::Universe::singleton().create());
+    for(size_t j = 0; j + 1 < 6; ++j)
+      g2.edge(j,j+1,grctk::Universe::singleton().create());
+
+    grctk::AdjMatrix g = grctk::StrongProduct()(g1,g2,a3D);
+    REQUIRE(g.size() == 24);
+    // the placement the factors' geometry used to be recomputed for
+    yaatk::Vector3D g1dims = grctk::dimensions(g1,a3D);
+    yaatk::Vector3D g2dims = grctk::dimensions(g2,a3D);
+    yaatk::Vector3D center = grctk::massCenter(g2,a3D);
+    double ratio = std::min(g1dims.x/g2dims.x,g1dims.y/g2dims.y);
+    std::vector<yaatk::Vector3D> positions1, positions2, positions;
+    for(size_t i = 0; i < 4; ++i)
+      positions1.push_back(a3D[g1[i]]);
+    for(size_t j = 0; j < 6; ++j)
+      positions2.push_back(a3D[g2[j]]);
+    grctk::Product::productPositions(positions1,positions2,positions);
+    for(size_t i = 0; i < 4; ++i)
+      for(size_t j = 0; j < 6; ++j)
+      {
+        yaatk::Vector3D expected = a3D[g1[i]];
+        if (g2dims.x/g2dims.y > 1.0)
+        {
+          expected.x -= 1.5*g1dims.x*j;
+          expected.y -= 1.5*(a3D[g2[j]].y - center.y)*ratio;
+        }
+        else
+        {
+          expected.x += 1.5*(a3D[g2[j]].x - center.x)*ratio;
+          expected.y -= 1.5*g1dims.y*j;
+        }
+        const yaatk::Vector3D& placed = a3D[g[i*6 + j]];
+        REQUIRE(std::fabs(placed.x - expected.x) < 1e-12);
+        REQUIRE(std::fabs(placed.y - expected.y) < 1e-12);
+        REQUIRE(placed.z == expected.z);
+        REQUIRE(positions[i*6 + j] == placed);
+      }
+  }
+
+  return true;
+}
+
+bool
+test_gen_random()
+{
+  typedef grctk::GenRandom::InputParams P;
+  grctk::GenRandom gen;
+  grctk::GenRandom::EdgeList edges, again;
+
+  // every pair once: the complete graph
+  gen(P(grctk::GenRandom::GNM,7,21,0,5),edges);
+  REQUIRE(edges.size() == 21);
+  for(size_t k = 0; k < edges.size(); ++k)
+    REQUIRE(grctk::GenRandom::pairIndex(7,edges[k].first,edges[k].second)
+            == k);
+
+  for(size_t model = 0; model < 3; ++model)
+  {
+    P input(grctk::GenRandom::Model(model),300,450,0.01,7);
+    gen(input,edges);
+    gen(input,again);
+    REQUIRE(edges == again);
+    std::set<std::pair<size_t,size_t> > distinct(edges.begin(),edges.end());
+    REQUIRE(distinct.size() == edges.size());
+    for(size_t k = 0; k < edges.size(); ++k)
+      REQUIRE(edges[k].first < edges[k].second && edges[k].second < 300);
+    if (model != grctk::GenRandom::GNP)
+    {
+      REQUIRE(edges.size() == 450);
+    }
+    else
+    {
+      // 448.5 expected, the standard deviation about 21
+      REQUIRE(edges.size() > 340 && edges.size() < 560);
+    }
+  }
+
+  // connected with a single edge to spare, and as a bare tree
+  for(size_t ec = 299; ec <= 300; ++ec)
+  {
+    grctk::AdjMatrix g = gen(P(grctk::GenRandom::SPANNING_TREE,300,ec,0,11));
+    REQUIRE(g.size() == 300);
+    grctk::ConComp conComp;
+    std::vector<size_t> component;
+    REQUIRE(conComp(grctk::AdjMatrixView(g),component) == 1);
+  }
+
+  gen(P(grctk::GenRandom::GNP,40,0,1.0,1),edges);
+  REQUIRE(edges.size() == 40*39/2);
+  gen(P(grctk::GenRandom::GNP,40,0,0.0,1),edges);
+  REQUIRE(edges.empty());
+
+  grctk::AdjMatrix g = gen(30,35,true);
+  size_t count = 0;
+  for(size_t i = 0; i < g.size(); ++i)
+    for(size_t j = i+1; j < g.size(); ++j)
+      count += g.s(i,j) ? 1 : 0;
+  REQUIRE(count == 35);
+
+  return true;
+}
+
+bool
+test_gen_degree_sequence()
+{
+  typedef grctk::GenDegreeSequence::InputParams P;
+  grctk::GenDegreeSequence gen;
+
+  REQUIRE(grctk::GenDegreeSequence::isGraphical(std::vector<size_t>(4,3)));
+  REQUIRE(!grctk::GenDegreeSequence::isGraphical(std::vector<size_t>(3,1)));
+  REQUIRE(!grctk::GenDegreeSequence::isGraphical(std::vector<size_t>(4,4)));
+  std::vector<size_t> degrees(4,3);
+  degrees[3] = 1;
+  REQUIRE(!grctk::GenDegreeSequence::isGraphical(degrees));
+  degrees.assign(5,1);
+  degrees[0] = 4;
+  REQUIRE(grctk::GenDegreeSequence::isGraphical(degrees));
+
+  // sparse, dense and complete regular ones, and a star with a tail
+  size_t sizes[] = {10, 60, 30, 12};
+  size_t degreesOf[] = {3, 4, 27, 11};
+  for(size_t t = 0; t < 5; ++t)
+  {
+    if (t < 4)
+      degrees.assign(sizes[t],degreesOf[t]);
+    else
+    {
+      degrees.assign(7,1);
+      degrees[0] = 5;
+      degrees[1] = 2;
+    }
+    P input(degrees,t+1);
+    grctk::AdjMatrix g = gen(input);
+    REQUIRE(g.size() == input.inp_Degrees.size());
+    for(size_t i = 0; i < g.size(); ++i)
+    {
+      REQUIRE(!g.s(i,i));
+      REQUIRE(g.vertexDegree(i) == input.inp_Degrees[i]);
+    }
+  }
+
+  grctk::GenRandom::EdgeList edges, again;
+  grctk::GenDegreeSequence::sample(std::vector<size_t>(40,5),3,edges);
+  grctk::GenDegreeSequence::sample(std::vector<size_t>(40,5),3,again);
+  REQUIRE(edges.size() == 100 && edges == again);
+
+  // the file does not depend on the number of threads
+  const char* names[] = {"test_gen_degree_sequence_1.tmp",
+                         "test_gen_degree_sequence_3.tmp"};
+  for(size_t f = 0; f < 2; ++f)
+  {
+    grctk::BinCodeFileWriter writer(names[f]);
+    gen(P(16,3,77,1+2*f),9,writer);
+    REQUIRE(writer.numberOfGraphs() == 9);
+  }
+  grctk::BinCodeFileReader single(names[0]), pooled(names[1]);
+  REQUIRE(single.numberOfGraphs() == 9 && pooled.numberOfGraphs() == 9);
+  REQUIRE(single.numberOfEdges() == 24 && single.checksumIsCorrect());
+  std::ostringstream os1, os3;
+  for(unsigned long i = 0; i < 9; ++i)
+  {
+    single.getCode(i).write(os1);
+    pooled.getCode(i).write(os3);
+    grctk::AdjMatrix g = pooled.getGraph(i);
+    for(size_t v = 0; v < g.size(); ++v)
+      REQUIRE(g.vertexDegree(v) == 3);
+  }
+  REQUIRE(os1.str() == os3.str());
+  std::remove(names[0]);
+  std::remove(names[1]);
+
+  return true;
+}
+
 int main(int argc, char *argv[])
 {
   PERFORM_TEST(test_square_matrix());
   PERFORM_TEST(test_triangular_square_matrix());
   PERFORM_TEST(test_AdjMatrix());
+  PERFORM_TEST(test_hybrid_rational());
+  PERFORM_TEST(test_value_ranking());
+  PERFORM_TEST(test_edge_orbits());
+  PERFORM_TEST(test_pipeline());
+  PERFORM_TEST(test_pair_pot_approximation());
+  PERFORM_TEST(test_pair_kernel());
+  PERFORM_TEST(test_pair_pot_multistart());
+  PERFORM_TEST(test_pair_pot_energy_trace());
+  PERFORM_TEST(test_pair_pot_lbfgs());
+  PERFORM_TEST(test_fast_exp());
+  PERFORM_TEST(test_multilevel());
+  PERFORM_TEST(test_spectral_positions());
+  PERFORM_TEST(test_graph_multi_rep_storage());
+  PERFORM_TEST(test_pair_pot_early_stop());
+  PERFORM_TEST(test_opti_intersect());
+  PERFORM_TEST(test_opti_intersect_search());
+  PERFORM_TEST(test_layout_metrics());
+  PERFORM_TEST(test_stress_majorization());
+  PERFORM_TEST(test_incremental_layout());
+  PERFORM_TEST(test_graph_products());
+  PERFORM_TEST(test_product_views());
+  PERFORM_TEST(test_product_positions());
+  PERFORM_TEST(test_gen_random());
+  PERFORM_TEST(test_gen_degree_sequence());
 
   return 0;
 }
@@ -0,0 +1,141 @@
+/*
+   The BoundedQueue class.
+
+   Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+   This file is part of YAATK, Yet another auxiliary toolkit.
+
+   YAATK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   YAATK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with YAATK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef yaatk_BoundedQueue_hpp
+#define yaatk_BoundedQueue_hpp
+
+#include <atomic>
+#include <cstddef>
+
+namespace yaatk
+{
+
+/*
+  Bounded multi-producer multi-consumer lock-free queue (D. Vyukov's
+  array-based algorithm). Every cell carries a sequence number telling
+  whether it is ready to be written or read in the current lap, so
+  producers and consumers only contend on one compare-and-swap each.
+
+  tryPush() and tryPop() never block; callers decide how to wait.
+  The capacity is rounded up to a power of two.
+*/
+template <typename T>
+class BoundedQueue
+{
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  enum { cacheLineSize = 64 };
+
+  Cell* buffer;
+  size_t mask;
+  char pad0[cacheLineSize];
+  std::atomic<size_t> enqueuePos;
+  char pad1[cacheLineSize];
+  std::atomic<size_t> dequeuePos;
+  char pad2[cacheLineSize];
+
+  BoundedQueue(const BoundedQueue&);
+  BoundedQueue& operator=(const BoundedQueue&);
+public:
+  explicit BoundedQueue(size_t capacity);
+  ~BoundedQueue() { delete [] buffer; }
+
+  size_t capacity() const { return mask + 1; }
+
+  bool tryPush(const T& item);
+  bool tryPop(T& item);
+};
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity):
+  buffer(NULL),mask(0),enqueuePos(0),dequeuePos(0)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+  buffer = new Cell[size];
+  mask = size - 1;
+  for(size_t i = 0; i < size; ++i)
+    buffer[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool
+BoundedQueue<T>::tryPush(const T& item)
+{
+  size_t pos = enqueuePos.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true)
+  {
+    cell = &buffer[pos & mask];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos);
+    if (diff == 0)
+    {
+      if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false; // full
+    else
+      pos = enqueuePos.load(std::memory_order_relaxed);
+  }
+  cell->data = item;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool
+BoundedQueue<T>::tryPop(T& item)
+{
+  size_t pos = dequeuePos.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true)
+  {
+    cell = &buffer[pos & mask];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos + 1);
+    if (diff == 0)
+    {
+      if (dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false; // empty
+    else
+      pos = dequeuePos.load(std::memory_order_relaxed);
+  }
+  item = cell->data;
+  cell->data = T();
+  cell->sequence.store(pos + mask + 1, std::memory_order_release);
+  return true;
+}
+
+} // namespace yaatk
+
+#endif
@@ -0,0 +1,94 @@
+/*
+   The FastExp class.
+
+   Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+   This file is part of YAATK, Yet another auxiliary toolkit.
+
+   YAATK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   YAATK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with YAATK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef yaatk_FastExp_hpp
+#define yaatk_FastExp_hpp
+
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+namespace yaatk
+{
+
+/*
+  exp(x) = 2^n*exp(r), |r| <= ln(2)/2, where exp(r) is replaced by its
+  Taylor polynomial of the lowest degree that keeps the relative error
+  below the requested bound; degree 13 (bound 0) is as accurate as
+  double allows. Arguments are clamped to the range of normal doubles.
+*/
+class FastExp
+{
+public:
+  enum {MAX_DEGREE = 13};
+private:
+  int deg;
+  double coef[MAX_DEGREE + 1];
+public:
+  static int degreeFor(double maxRelError)
+    {
+      if (!(maxRelError > 0))
+        return MAX_DEGREE;
+      const double h = 0.5*std::log(2.0);
+      double term = h;
+      for(int q = 1; q < MAX_DEGREE; ++q)
+      {
+        // Lagrange remainder of the degree q polynomial
+        term *= h/(q + 1);
+        if (term*std::exp(h) <= maxRelError)
+          return q;
+      }
+      return MAX_DEGREE;
+    }
+  explicit FastExp(double maxRelError = 0):
+    deg(degreeFor(maxRelError))
+    {
+      coef[0] = 1.0;
+      for(int k = 1; k <= MAX_DEGREE; ++k)
+        coef[k] = coef[k-1]/k;
+    }
+  int degree() const { return deg; }
+  // coefficients()[k] = 1/k!, k = 0..degree()
+  const double* coefficients() const { return coef; }
+  double operator()(double x) const
+    {
+      if (x > 708.0)
+        x = 708.0;
+      if (x < -708.0)
+        x = -708.0;
+      // rounding to the nearest integer by the addition of 1.5*2^52
+      const double shift = 6755399441055744.0;
+      double t = x*1.4426950408889634074 + shift;
+      double n = t - shift;
+      double r = x - n*6.93145751953125E-1 - n*1.42860682030941723212E-6;
+      double p = coef[deg];
+      for(int k = deg - 1; k >= 0; --k)
+        p = p*r + coef[k];
+      uint64_t bits = uint64_t(int64_t(n) + 1023) << 52;
+      double scale;
+      std::memcpy(&scale,&bits,sizeof(scale));
+      return p*scale;
+    }
+};
+
+} // namespace yaatk
+
+#endif
@@ -0,0 +1,67 @@
+/*
+   Hashing helpers.
+
+   Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+   This file is part of YAATK, Yet another auxiliary toolkit.
+
+   YAATK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   YAATK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with YAATK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef yaatk_Hash_hpp
+#define yaatk_Hash_hpp
+
+#include "LongInteger.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace yaatk
+{
+
+// finalizer of splitmix64, spreads every input bit over the whole word
+inline
+uint64_t
+hashMix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+inline
+uint64_t
+hashCombine(uint64_t seed, uint64_t h)
+{
+  return hashMix(seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+inline
+uint64_t
+hashLongInteger(const LongInteger& v)
+{
+  const mpz_srcptr z = v.get_mpz_t();
+  uint64_t h = hashMix(uint64_t(int64_t(mpz_sgn(z))));
+  const size_t limbs = mpz_size(z);
+  for(size_t i = 0; i < limbs; ++i)
+    h = hashCombine(h, uint64_t(mpz_getlimbn(z,i)));
+  return h;
+}
+
+} // namespace yaatk
+
+#endif
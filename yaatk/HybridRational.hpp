@@ -0,0 +1,450 @@
+/*
+   The HybridRational class.
+
+   Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+   This file is part of YAATK, Yet another auxiliary toolkit.
+
+   YAATK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   YAATK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with YAATK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef yaatk_HybridRational_hpp
+#define yaatk_HybridRational_hpp
+
+#include "LongInteger.hpp"
+#include "Hash.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+
+#if defined(__SIZEOF_INT128__)
+#define YAATK_HYBRID_RATIONAL_INT128
+#endif
+
+namespace yaatk
+{
+
+/*
+  Rational number that keeps its numerator and denominator inline as
+  fixed-width integers and falls back to GMP (mpq_class) only when a
+  result does not fit.
+
+  Values are always normalized (gcd(n,d) == 1, d > 0) and demoted back
+  to the inline form as soon as they fit again, so every value has
+  exactly one representation and comparisons never mix the two.
+
+  Intermediate products are computed in a type twice as wide as the
+  stored one (__int128 where available, int64_t otherwise), which is
+  enough to detect any overflow of +, -, * and /.
+*/
+class HybridRational
+{
+public:
+#ifdef YAATK_HYBRID_RATIONAL_INT128
+  typedef int64_t Narrow;
+  __extension__ typedef __int128 Wide;
+  __extension__ typedef unsigned __int128 UWide;
+#else
+  typedef int32_t Narrow;
+  typedef int64_t Wide;
+  typedef uint64_t UWide;
+#endif
+private:
+  Narrow n, d;
+  mpq_class* big;
+
+  static const int narrowBits = sizeof(Narrow)*8 - 1;
+
+  static bool fits(Wide v)
+    {
+      const Wide lim = (Wide(1) << narrowBits) - 1;
+      return v <= lim && v >= -lim;
+    }
+  static UWide uabs(Wide v)
+    {
+      return (v < 0) ? (UWide(0) - UWide(v)) : UWide(v);
+    }
+  template <class U>
+  static U gcd(U a, U b)
+    {
+      while (b != 0)
+      {
+        U t = a % b;
+        a = b;
+        b = t;
+      }
+      return a;
+    }
+
+  static mpz_class toMpz(Wide v)
+    {
+      UWide u = uabs(v);
+      uint64_t words[2] = {uint64_t(u), 0};
+#ifdef YAATK_HYBRID_RATIONAL_INT128
+      words[1] = uint64_t(u >> 64);
+#endif
+      mpz_class z;
+      mpz_import(z.get_mpz_t(), 2, -1, sizeof(uint64_t), 0, 0, words);
+      if (v < 0)
+        z = -z;
+      return z;
+    }
+  static bool fits(const mpz_class& z)
+    {
+      return mpz_sizeinbase(z.get_mpz_t(), 2) <= size_t(narrowBits);
+    }
+  static Narrow toNarrow(const mpz_class& z)
+    {
+      uint64_t word = 0;
+      size_t count = 0;
+      mpz_export(&word, &count, -1, sizeof(uint64_t), 0, 0, z.get_mpz_t());
+      Narrow v = Narrow(word);
+      return (sgn(z) < 0) ? -v : v;
+    }
+
+  // numerator and denominator are already coprime, denominator > 0
+  void setReduced(Wide num, Wide den)
+    {
+      if (fits(num) && fits(den))
+      {
+        n = Narrow(num);
+        d = Narrow(den);
+      }
+      else
+      {
+        big = new mpq_class(toMpz(num), toMpz(den));
+        n = 0;
+        d = 1;
+      }
+    }
+  void assign(Wide num, Wide den)
+    {
+      if (den == 0)
+        throw std::domain_error("HybridRational: zero denominator");
+      if (den < 0)
+      {
+        num = -num;
+        den = -den;
+      }
+      UWide g = gcd<UWide>(uabs(num), UWide(den));
+      setReduced(num/Wide(g), den/Wide(g));
+    }
+  void demote()
+    {
+      if (big != NULL &&
+          fits(big->get_num()) && fits(big->get_den()))
+      {
+        n = toNarrow(big->get_num());
+        d = toNarrow(big->get_den());
+        delete big;
+        big = NULL;
+      }
+    }
+  static HybridRational fromMpq(const mpq_class& q)
+    {
+      HybridRational r;
+      r.big = new mpq_class(q);
+      r.demote();
+      return r;
+    }
+
+  static HybridRational addSmall(const HybridRational& a,
+                                 const HybridRational& b, bool subtract);
+  static HybridRational mulSmall(const HybridRational& a,
+                                 const HybridRational& b);
+public:
+  HybridRational(int64_t nc = 0, int64_t dc = 1):
+    n(0),d(1),big(NULL)
+    {
+      if (dc == 1 && fits(Wide(nc)))
+        n = Narrow(nc);
+      else
+        assign(Wide(nc), Wide(dc));
+    }
+  HybridRational(const LongInteger& nc, const LongInteger& dc = LongInteger(1)):
+    n(0),d(1),big(NULL)
+    {
+      if (fits(nc) && fits(dc))
+        assign(Wide(toNarrow(nc)), Wide(toNarrow(dc)));
+      else
+      {
+        if (sgn(dc) == 0)
+          throw std::domain_error("HybridRational: zero denominator");
+        big = new mpq_class(nc, dc);
+        big->canonicalize();
+        demote();
+      }
+    }
+  HybridRational(const HybridRational& obj):
+    n(obj.n),d(obj.d),big(NULL)
+    {
+      if (obj.big != NULL)
+        big = new mpq_class(*obj.big);
+    }
+  HybridRational& operator=(const HybridRational& obj)
+    {
+      if (this == &obj)
+        return (*this);
+      if (obj.big != NULL)
+      {
+        if (big != NULL)
+          *big = *obj.big;
+        else
+          big = new mpq_class(*obj.big);
+      }
+      else if (big != NULL)
+      {
+        delete big;
+        big = NULL;
+      }
+      n = obj.n;
+      d = obj.d;
+      return (*this);
+    }
+  ~HybridRational()
+    {
+      delete big;
+    }
+
+  bool isSmall() const { return big == NULL; }
+  mpq_class toMpq() const
+    {
+      if (big != NULL)
+        return *big;
+      return mpq_class(toMpz(n), toMpz(d));
+    }
+  LongInteger numerator() const
+    {
+      return (big != NULL) ? LongInteger(big->get_num()) : toMpz(n);
+    }
+  LongInteger denominator() const
+    {
+      return (big != NULL) ? LongInteger(big->get_den()) : toMpz(d);
+    }
+  double toDouble() const
+    {
+      return (big != NULL) ? big->get_d() : double(n)/double(d);
+    }
+  // consistent with operator==, since every value has one representation
+  uint64_t hash() const
+    {
+      if (big != NULL)
+        return hashCombine(hashLongInteger(big->get_num()),
+                           hashLongInteger(big->get_den()));
+      return hashCombine(hashMix(uint64_t(int64_t(n))), uint64_t(int64_t(d)));
+    }
+
+  // kept for compatibility with Fraction<T>, values are always normalized
+  void normalize() {}
+  HybridRational normalized() const { return *this; }
+
+  HybridRational operator-() const
+    {
+      if (big != NULL)
+        return fromMpq(-*big);
+      HybridRational r;
+      r.n = -n;
+      r.d = d;
+      return r;
+    }
+
+  friend bool operator==(const HybridRational& a, const HybridRational& b);
+  friend bool operator<(const HybridRational& a, const HybridRational& b);
+  friend HybridRational operator+(const HybridRational& a, const HybridRational& b);
+  friend HybridRational operator-(const HybridRational& a, const HybridRational& b);
+  friend HybridRational operator*(const HybridRational& a, const HybridRational& b);
+  friend HybridRational operator/(const HybridRational& a, const HybridRational& b);
+  friend std::ostream& operator<<(std::ostream& os, const HybridRational& r);
+};
+
+inline
+HybridRational
+HybridRational::addSmall(const HybridRational& a, const HybridRational& b,
+                         bool subtract)
+{
+  Wide bn = subtract ? -Wide(b.n) : Wide(b.n);
+  HybridRational r;
+  if (a.d == b.d)
+  {
+    r.assign(Wide(a.n) + bn, Wide(a.d));
+    return r;
+  }
+  UWide g = gcd<UWide>(UWide(a.d), UWide(b.d));
+  if (g == 1)
+  {
+    r.setReduced(Wide(a.n)*Wide(b.d) + bn*Wide(a.d), Wide(a.d)*Wide(b.d));
+    return r;
+  }
+  Wide t = Wide(a.n)*(Wide(b.d)/Wide(g)) + bn*(Wide(a.d)/Wide(g));
+  UWide g2 = gcd<UWide>(g, uabs(t) % g);
+  r.setReduced(t/Wide(g2), (Wide(a.d)/Wide(g))*(Wide(b.d)/Wide(g2)));
+  return r;
+}
+
+inline
+HybridRational
+HybridRational::mulSmall(const HybridRational& a, const HybridRational& b)
+{
+  HybridRational r;
+  if (a.n == 0 || b.n == 0)
+    return r;
+  Wide g1 = Wide(gcd<UWide>(uabs(a.n), UWide(b.d)));
+  Wide g2 = Wide(gcd<UWide>(uabs(b.n), UWide(a.d)));
+  r.setReduced((Wide(a.n)/g1)*(Wide(b.n)/g2),
+               (Wide(a.d)/g2)*(Wide(b.d)/g1));
+  return r;
+}
+
+inline
+bool
+operator==(const HybridRational& a, const HybridRational& b)
+{
+  if (a.big == NULL && b.big == NULL)
+    return a.n == b.n && a.d == b.d;
+  if (a.big != NULL && b.big != NULL)
+    return *a.big == *b.big;
+  return false;
+}
+
+inline
+bool
+operator!=(const HybridRational& a, const HybridRational& b)
+{
+  return !(a == b);
+}
+
+inline
+bool
+operator<(const HybridRational& a, const HybridRational& b)
+{
+  if (a.big == NULL && b.big == NULL)
+    return HybridRational::Wide(a.n)*b.d < HybridRational::Wide(b.n)*a.d;
+  return a.toMpq() < b.toMpq();
+}
+
+inline
+bool
+operator>(const HybridRational& a, const HybridRational& b)
+{
+  return b < a;
+}
+
+inline
+bool
+operator<=(const HybridRational& a, const HybridRational& b)
+{
+  return !(b < a);
+}
+
+inline
+bool
+operator>=(const HybridRational& a, const HybridRational& b)
+{
+  return !(a < b);
+}
+
+inline
+HybridRational
+operator+(const HybridRational& a, const HybridRational& b)
+{
+  if (a.big == NULL && b.big == NULL)
+    return HybridRational::addSmall(a,b,false);
+  return HybridRational::fromMpq(a.toMpq() + b.toMpq());
+}
+
+inline
+HybridRational
+operator-(const HybridRational& a, const HybridRational& b)
+{
+  if (a.big == NULL && b.big == NULL)
+    return HybridRational::addSmall(a,b,true);
+  return HybridRational::fromMpq(a.toMpq() - b.toMpq());
+}
+
+inline
+HybridRational
+operator*(const HybridRational& a, const HybridRational& b)
+{
+  if (a.big == NULL && b.big == NULL)
+    return HybridRational::mulSmall(a,b);
+  return HybridRational::fromMpq(a.toMpq() * b.toMpq());
+}
+
+inline
+HybridRational
+operator/(const HybridRational& a, const HybridRational& b)
+{
+  if (b == HybridRational(0))
+    throw std::domain_error("HybridRational: division by zero");
+  if (a.big == NULL && b.big == NULL)
+  {
+    HybridRational inv;
+    inv.n = (b.n < 0) ? -b.d : b.d;
+    inv.d = (b.n < 0) ? -b.n : b.n;
+    return HybridRational::mulSmall(a,inv);
+  }
+  return HybridRational::fromMpq(a.toMpq() / b.toMpq());
+}
+
+inline
+void
+operator+=(HybridRational& v, const HybridRational& a)
+{
+  v = v + a;
+}
+
+inline
+void
+operator-=(HybridRational& v, const HybridRational& a)
+{
+  v = v - a;
+}
+
+inline
+void
+operator*=(HybridRational& v, const HybridRational& a)
+{
+  v = v * a;
+}
+
+inline
+std::istream&
+operator>>(std::istream& is, HybridRational& r)
+{
+  LongInteger u = 0, v = 0;
+  is >> u >> v;
+  if (is)
+    r = HybridRational(u,v);
+  else
+    std::cerr << "Error in reading HybridRational" << std::endl;
+  return is;
+}
+
+inline
+std::ostream&
+operator<<(std::ostream& os, const HybridRational& r)
+{
+  if (r.big != NULL)
+    os << r.big->get_num() << std::endl
+       << r.big->get_den() << std::endl;
+  else
+    os << int64_t(r.n) << std::endl
+       << int64_t(r.d) << std::endl;
+  return os;
+}
+
+} // namespace yaatk
+
+#endif
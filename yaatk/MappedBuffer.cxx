@@ -0,0 +1,137 @@
+/*
+   The MappedBuffer class.
+
+   Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+   This file is part of YAATK, Yet another auxiliary toolkit.
+
+   YAATK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   YAATK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with YAATK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MappedBuffer.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <new>
+
+#ifndef __WIN32__
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace yaatk
+{
+
+MappedBuffer::MappedBuffer():
+  ptr(NULL),cap(0),path(),fd(-1),keep(false)
+{
+}
+
+MappedBuffer::~MappedBuffer()
+{
+  if (mapped())
+  {
+    unmap();
+#ifndef __WIN32__
+    close(fd);
+    if (!keep)
+      unlink(path.c_str());
+#endif
+  }
+  else
+    free(ptr);
+}
+
+void
+MappedBuffer::unmap()
+{
+#ifndef __WIN32__
+  if (ptr != NULL)
+    munmap(ptr,cap);
+#endif
+  ptr = NULL;
+}
+
+void
+MappedBuffer::mapToFile(const std::string& filename)
+{
+#ifdef __WIN32__
+  throw std::runtime_error("MappedBuffer: no memory-mapped files on Windows");
+#else
+  if (mapped())
+    throw std::logic_error("MappedBuffer: already mapped to " + path);
+  int newFd = open(filename.c_str(),O_RDWR | O_CREAT | O_TRUNC,0644);
+  if (newFd < 0)
+    throw std::runtime_error("MappedBuffer: cannot create " + filename);
+  char* heap = ptr;
+  size_t size = cap;
+  ptr = NULL;
+  cap = 0;
+  fd = newFd;
+  path = filename;
+  try
+  {
+    reserve(size);
+  }
+  catch(...)
+  {
+    close(fd);
+    unlink(path.c_str());
+    fd = -1;
+    path = "";
+    ptr = heap;
+    cap = size;
+    throw;
+  }
+  if (size > 0)
+    memcpy(ptr,heap,size);
+  free(heap);
+#endif
+}
+
+void
+MappedBuffer::reserve(size_t bytes)
+{
+  if (bytes <= cap)
+    return;
+  size_t newCap = (cap > 0) ? cap : 4096;
+  while (newCap < bytes)
+    newCap *= 2;
+  if (!mapped())
+  {
+    char* p = (char*)realloc(ptr,newCap);
+    if (p == NULL)
+      throw std::bad_alloc();
+    ptr = p;
+    cap = newCap;
+    return;
+  }
+#ifndef __WIN32__
+  if (ftruncate(fd,newCap) != 0)
+    throw std::runtime_error("MappedBuffer: cannot grow " + path);
+  unmap();
+  void* p = mmap(NULL,newCap,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+  if (p == MAP_FAILED)
+  {
+    cap = 0;
+    throw std::runtime_error("MappedBuffer: cannot map " + path);
+  }
+  ptr = (char*)p;
+  cap = newCap;
+#endif
+}
+
+} // namespace yaatk
@@ -0,0 +1,65 @@
+/*
+   The MappedBuffer class (header file).
+
+   Copyright (C) 2018 Alexander Yermolenko <yaa.mbox@gmail.com>
+
+   This file is part of YAATK, Yet another auxiliary toolkit.
+
+   YAATK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   YAATK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with YAATK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef yaatk_MappedBuffer_hpp
+#define yaatk_MappedBuffer_hpp
+
+#include <string>
+#include <cstddef>
+
+namespace yaatk
+{
+
+/*
+  A growable block of memory on the heap or, after mapToFile(), in a
+  file mapped into memory, so that it may be larger than the RAM. The
+  contents survive the growth and the switch to the file, the pointers
+  into the block do not. Files are not supported on Windows.
+*/
+class MappedBuffer
+{
+  char* ptr;
+  size_t cap;
+  std::string path;
+  int fd;
+  bool keep;
+  MappedBuffer(const MappedBuffer&);
+  MappedBuffer& operator=(const MappedBuffer&);
+  void unmap();
+public:
+  MappedBuffer();
+  ~MappedBuffer();
+  // the file is created or truncated and removed by the destructor
+  // unless keepFile() is called
+  void mapToFile(const std::string& filename);
+  bool mapped() const { return fd >= 0; }
+  const std::string& fileName() const { return path; }
+  void keepFile() { keep = true; }
+  // grows the block to at least bytes, by doubling
+  void reserve(size_t bytes);
+  size_t capacity() const { return cap; }
+  char* data() { return ptr; }
+  const char* data() const { return ptr; }
+};
+
+} // namespace yaatk
+
+#endif
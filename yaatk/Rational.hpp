@@ -24,11 +24,18 @@
 
 #include "Fraction.hpp"
 #include "LongInteger.hpp"
+#include "HybridRational.hpp"
 
 namespace yaatk
 {
 
-typedef Fraction<LongInteger> Rational;
+typedef Fraction<LongInteger> GMPRational;
+
+#ifdef YAATK_GMP_RATIONAL
+typedef GMPRational Rational;
+#else
+typedef HybridRational Rational;
+#endif
 
 }
 